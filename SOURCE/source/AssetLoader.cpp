@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "AssetLoader.h"
+
+namespace dae
+{
+	namespace
+	{
+		double ToMs(std::chrono::steady_clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+	}
+
+	AssetLoader::AssetLoader(uint32_t nrOfThreads)
+		: m_NrOfPending{ 0 }
+		, m_IsStopping{ false }
+		, m_NrOfLoaded{ 0 }
+		, m_NrOfFailed{ 0 }
+		, m_DecodeMs{ 0.0 }
+		, m_CreateMs{ 0.0 }
+	{
+		// the render thread keeps its own core, it creates the resources and draws the placeholders meanwhile
+		if (nrOfThreads == 0) nrOfThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Threads.reserve(nrOfThreads);
+		for (uint32_t workerIdx{}; workerIdx < nrOfThreads; ++workerIdx)
+		{
+			m_Threads.emplace_back(&AssetLoader::WorkerLoop, this, workerIdx);
+		}
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+			for (const std::unique_ptr<Job>& pJob : m_Queue) pJob->pStatus->state = AssetState::Failed;
+			m_Queue.clear();
+		}
+		m_QueueCondition.notify_all();
+
+		for (std::thread& thread : m_Threads) thread.join();
+
+		// decoded, but never created
+		for (const std::unique_ptr<Job>& pJob : m_Completions) pJob->pStatus->state = AssetState::Failed;
+	}
+
+	uint32_t AssetLoader::ProcessCompletions(double budgetMs)
+	{
+		const Clock::time_point startTime{ Clock::now() };
+
+		uint32_t nrOfFinished{};
+		while (true)
+		{
+			std::unique_ptr<Job> pJob{};
+			{
+				const std::lock_guard lock{ m_Mutex };
+				if (m_Completions.empty()) break;
+
+				pJob = std::move(m_Completions.front());
+				m_Completions.pop_front();
+			}
+
+			Finish(*pJob);
+			++nrOfFinished;
+
+			if (ToMs(Clock::now() - startTime) >= budgetMs) break;
+		}
+		return nrOfFinished;
+	}
+
+	void AssetLoader::WaitAll()
+	{
+		while (true)
+		{
+			ProcessCompletions();
+
+			std::unique_lock lock{ m_Mutex };
+			if (m_NrOfPending == 0) return;
+			m_CompletionCondition.wait(lock, [this]() { return !m_Completions.empty(); });
+		}
+	}
+
+	uint32_t AssetLoader::GetNrOfPending() const
+	{
+		const std::lock_guard lock{ m_Mutex };
+		return m_NrOfPending;
+	}
+
+	uint32_t AssetLoader::GetNrOfThreads() const
+	{
+		return static_cast<uint32_t>(m_Threads.size());
+	}
+
+	void AssetLoader::Submit(const std::string& name, std::shared_ptr<AssetStatus> pStatus, std::function<bool()>&& decode, std::function<bool()>&& create)
+	{
+		std::unique_ptr<Job> pJob{ std::make_unique<Job>() };
+		pJob->name = name;
+		pJob->pStatus = std::move(pStatus);
+		pJob->decode = std::move(decode);
+		pJob->create = std::move(create);
+		pJob->queuedTime = Clock::now();
+
+		{
+			const std::lock_guard lock{ m_Mutex };
+			if (m_NrOfPending == 0)
+			{
+				m_BatchStartTime = pJob->queuedTime;
+				m_NrOfLoaded = 0;
+				m_NrOfFailed = 0;
+				m_DecodeMs = 0.0;
+				m_CreateMs = 0.0;
+			}
+			++m_NrOfPending;
+			m_Queue.push_back(std::move(pJob));
+		}
+		m_QueueCondition.notify_one();
+	}
+
+	void AssetLoader::WorkerLoop(uint32_t workerIdx)
+	{
+		while (true)
+		{
+			std::unique_ptr<Job> pJob{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_QueueCondition.wait(lock, [this]() { return m_IsStopping || !m_Queue.empty(); });
+				if (m_IsStopping) return;
+
+				pJob = std::move(m_Queue.front());
+				m_Queue.pop_front();
+			}
+
+			AssetStatus& status{ *pJob->pStatus };
+			const Clock::time_point decodeStartTime{ Clock::now() };
+			status.timings.waitMs = ToMs(decodeStartTime - pJob->queuedTime);
+			status.timings.workerIdx = workerIdx;
+			status.state = AssetState::Decoding;
+
+			// a worker that throws would take the whole process down
+			bool isDecoded{ false };
+			try
+			{
+				isDecoded = pJob->decode();
+			}
+			catch (const std::exception& exception)
+			{
+				std::cout << "Asset " + pJob->name + " failed to decode: " + exception.what() + "\n";
+			}
+
+			status.timings.decodeMs = ToMs(Clock::now() - decodeStartTime);
+			status.state = isDecoded ? AssetState::Decoded : AssetState::Failed;
+
+			{
+				const std::lock_guard lock{ m_Mutex };
+				m_Completions.push_back(std::move(pJob));
+			}
+			m_CompletionCondition.notify_all();
+		}
+	}
+
+	void AssetLoader::Finish(Job& job)
+	{
+		AssetStatus& status{ *job.pStatus };
+
+		const Clock::time_point createStartTime{ Clock::now() };
+		const bool isCreated{ status.state == AssetState::Decoded && job.create() };
+		const Clock::time_point readyTime{ Clock::now() };
+		status.timings.createMs = ToMs(readyTime - createStartTime);
+		status.timings.readyMs = ToMs(readyTime - job.queuedTime);
+
+		// releases the decoded data that create did not take over
+		job.decode = nullptr;
+		job.create = nullptr;
+
+		const AssetTimings& timings{ status.timings };
+		if (isCreated)
+		{
+			std::cout << "Asset " << job.name << ": queued " << timings.waitMs << " ms, decoded in " << timings.decodeMs << " ms (worker " << timings.workerIdx
+				<< "), created in " << timings.createMs << " ms, ready after " << timings.readyMs << " ms\n";
+		}
+		else
+		{
+			std::cout << "Asset " << job.name << ": FAILED after " << timings.readyMs << " ms\n";
+		}
+
+		// published last, Get on another thread sees the complete asset and timings
+		status.state = isCreated ? AssetState::Ready : AssetState::Failed;
+
+		const std::lock_guard lock{ m_Mutex };
+		if (isCreated) ++m_NrOfLoaded;
+		else ++m_NrOfFailed;
+		m_DecodeMs += timings.decodeMs;
+		m_CreateMs += timings.createMs;
+		if (--m_NrOfPending > 0) return;
+
+		// the render thread was busy for createMs only, the rest overlapped with it and with the other loads
+		std::cout << "Assets: " << m_NrOfLoaded << " loaded" << (m_NrOfFailed ? ", " + std::to_string(m_NrOfFailed) + " failed" : "") << " in "
+			<< ToMs(readyTime - m_BatchStartTime) << " ms (" << m_DecodeMs << " ms decoding on " << m_Threads.size() << " workers, "
+			<< m_CreateMs << " ms creating on the render thread)\n";
+	}
+}
\ No newline at end of file
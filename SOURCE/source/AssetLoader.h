@@ -0,0 +1,183 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	enum class AssetState
+	{
+		Queued = 0, // waiting for a worker
+		Decoding,   // file I/O, decoding, mip / tangent generation on a worker
+		Decoded,    // in the completion queue, waiting for the render thread
+		Ready,      // resource created
+		Failed,
+	};
+
+	// where the time of one load went, in ms
+	struct AssetTimings
+	{
+		double waitMs;   // queued before a worker picked it up
+		double decodeMs; // on the worker
+		double createMs; // resource creation on the render thread
+		double readyMs;  // request to ready, including the wait for the next ProcessCompletions
+		uint32_t workerIdx;
+	};
+
+	// state of one load, shared by its handles, the worker decoding it and the render thread
+	struct AssetStatus
+	{
+		std::atomic<AssetState> state{ AssetState::Queued };
+		AssetTimings timings{};
+	};
+
+	// Future of one asset. Get stays nullptr until the render thread created the asset; the asset is owned
+	// by the onReady callback it was handed to, the handle only observes it.
+	template<typename AssetType>
+	class AssetHandle final
+	{
+	public:
+		AssetState GetState() const;
+		bool IsDone() const; // ready or failed
+		AssetType* Get() const;
+		// complete once IsDone
+		const AssetTimings& GetTimings() const;
+
+	private:
+		friend class AssetLoader;
+
+		struct Slot : AssetStatus
+		{
+			AssetType* pAsset{ nullptr };
+		};
+		std::shared_ptr<Slot> m_pSlot;
+	};
+
+	// Worker pool for loading assets without stalling the render thread. Decoding (everything that does not
+	// touch the device) runs on the workers, the decoded data goes into a completion queue, and the render
+	// thread creates the resources from it in ProcessCompletions. Until then the renderer draws placeholders.
+	class AssetLoader final
+	{
+	public:
+		// nrOfThreads = 0: one per hardware thread, minus the render thread (at least 1)
+		explicit AssetLoader(uint32_t nrOfThreads = 0);
+		// loads that did not start yet are dropped, running decodes finish first
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader(AssetLoader&&) noexcept = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+		AssetLoader& operator=(AssetLoader&&) noexcept = delete;
+
+		// decode runs on a worker and returns nullptr on failure. create turns its result into the asset on the
+		// render thread, onReady receives the asset right after (not called when either step failed).
+		// Loads start in the order they are queued.
+		template<typename DataType, typename AssetType>
+		AssetHandle<AssetType> Load(const std::string& name, std::function<std::unique_ptr<DataType>()> decode,
+			std::function<AssetType*(std::unique_ptr<DataType>)> create, std::function<void(AssetType*)> onReady);
+
+		// Render thread: creates decoded assets until the completion queue is empty or budgetMs is used up
+		// (at least one per call). Returns the number of loads finished.
+		uint32_t ProcessCompletions(double budgetMs = std::numeric_limits<double>::infinity());
+		// Render thread: ProcessCompletions until every queued load is done
+		void WaitAll();
+
+		// loads not finished by ProcessCompletions yet
+		uint32_t GetNrOfPending() const;
+		uint32_t GetNrOfThreads() const;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Job
+		{
+			std::string name;
+			std::shared_ptr<AssetStatus> pStatus;
+			std::function<bool()> decode;
+			std::function<bool()> create;
+			Clock::time_point queuedTime;
+		};
+
+		std::vector<std::thread> m_Threads;
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_QueueCondition;
+		std::condition_variable m_CompletionCondition;
+		std::deque<std::unique_ptr<Job>> m_Queue;
+		std::deque<std::unique_ptr<Job>> m_Completions;
+		uint32_t m_NrOfPending;
+		bool m_IsStopping;
+
+		// totals of the loads since the loader was last idle
+		Clock::time_point m_BatchStartTime;
+		uint32_t m_NrOfLoaded;
+		uint32_t m_NrOfFailed;
+		double m_DecodeMs;
+		double m_CreateMs;
+
+		void Submit(const std::string& name, std::shared_ptr<AssetStatus> pStatus, std::function<bool()>&& decode, std::function<bool()>&& create);
+		void WorkerLoop(uint32_t workerIdx);
+		void Finish(Job& job);
+	};
+
+	template<typename AssetType>
+	AssetState AssetHandle<AssetType>::GetState() const
+	{
+		return m_pSlot ? m_pSlot->state.load() : AssetState::Failed;
+	}
+
+	template<typename AssetType>
+	bool AssetHandle<AssetType>::IsDone() const
+	{
+		const AssetState state{ GetState() };
+		return state == AssetState::Ready || state == AssetState::Failed;
+	}
+
+	template<typename AssetType>
+	AssetType* AssetHandle<AssetType>::Get() const
+	{
+		return GetState() == AssetState::Ready ? m_pSlot->pAsset : nullptr;
+	}
+
+	template<typename AssetType>
+	const AssetTimings& AssetHandle<AssetType>::GetTimings() const
+	{
+		static const AssetTimings noTimings{};
+		return m_pSlot ? m_pSlot->timings : noTimings;
+	}
+
+	template<typename DataType, typename AssetType>
+	AssetHandle<AssetType> AssetLoader::Load(const std::string& name, std::function<std::unique_ptr<DataType>()> decode,
+		std::function<AssetType*(std::unique_ptr<DataType>)> create, std::function<void(AssetType*)> onReady)
+	{
+		AssetHandle<AssetType> handle{};
+		handle.m_pSlot = std::make_shared<typename AssetHandle<AssetType>::Slot>();
+
+		// decoded on the worker, consumed on the render thread (handed over through the completion queue)
+		std::shared_ptr<std::unique_ptr<DataType>> pData{ std::make_shared<std::unique_ptr<DataType>>() };
+		Submit(name, handle.m_pSlot,
+			[pData, decode = std::move(decode)]()
+			{
+				*pData = decode();
+				return *pData != nullptr;
+			},
+			[pData, pSlot = handle.m_pSlot, create = std::move(create), onReady = std::move(onReady)]()
+			{
+				pSlot->pAsset = create(std::move(*pData));
+				if (!pSlot->pAsset) return false;
+
+				if (onReady) onReady(pSlot->pAsset);
+				return true;
+			});
+		return handle;
+	}
+}
+
+#endif // !ASSETLOADER_H
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "BaseEffect.h"
+#include "VertexFormats.h"
 
 namespace dae
 {
@@ -25,11 +26,31 @@ namespace dae
 		{
 			std::wcout << L"m_pMatWorldViewProjVariable not valid!\n";
 		}
+
+		// Get Dequantization
+		m_pPositionScaleVariable = m_pEffect->GetVariableByName("gPositionScale")->AsVector();
+		if (!m_pPositionScaleVariable->IsValid())
+		{
+			std::wcout << L"m_pPositionScaleVariable not valid!\n";
+		}
+		m_pPositionOffsetVariable = m_pEffect->GetVariableByName("gPositionOffset")->AsVector();
+		if (!m_pPositionOffsetVariable->IsValid())
+		{
+			std::wcout << L"m_pPositionOffsetVariable not valid!\n";
+		}
+		m_pUVScaleOffsetVariable = m_pEffect->GetVariableByName("gUVScaleOffset")->AsVector();
+		if (!m_pUVScaleOffsetVariable->IsValid())
+		{
+			std::wcout << L"m_pUVScaleOffsetVariable not valid!\n";
+		}
 	}
 
 	BaseEffect::~BaseEffect()
 	{
 		if (m_pMatWorldViewProjVariable) m_pMatWorldViewProjVariable->Release();
+		if (m_pPositionScaleVariable) m_pPositionScaleVariable->Release();
+		if (m_pPositionOffsetVariable) m_pPositionOffsetVariable->Release();
+		if (m_pUVScaleOffsetVariable) m_pUVScaleOffsetVariable->Release();
 		if (m_pTechnique) m_pTechnique->Release();
 		if (m_pEffect) m_pEffect->Release();
 		if (m_pInputLayout) m_pInputLayout->Release();
@@ -65,6 +86,17 @@ namespace dae
 		return m_pMatWorldViewProjVariable;
 	}
 
+	void BaseEffect::SetQuantization(const VertexQuantization& quantization) const
+	{
+		const float positionScale[4]{ quantization.positionScale.x, quantization.positionScale.y, quantization.positionScale.z, 0.f };
+		const float positionOffset[4]{ quantization.positionOffset.x, quantization.positionOffset.y, quantization.positionOffset.z, 0.f };
+		const float uvScaleOffset[4]{ quantization.uvScale.x, quantization.uvScale.y, quantization.uvOffset.x, quantization.uvOffset.y };
+
+		if (m_pPositionScaleVariable) m_pPositionScaleVariable->SetFloatVector(positionScale);
+		if (m_pPositionOffsetVariable) m_pPositionOffsetVariable->SetFloatVector(positionOffset);
+		if (m_pUVScaleOffsetVariable) m_pUVScaleOffsetVariable->SetFloatVector(uvScaleOffset);
+	}
+
 	ID3DX11Effect* BaseEffect::LoadEffect(ID3D11Device* pDevice, const std::wstring& assertfile)
 	{
 		HRESULT result;
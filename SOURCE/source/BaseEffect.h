@@ -3,6 +3,8 @@
 
 namespace dae
 {
+	struct VertexQuantization;
+
 	class BaseEffect
 	{
 	public:
@@ -21,6 +23,9 @@ namespace dae
 		ID3D11InputLayout* GetInputLayout() const;
 		ID3DX11EffectMatrixVariable* GetWorldViewProjectionMatrix() const;
 
+		// ranges the 16-bit positions / UVs of the compact vertex stream are dequantized with
+		void SetQuantization(const VertexQuantization& quantization) const;
+
 	protected:
 		ID3DX11Effect* m_pEffect;
 		ID3D11InputLayout* m_pInputLayout;
@@ -30,6 +35,9 @@ namespace dae
 		const std::wstring m_FileName;
 		ID3D11Device* m_pDevice;
 		ID3DX11EffectMatrixVariable* m_pMatWorldViewProjVariable;
+		ID3DX11EffectVectorVariable* m_pPositionScaleVariable;
+		ID3DX11EffectVectorVariable* m_pPositionOffsetVariable;
+		ID3DX11EffectVectorVariable* m_pUVScaleOffsetVariable;
 
 		static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& assertfile);
 	};
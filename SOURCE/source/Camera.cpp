@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Camera.h"
 #include "Matrix.h"
+#include "Quaternion.h"
 
 namespace dae
 {
@@ -10,14 +11,16 @@ namespace dae
 		, m_Zfar{ zf }
 		, m_Znear{ zn }
 		, m_AspectRatio{ aspectRatio }
+		, m_IsViewDirty{ true }
+		, m_IsProjectionDirty{ true }
+		, m_HasChanged{ true }
 	{
 		m_FovValue = tanf((m_FovAngle * TO_RADIANS) / 2.f);
 
 		m_TotalPitch = 0.f;
 		m_TotalYaw = 0.f;
 
-		CalculateViewMatrix();
-		CalculateProjectionMatrix();
+		UpdateMatrices();
 	}
 
 	void Camera::Update(const Timer* const pTimer)
@@ -34,8 +37,10 @@ namespace dae
 		int mouseY;
 		const uint32_t mouseState{ SDL_GetRelativeMouseState(&mouseX, &mouseY) };
 
-		if (mouseState)
+		if (mouseState && (mouseX || mouseY))
 		{
+			m_IsViewDirty = true;
+
 			// MOUSE
 			if (mouseState & SDL_BUTTON_RMASK && mouseState & SDL_BUTTON_LMASK)
 			{
@@ -68,6 +73,8 @@ namespace dae
 
 		if (isKeyPressed)
 		{
+			const Vector3 previousOrigin{ m_Origin };
+			const float previousFovAngle{ m_FovAngle };
 			float deltaTimeSpeed{};
 
 			if (pKeyboardState[SDL_SCANCODE_LSHIFT])
@@ -129,14 +136,14 @@ namespace dae
 				m_FovAngle = 45;
 				m_FovValue = tanf((m_FovAngle * TO_RADIANS) * 0.5f);
 			}
-		}
 
-		if (isKeyPressed || mouseState)
-		{
-			//Update Matrices
-			CalculateViewMatrix();
-			CalculateProjectionMatrix();
+			// any key sets isKeyPressed, only rebuild what actually moved
+			if (m_Origin.x != previousOrigin.x || m_Origin.y != previousOrigin.y || m_Origin.z != previousOrigin.z) m_IsViewDirty = true;
+			if (m_FovAngle != previousFovAngle) m_IsProjectionDirty = true;
 		}
+
+		//Update Matrices
+		UpdateMatrices();
 	}
 
 	const Vector3& Camera::GetOrigin() const
@@ -159,6 +166,11 @@ namespace dae
 		return m_Right;
 	}
 
+	const Quaternion& Camera::GetOrientation() const
+	{
+		return m_Orientation;
+	}
+
 	const Matrix& Camera::GetViewMatrix() const
 	{
 		return m_ViewMatrix;
@@ -169,11 +181,22 @@ namespace dae
 		return m_ProjectionMatrix;
 	}
 
+	const Matrix& Camera::GetViewProjectionMatrix() const
+	{
+		return m_ViewProjectionMatrix;
+	}
+
+	bool Camera::HasChanged() const
+	{
+		return m_HasChanged;
+	}
+
 	void Camera::CalculateViewMatrix()
 	{
-		// calculate view matrix
-		m_InvViewMatrix = Matrix::CreateRotation(m_TotalPitch * TO_RADIANS, m_TotalYaw * TO_RADIANS, 0.f) * Matrix::CreateTranslation(m_Origin);
-		m_ViewMatrix = m_InvViewMatrix.Inverse();
+		// calculate view matrix, the inverse of rotation * translation(origin) straight from the orientation
+		m_Orientation = Quaternion::CreateRotation(m_TotalPitch * TO_RADIANS, m_TotalYaw * TO_RADIANS, 0.f);
+		const Quaternion inverseOrientation{ m_Orientation.Conjugate() };
+		m_ViewMatrix = inverseOrientation.ToMatrix(inverseOrientation.Rotate(-m_Origin));
 
 		m_Forward = m_ViewMatrix.TransformVector(-Vector3::UnitZ).Normalized();
 		m_Forward.z *= -1.f;
@@ -187,4 +210,17 @@ namespace dae
 		// calculate Projection Matrix
 		m_ProjectionMatrix = Matrix::CreatePerspectiveFovLH(m_FovValue, m_AspectRatio, m_Znear, m_Zfar);
 	}
+
+	void Camera::UpdateMatrices()
+	{
+		m_HasChanged = m_IsViewDirty || m_IsProjectionDirty;
+		if (!m_HasChanged) return;
+
+		if (m_IsViewDirty) CalculateViewMatrix();
+		if (m_IsProjectionDirty) CalculateProjectionMatrix();
+		m_ViewProjectionMatrix = m_ViewMatrix * m_ProjectionMatrix;
+
+		m_IsViewDirty = false;
+		m_IsProjectionDirty = false;
+	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@ namespace dae
 	struct Vector2;
 	struct Vector3;
 	struct Vector4;
+	struct Quaternion;
 
 	class Camera final
 	{
@@ -27,9 +28,15 @@ namespace dae
 		const Vector3& GetForwardVector() const;
 		const Vector3& GetUpVector() const;
 		const Vector3& GetRightVector() const;
+		const Quaternion& GetOrientation() const;
 
 		const Matrix& GetViewMatrix() const;
 		const Matrix& GetProjectionMatrix() const;
+		// view * projection, only rebuilt when one of them changed
+		const Matrix& GetViewProjectionMatrix() const;
+
+		// true if the last Update changed any of the matrices
+		bool HasChanged() const;
 
 	private:
 
@@ -45,16 +52,22 @@ namespace dae
 
 		float m_TotalPitch;
 		float m_TotalYaw;
+		Quaternion m_Orientation;
 
-		Matrix m_InvViewMatrix;
 		Matrix m_ViewMatrix;
 		Matrix m_ProjectionMatrix;
+		Matrix m_ViewProjectionMatrix;
+
+		bool m_IsViewDirty;
+		bool m_IsProjectionDirty;
+		bool m_HasChanged;
 
 		const float m_Zfar;
 		const float m_Znear;
 		
 		void CalculateViewMatrix();
 		void CalculateProjectionMatrix();
+		void UpdateMatrices();
 
 	};
 }
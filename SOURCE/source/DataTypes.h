@@ -15,6 +15,12 @@ namespace dae
 		Anisotropic,
 	};
 
+	enum class RasterizerMode
+	{
+		Hardware = 0,
+		Software,
+	};
+
 	struct Vertex
 	{
 		Vector3 position;
@@ -22,6 +28,15 @@ namespace dae
 		Vector3 normal;
 		Vector3 tangent;
 	};
+
+	struct Vertex_Out
+	{
+		Vector4 position;
+		Vector3 worldPosition;
+		Vector2 uv;
+		Vector3 normal;
+		Vector3 tangent;
+	};
 }
 
 #endif // !DATATYPES_H
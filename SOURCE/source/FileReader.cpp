@@ -0,0 +1,721 @@
+#include "pch.h"
+#include "FileReader.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DAE_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		// direct I/O needs sector aligned buffers, offsets and sizes, a page covers every device
+		constexpr uint64_t g_Alignment{ 4096 };
+		constexpr intptr_t g_InvalidFile{ -1 };
+
+		uint64_t AlignUp(uint64_t size)
+		{
+			return (size + g_Alignment - 1) & ~(g_Alignment - 1);
+		}
+
+		uint64_t AlignDown(uint64_t offset)
+		{
+			return offset & ~(g_Alignment - 1);
+		}
+
+		// directIO falls back to a buffered open when the file system does not support it
+		intptr_t OpenFile(const std::string& path, bool directIO, uint64_t& size, bool& isDirect)
+		{
+#ifdef _WIN32
+			HANDLE file{ INVALID_HANDLE_VALUE };
+			isDirect = directIO;
+			if (directIO) file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				isDirect = false;
+				file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			}
+			if (file == INVALID_HANDLE_VALUE) return g_InvalidFile;
+
+			LARGE_INTEGER fileSize{};
+			if (!GetFileSizeEx(file, &fileSize))
+			{
+				CloseHandle(file);
+				return g_InvalidFile;
+			}
+			size = static_cast<uint64_t>(fileSize.QuadPart);
+			return reinterpret_cast<intptr_t>(file);
+#else
+			int file{ -1 };
+			isDirect = false;
+#ifdef O_DIRECT
+			if (directIO)
+			{
+				file = open(path.c_str(), O_RDONLY | O_DIRECT);
+				isDirect = file >= 0;
+			}
+#endif
+			if (file < 0) file = open(path.c_str(), O_RDONLY);
+			if (file < 0) return g_InvalidFile;
+
+			struct stat fileStat{};
+			if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+			{
+				close(file);
+				return g_InvalidFile;
+			}
+			size = static_cast<uint64_t>(fileStat.st_size);
+			return file;
+#endif
+		}
+
+		void CloseFile(intptr_t file)
+		{
+#ifdef _WIN32
+			CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+			close(static_cast<int>(file));
+#endif
+		}
+
+		// pread: bytes read (0 at the end of the file), negative error code on failure
+		int64_t ReadAt(intptr_t file, char* pBuffer, uint32_t size, uint64_t offset)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD bytesRead{};
+			if (::ReadFile(reinterpret_cast<HANDLE>(file), pBuffer, size, &bytesRead, &overlapped)) return bytesRead;
+
+			const DWORD error{ GetLastError() };
+			return error == ERROR_HANDLE_EOF ? 0 : -static_cast<int64_t>(error);
+#else
+			while (true)
+			{
+				const ssize_t bytesRead{ pread(static_cast<int>(file), pBuffer, size, static_cast<off_t>(offset)) };
+				if (bytesRead >= 0) return bytesRead;
+				if (errno != EINTR) return -errno;
+			}
+#endif
+		}
+
+		// Linux: drops the clean pages of the file from the page cache, the next read comes from the device
+		bool DropFromPageCache(const std::string& path)
+		{
+#if defined(__linux__)
+			const int file{ open(path.c_str(), O_RDONLY) };
+			if (file < 0) return false;
+
+			const bool isDropped{ posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0 };
+			close(file);
+			return isDropped;
+#else
+			(void)path;
+			return false;
+#endif
+		}
+	}
+
+#ifdef DAE_HAS_IO_URING
+	// The raw ring (no liburing): submission and completion queues mapped from the kernel,
+	// this thread is the only producer of submissions and the only consumer of completions.
+	struct FileReader::Ring
+	{
+		int fd{ -1 };
+		void* pSqRing{ MAP_FAILED };
+		void* pCqRing{ MAP_FAILED };
+		io_uring_sqe* pSqes{ static_cast<io_uring_sqe*>(MAP_FAILED) };
+		size_t sqRingSize{};
+		size_t cqRingSize{};
+		size_t sqesSize{};
+
+		uint32_t* pSqTail{};
+		uint32_t* pSqArray{};
+		uint32_t sqMask{};
+		uint32_t* pCqHead{};
+		uint32_t* pCqTail{};
+		uint32_t cqMask{};
+		io_uring_cqe* pCqes{};
+
+		~Ring()
+		{
+			if (pSqes != MAP_FAILED) munmap(pSqes, sqesSize);
+			if (pCqRing != MAP_FAILED && pCqRing != pSqRing) munmap(pCqRing, cqRingSize);
+			if (pSqRing != MAP_FAILED) munmap(pSqRing, sqRingSize);
+			if (fd >= 0) close(fd);
+		}
+
+		// false when the kernel has no io_uring or it is disabled (containers, io_uring_disabled)
+		bool Init(uint32_t nrOfEntries)
+		{
+			io_uring_params params{};
+			fd = static_cast<int>(syscall(__NR_io_uring_setup, nrOfEntries, &params));
+			if (fd < 0) return false;
+
+			sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+			cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			if (params.features & IORING_FEAT_SINGLE_MMAP) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+			pSqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (pSqRing == MAP_FAILED) return false;
+			pCqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? pSqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (pCqRing == MAP_FAILED) return false;
+			sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			pSqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+			if (pSqes == MAP_FAILED) return false;
+
+			char* pSq{ static_cast<char*>(pSqRing) };
+			char* pCq{ static_cast<char*>(pCqRing) };
+			pSqTail = reinterpret_cast<uint32_t*>(pSq + params.sq_off.tail);
+			pSqArray = reinterpret_cast<uint32_t*>(pSq + params.sq_off.array);
+			sqMask = *reinterpret_cast<uint32_t*>(pSq + params.sq_off.ring_mask);
+			pCqHead = reinterpret_cast<uint32_t*>(pCq + params.cq_off.head);
+			pCqTail = reinterpret_cast<uint32_t*>(pCq + params.cq_off.tail);
+			cqMask = *reinterpret_cast<uint32_t*>(pCq + params.cq_off.ring_mask);
+			pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+			return true;
+		}
+
+		int Enter(uint32_t nrToSubmit, uint32_t minNrOfCompletions, uint32_t flags) const
+		{
+			return static_cast<int>(syscall(__NR_io_uring_enter, fd, nrToSubmit, minNrOfCompletions, flags, nullptr, 0));
+		}
+	};
+#else
+	struct FileReader::Ring
+	{
+	};
+#endif
+
+	FileReader::FileReader(const FileReaderSettings& settings)
+		: m_Settings{ settings }
+		, m_pBuffers{ nullptr }
+		, m_pRing{ nullptr }
+		, m_AreBuffersRegistered{ false }
+		, m_IsStopping{ false }
+	{
+		assert(settings.nrOfBuffers > 0 && settings.bufferSize > 0 && settings.bufferSize % g_Alignment == 0);
+
+		m_pBuffers = static_cast<char*>(::operator new(size_t{ settings.nrOfBuffers } * settings.bufferSize, std::align_val_t{ g_Alignment }));
+
+#ifdef DAE_HAS_IO_URING
+		m_pRing = std::make_unique<Ring>();
+		if (m_pRing->Init(settings.nrOfBuffers))
+		{
+			// registered once: READ_FIXED skips pinning the pages of the buffer on every read (needs RLIMIT_MEMLOCK)
+			std::vector<iovec> buffers(settings.nrOfBuffers);
+			for (uint32_t bufferIdx{}; bufferIdx < settings.nrOfBuffers; ++bufferIdx)
+			{
+				buffers[bufferIdx] = iovec{ GetBuffer(bufferIdx), settings.bufferSize };
+			}
+			m_AreBuffersRegistered = syscall(__NR_io_uring_register, m_pRing->fd, IORING_REGISTER_BUFFERS, buffers.data(), settings.nrOfBuffers) == 0;
+			return;
+		}
+		m_pRing.reset();
+#endif
+
+		StartThreadPool();
+	}
+
+	FileReader::~FileReader()
+	{
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_RequestCondition.notify_all();
+		for (std::thread& thread : m_Threads) thread.join();
+
+		// closing the ring unregisters the buffers
+		m_pRing.reset();
+		::operator delete(m_pBuffers, std::align_val_t{ g_Alignment });
+	}
+
+	std::vector<bool> FileReader::Read(std::span<const std::string> paths, const std::function<void(const FileChunk&)>& onChunk)
+	{
+		struct FileState
+		{
+			intptr_t file{ g_InvalidFile };
+			uint64_t size{};
+			uint64_t nextOffset{}; // first byte not requested yet
+			uint64_t nrOfBytesRead{};
+			uint32_t nrOfReads{};  // in flight or waiting for a retry
+			bool isOpened{};
+			bool isDirect{};
+			bool isFailed{};
+		};
+
+		std::vector<FileState> files(paths.size());
+		std::vector<bool> isRead(paths.size(), false);
+
+		const auto closeWhenDone{ [&](size_t fileIdx)
+			{
+				FileState& state{ files[fileIdx] };
+				if (state.nrOfReads > 0 || state.file == g_InvalidFile) return;
+				if (!state.isFailed && state.nrOfBytesRead < state.size) return;
+
+				CloseFile(state.file);
+				state.file = g_InvalidFile;
+				isRead[fileIdx] = !state.isFailed;
+			} };
+
+		// the rest of a short read, before any new read
+		std::deque<std::pair<size_t, Request>> retries;
+
+		// the files are opened when their first read is due, so hundreds of files never hold hundreds of descriptors
+		size_t scheduleIdx{};
+		const auto getNextRequest{ [&](Request& request, size_t& fileIdx)
+			{
+				if (!retries.empty())
+				{
+					fileIdx = retries.front().first;
+					request = retries.front().second;
+					retries.pop_front();
+					return true;
+				}
+
+				for (; scheduleIdx < paths.size(); ++scheduleIdx)
+				{
+					FileState& state{ files[scheduleIdx] };
+					if (!state.isOpened)
+					{
+						state.isOpened = true;
+						state.file = OpenFile(paths[scheduleIdx], m_Settings.directIO, state.size, state.isDirect);
+						if (state.file == g_InvalidFile) state.isFailed = true;
+						else closeWhenDone(scheduleIdx); // empty
+					}
+					if (state.isFailed || state.nextOffset >= state.size) continue;
+
+					const uint64_t nrOfBytesLeft{ state.size - state.nextOffset };
+					request.file = state.file;
+					request.offset = state.nextOffset;
+					request.size = static_cast<uint32_t>(std::min<uint64_t>(m_Settings.bufferSize, state.isDirect ? AlignUp(nrOfBytesLeft) : nrOfBytesLeft));
+					request.nrOfSkippedBytes = 0;
+					state.nextOffset += request.size;
+					++state.nrOfReads;
+					fileIdx = scheduleIdx;
+					return true;
+				}
+				return false;
+			} };
+
+		std::vector<uint32_t> freeBuffers(m_Settings.nrOfBuffers);
+		for (uint32_t bufferIdx{}; bufferIdx < m_Settings.nrOfBuffers; ++bufferIdx) freeBuffers[bufferIdx] = m_Settings.nrOfBuffers - 1 - bufferIdx;
+		std::vector<Request> bufferRequests(m_Settings.nrOfBuffers);
+		std::vector<size_t> bufferFiles(m_Settings.nrOfBuffers);
+		uint32_t nrOfReadsInFlight{};
+
+		std::vector<Request> requests;
+		std::vector<Completion> completions;
+		while (true)
+		{
+			// 1. Every free buffer gets a read, submitted as one batch
+			requests.clear();
+			Request request{};
+			size_t fileIdx{};
+			while (!freeBuffers.empty() && getNextRequest(request, fileIdx))
+			{
+				request.bufferIdx = freeBuffers.back();
+				freeBuffers.pop_back();
+				bufferRequests[request.bufferIdx] = request;
+				bufferFiles[request.bufferIdx] = fileIdx;
+				requests.push_back(request);
+			}
+			if (!requests.empty()) Submit(requests);
+			nrOfReadsInFlight += static_cast<uint32_t>(requests.size());
+			if (nrOfReadsInFlight == 0) break;
+
+			// 2. Hand out whatever finished
+			if (!WaitForCompletions(completions))
+			{
+				// the ring broke, its reads never complete: they fail with their files, the rest goes to the pread pool
+				AbandonRing();
+				std::vector<bool> isFree(m_Settings.nrOfBuffers, false);
+				for (uint32_t bufferIdx : freeBuffers) isFree[bufferIdx] = true;
+				for (uint32_t bufferIdx{}; bufferIdx < m_Settings.nrOfBuffers; ++bufferIdx)
+				{
+					if (!isFree[bufferIdx]) completions.push_back(Completion{ bufferIdx, -EIO });
+				}
+			}
+			for (const Completion& completion : completions)
+			{
+				const Request& doneRequest{ bufferRequests[completion.bufferIdx] };
+				const size_t doneFileIdx{ bufferFiles[completion.bufferIdx] };
+				FileState& state{ files[doneFileIdx] };
+				--nrOfReadsInFlight;
+				--state.nrOfReads;
+
+				// direct reads ask for whole sectors past the end of the file. Nothing new read is a failure.
+				const uint64_t nrOfBytesExpected{ std::min<uint64_t>(doneRequest.size, state.size - doneRequest.offset) };
+				const uint64_t nrOfSkippedBytes{ doneRequest.nrOfSkippedBytes };
+				if (completion.result < 0 || (static_cast<uint64_t>(completion.result) <= nrOfSkippedBytes && nrOfBytesExpected > nrOfSkippedBytes))
+				{
+					state.isFailed = true;
+				}
+				else if (!state.isFailed)
+				{
+					const uint64_t nrOfBytesRead{ std::min<uint64_t>(static_cast<uint64_t>(completion.result), nrOfBytesExpected) };
+					onChunk(FileChunk{ doneFileIdx, state.size, doneRequest.offset + nrOfSkippedBytes,
+						std::span<const char>{ GetBuffer(completion.bufferIdx) + nrOfSkippedBytes, nrOfBytesRead - nrOfSkippedBytes } });
+					state.nrOfBytesRead += nrOfBytesRead - nrOfSkippedBytes;
+
+					if (nrOfBytesRead < nrOfBytesExpected)
+					{
+						// direct I/O needs an aligned offset: restart at the sector the read stopped in
+						const uint64_t endOffset{ doneRequest.offset + nrOfBytesExpected };
+						Request retry{ doneRequest };
+						retry.offset = state.isDirect ? AlignDown(doneRequest.offset + nrOfBytesRead) : doneRequest.offset + nrOfBytesRead;
+						retry.nrOfSkippedBytes = static_cast<uint32_t>(doneRequest.offset + nrOfBytesRead - retry.offset);
+						retry.size = static_cast<uint32_t>(state.isDirect ? AlignUp(endOffset - retry.offset) : endOffset - retry.offset);
+						retries.emplace_back(doneFileIdx, retry);
+						++state.nrOfReads;
+					}
+				}
+
+				freeBuffers.push_back(completion.bufferIdx);
+				closeWhenDone(doneFileIdx);
+			}
+		}
+
+		// failed files whose reads were all finished before the failure was seen
+		for (size_t fileIdx{}; fileIdx < files.size(); ++fileIdx) closeWhenDone(fileIdx);
+		return isRead;
+	}
+
+	const char* FileReader::GetBackendName() const
+	{
+		if (!m_pRing) return "pread pool";
+		return m_AreBuffersRegistered ? "io_uring, registered buffers" : "io_uring";
+	}
+
+	char* FileReader::GetBuffer(uint32_t bufferIdx) const
+	{
+		return m_pBuffers + size_t{ bufferIdx } * m_Settings.bufferSize;
+	}
+
+	void FileReader::Submit(std::span<const Request> requests)
+	{
+#ifdef DAE_HAS_IO_URING
+		if (m_pRing)
+		{
+			Ring& ring{ *m_pRing };
+			uint32_t tail{ *ring.pSqTail };
+			for (const Request& request : requests)
+			{
+				const uint32_t sqeIdx{ tail & ring.sqMask };
+				io_uring_sqe& sqe{ ring.pSqes[sqeIdx] };
+				std::memset(&sqe, 0, sizeof(io_uring_sqe));
+				sqe.opcode = m_AreBuffersRegistered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+				sqe.fd = static_cast<int>(request.file);
+				sqe.off = request.offset;
+				sqe.addr = reinterpret_cast<uint64_t>(GetBuffer(request.bufferIdx));
+				sqe.len = request.size;
+				if (m_AreBuffersRegistered) sqe.buf_index = static_cast<uint16_t>(request.bufferIdx);
+				sqe.user_data = request.bufferIdx;
+				ring.pSqArray[sqeIdx] = sqeIdx;
+				++tail;
+			}
+
+			// one syscall for the whole batch, the ring holds a read per buffer so it never overflows
+			std::atomic_ref<uint32_t>{ *ring.pSqTail }.store(tail, std::memory_order_release);
+			uint32_t nrToSubmit{ static_cast<uint32_t>(requests.size()) };
+			while (nrToSubmit > 0)
+			{
+				const int nrOfSubmitted{ ring.Enter(nrToSubmit, 0, 0) };
+				if (nrOfSubmitted < 0 && errno == EINTR) continue;
+				if (nrOfSubmitted <= 0) break;
+				nrToSubmit -= static_cast<uint32_t>(nrOfSubmitted);
+			}
+			if (nrToSubmit == 0) return;
+
+			// Refused by the kernel (EAGAIN / EBUSY, or a broken ring): the kernel consumes in order, so the last
+			// nrToSubmit entries are taken back out of the ring and read right here. The next WaitForCompletions
+			// hands them out (only this thread touches m_Completions while there is a ring).
+			std::atomic_ref<uint32_t>{ *ring.pSqTail }.store(tail - nrToSubmit, std::memory_order_release);
+			for (const Request& request : requests.last(nrToSubmit))
+			{
+				m_Completions.push_back(Completion{ request.bufferIdx, ReadAt(request.file, GetBuffer(request.bufferIdx), request.size, request.offset) });
+			}
+			return;
+		}
+#endif
+
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_Requests.insert(m_Requests.end(), requests.begin(), requests.end());
+		}
+		m_RequestCondition.notify_all();
+	}
+
+	bool FileReader::WaitForCompletions(std::vector<Completion>& completions)
+	{
+		completions.clear();
+
+#ifdef DAE_HAS_IO_URING
+		if (m_pRing)
+		{
+			// the reads Submit did itself first, then no waiting for the ring
+			completions.assign(m_Completions.begin(), m_Completions.end());
+			m_Completions.clear();
+
+			Ring& ring{ *m_pRing };
+			const uint32_t head{ *ring.pCqHead };
+			uint32_t tail{ std::atomic_ref<uint32_t>{ *ring.pCqTail }.load(std::memory_order_acquire) };
+			while (head == tail && completions.empty())
+			{
+				if (ring.Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+				tail = std::atomic_ref<uint32_t>{ *ring.pCqTail }.load(std::memory_order_acquire);
+			}
+
+			for (uint32_t cqeIdx{ head }; cqeIdx != tail; ++cqeIdx)
+			{
+				const io_uring_cqe& cqe{ ring.pCqes[cqeIdx & ring.cqMask] };
+				completions.push_back(Completion{ static_cast<uint32_t>(cqe.user_data), cqe.res });
+			}
+			std::atomic_ref<uint32_t>{ *ring.pCqHead }.store(tail, std::memory_order_release);
+			return true;
+		}
+#endif
+
+		std::unique_lock lock{ m_Mutex };
+		m_CompletionCondition.wait(lock, [this]() { return !m_Completions.empty(); });
+		completions.assign(m_Completions.begin(), m_Completions.end());
+		m_Completions.clear();
+		return true;
+	}
+
+	void FileReader::StartThreadPool()
+	{
+		m_Threads.reserve(std::max(m_Settings.nrOfFallbackThreads, 1u));
+		for (uint32_t threadIdx{}; threadIdx < std::max(m_Settings.nrOfFallbackThreads, 1u); ++threadIdx)
+		{
+			m_Threads.emplace_back(&FileReader::WorkerLoop, this);
+		}
+	}
+
+	void FileReader::AbandonRing()
+	{
+		// Closing the ring cancels its reads, but one that is already running can still land in a buffer:
+		// the old buffers are given up (leaked on purpose), the pread pool reads into new ones
+		m_pRing.reset();
+		m_AreBuffersRegistered = false;
+		m_pBuffers = static_cast<char*>(::operator new(size_t{ m_Settings.nrOfBuffers } * m_Settings.bufferSize, std::align_val_t{ g_Alignment }));
+		StartThreadPool();
+		std::cout << "FileReader: io_uring failed, reading with the pread pool from now on\n";
+	}
+
+	void FileReader::WorkerLoop()
+	{
+		while (true)
+		{
+			Request request{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_RequestCondition.wait(lock, [this]() { return m_IsStopping || !m_Requests.empty(); });
+				if (m_IsStopping) return;
+
+				request = m_Requests.front();
+				m_Requests.pop_front();
+			}
+
+			const int64_t result{ ReadAt(request.file, GetBuffer(request.bufferIdx), request.size, request.offset) };
+
+			{
+				const std::lock_guard lock{ m_Mutex };
+				m_Completions.push_back(Completion{ request.bufferIdx, result });
+			}
+			m_CompletionCondition.notify_one();
+		}
+	}
+
+	bool ReadWholeFile(const std::string& path, FileData& file)
+	{
+		// a few reads in flight per loading thread, the page cache keeps repeated runs fast
+		thread_local FileReader reader{ FileReaderSettings{ 8, 256u << 10, false, 2 } };
+
+		file = FileData{};
+		const std::string paths[]{ path };
+		const std::vector<bool> isRead{ reader.Read(paths, [&file](const FileChunk& chunk)
+			{
+				if (!file.pData)
+				{
+					file.pData = std::make_unique_for_overwrite<char[]>(chunk.fileSize);
+					file.size = chunk.fileSize;
+				}
+				std::memcpy(file.pData.get() + chunk.offset, chunk.data.data(), chunk.data.size());
+			}) };
+		return isRead[0];
+	}
+
+	namespace Utils
+	{
+		namespace
+		{
+			// Sum of every 64-bit word times a hash of its position: the same for any chunk order and chunk size
+			class ContentChecksum final
+			{
+			public:
+				void Add(size_t fileIdx, uint64_t offset, std::span<const char> data)
+				{
+					size_t byteIdx{};
+					for (; byteIdx < data.size() && (offset + byteIdx) % 8 != 0; ++byteIdx) AddByte(fileIdx, offset + byteIdx, data[byteIdx]);
+					for (; byteIdx + 8 <= data.size(); byteIdx += 8)
+					{
+						uint64_t word{};
+						std::memcpy(&word, data.data() + byteIdx, sizeof(uint64_t));
+						m_Sum += word * GetWeight(fileIdx, (offset + byteIdx) / 8);
+					}
+					for (; byteIdx < data.size(); ++byteIdx) AddByte(fileIdx, offset + byteIdx, data[byteIdx]);
+				}
+
+				uint64_t GetSum() const
+				{
+					return m_Sum;
+				}
+
+			private:
+				uint64_t m_Sum{};
+
+				static uint64_t GetWeight(size_t fileIdx, uint64_t wordIdx)
+				{
+					uint64_t x{ (static_cast<uint64_t>(fileIdx) << 40) ^ wordIdx };
+					x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+					x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+					return (x ^ (x >> 31)) | 1;
+				}
+
+				void AddByte(size_t fileIdx, uint64_t position, char value)
+				{
+					m_Sum += (static_cast<uint64_t>(static_cast<uint8_t>(value)) << (8 * (position % 8))) * GetWeight(fileIdx, position / 8);
+				}
+			};
+
+			double GetMs(std::chrono::steady_clock::time_point start)
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+		}
+
+		bool BenchmarkFileReader(const std::string& directory, int nrOfRuns)
+		{
+			std::vector<std::string> paths;
+			uint64_t nrOfBytes{};
+			std::error_code errorCode{};
+			for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{ directory, std::filesystem::directory_options::skip_permission_denied, errorCode })
+			{
+				if (!entry.is_regular_file(errorCode)) continue;
+				paths.push_back(entry.path().string());
+				nrOfBytes += entry.file_size(errorCode);
+			}
+			std::sort(paths.begin(), paths.end());
+			if (paths.empty())
+			{
+				std::cout << "No files in " << directory << "\n";
+				return false;
+			}
+
+			const double nrOfGB{ nrOfBytes / 1e9 };
+			std::cout << "File reader: " << paths.size() << " files, " << nrOfBytes / (1024.0 * 1024.0) << " MB in " << directory << "\n";
+
+			// every file with its own stream and one read, into a buffer that only grows
+			const auto readWithStreams{ [&](ContentChecksum* pChecksum)
+				{
+					std::vector<char> buffer;
+					bool isComplete{ true };
+					for (size_t fileIdx{}; fileIdx < paths.size(); ++fileIdx)
+					{
+						std::ifstream file{ paths[fileIdx], std::ios::binary | std::ios::ate };
+						const std::streamsize size{ file ? static_cast<std::streamsize>(file.tellg()) : -1 };
+						if (size < 0)
+						{
+							isComplete = false;
+							continue;
+						}
+						buffer.resize(std::max(buffer.size(), static_cast<size_t>(size)));
+						file.seekg(0);
+						isComplete &= static_cast<bool>(file.read(buffer.data(), size));
+						if (pChecksum) pChecksum->Add(fileIdx, 0, std::span<const char>{ buffer.data(), static_cast<size_t>(size) });
+					}
+					return isComplete;
+				} };
+
+			const auto readWithReader{ [&](FileReader& reader, ContentChecksum* pChecksum)
+				{
+					const std::vector<bool> isRead{ reader.Read(paths, [pChecksum](const FileChunk& chunk)
+						{
+							if (pChecksum) pChecksum->Add(chunk.fileIdx, chunk.offset, chunk.data);
+						}) };
+					return std::all_of(isRead.begin(), isRead.end(), [](bool isFileRead) { return isFileRead; });
+				} };
+
+			FileReader bufferedReader{ FileReaderSettings{} };
+			FileReader directReader{ FileReaderSettings{ 32, 1u << 20, true } };
+			std::cout << "  backend: " << bufferedReader.GetBackendName() << "\n";
+
+			struct Reader
+			{
+				const char* name;
+				std::function<bool(ContentChecksum*)> read;
+			};
+			const Reader readers[]
+			{
+				{ "std::ifstream        ", readWithStreams },
+				{ "FileReader, buffered ", [&](ContentChecksum* pChecksum) { return readWithReader(bufferedReader, pChecksum); } },
+				{ "FileReader, direct IO", [&](ContentChecksum* pChecksum) { return readWithReader(directReader, pChecksum); } },
+			};
+
+			bool isValid{ true };
+			uint64_t referenceChecksum{};
+			for (size_t readerIdx{}; readerIdx < std::size(readers); ++readerIdx)
+			{
+				const Reader& reader{ readers[readerIdx] };
+
+				// cold: nothing of the directory in the page cache (where it can be dropped)
+				bool isCold{ true };
+				for (const std::string& path : paths) isCold &= DropFromPageCache(path);
+				auto startTime{ std::chrono::steady_clock::now() };
+				const bool isComplete{ reader.read(nullptr) };
+				const double coldMs{ GetMs(startTime) };
+
+				double warmMs{ std::numeric_limits<double>::max() };
+				for (int run{}; run < nrOfRuns; ++run)
+				{
+					startTime = std::chrono::steady_clock::now();
+					reader.read(nullptr);
+					warmMs = std::min(warmMs, GetMs(startTime));
+				}
+
+				// contents checked outside of the timed runs
+				ContentChecksum checksum{};
+				reader.read(&checksum);
+				if (readerIdx == 0) referenceChecksum = checksum.GetSum();
+				const bool isSame{ checksum.GetSum() == referenceChecksum };
+				isValid &= isComplete && isSame;
+
+				std::cout << "  " << reader.name << ": " << (isCold ? "cold " : "first ") << coldMs << " ms (" << nrOfGB / (coldMs / 1000.0) << " GB/s), warm "
+					<< warmMs << " ms (" << nrOfGB / (warmMs / 1000.0) << " GB/s)" << (isComplete ? "" : ", INCOMPLETE") << (isSame ? "" : ", CONTENTS DIFFER") << "\n";
+			}
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef FILEREADER_H
+#define FILEREADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	// one piece of a file, only valid during the FileReader callback
+	struct FileChunk
+	{
+		size_t fileIdx;
+		uint64_t fileSize;
+		uint64_t offset;
+		std::span<const char> data;
+	};
+
+	struct FileReaderSettings
+	{
+		uint32_t nrOfBuffers{ 32 };        // reads in flight
+		uint32_t bufferSize{ 1u << 20 };   // bytes per read, a multiple of 4096
+		bool directIO{ false };            // O_DIRECT / FILE_FLAG_NO_BUFFERING, skips the page cache (cold, big reads)
+		uint32_t nrOfFallbackThreads{ 4 }; // pread threads when io_uring is not available
+	};
+
+	// Batched file reads into a pool of page aligned buffers.
+	// Linux: one io_uring, every buffer in flight at once, the buffers are registered with the ring
+	// (no page pinning per read) when the memlock limit allows it.
+	// Elsewhere, or when the kernel refuses io_uring: the same reads on a small pread thread pool.
+	// Files that cannot be opened with direct I/O (tmpfs, unaligned sizes on Windows) are read buffered.
+	class FileReader final
+	{
+	public:
+		explicit FileReader(const FileReaderSettings& settings = {});
+		~FileReader();
+
+		FileReader(const FileReader&) = delete;
+		FileReader(FileReader&&) noexcept = delete;
+		FileReader& operator=(const FileReader&) = delete;
+		FileReader& operator=(FileReader&&) noexcept = delete;
+
+		// Streams every file through the buffers. onChunk runs on the calling thread for every chunk of every file,
+		// in completion order (the chunks of one file can arrive out of order). Returns per file if it was read completely.
+		std::vector<bool> Read(std::span<const std::string> paths, const std::function<void(const FileChunk&)>& onChunk);
+
+		// "io_uring", "io_uring, registered buffers" or "pread pool"
+		const char* GetBackendName() const;
+
+	private:
+		struct Request
+		{
+			uint32_t bufferIdx;
+			intptr_t file;
+			uint64_t offset;
+			uint32_t size;
+			uint32_t nrOfSkippedBytes; // handed out already, a direct retry restarts at the sector of a short read
+		};
+		struct Completion
+		{
+			uint32_t bufferIdx;
+			int64_t result; // bytes read, negative errno on failure
+		};
+		struct Ring;
+
+		const FileReaderSettings m_Settings;
+		char* m_pBuffers;
+		std::unique_ptr<Ring> m_pRing;
+		bool m_AreBuffersRegistered;
+
+		// pread fallback
+		std::vector<std::thread> m_Threads;
+		std::mutex m_Mutex;
+		std::condition_variable m_RequestCondition;
+		std::condition_variable m_CompletionCondition;
+		std::deque<Request> m_Requests;
+		std::deque<Completion> m_Completions;
+		bool m_IsStopping;
+
+		char* GetBuffer(uint32_t bufferIdx) const;
+		// io_uring: reads the kernel refuses are done synchronously, they complete with the next wait
+		void Submit(std::span<const Request> requests);
+		// blocks until at least one read finished, false when the ring failed (its reads in flight never complete)
+		bool WaitForCompletions(std::vector<Completion>& completions);
+		void StartThreadPool();
+		// after a ring failure, later reads go through the pread pool
+		void AbandonRing();
+		void WorkerLoop();
+	};
+
+	// contents of one file, uninitialized before the read
+	struct FileData
+	{
+		std::unique_ptr<char[]> pData;
+		size_t size{};
+	};
+
+	// Whole file through a FileReader of the calling thread (buffered, created on first use),
+	// for the loaders: asset workers each read with their own ring.
+	bool ReadWholeFile(const std::string& path, FileData& file);
+
+	namespace Utils
+	{
+		// Every file below directory: std::ifstream vs FileReader buffered vs FileReader direct I/O, cold (Linux: the
+		// pages of every file are dropped from the page cache first) and warm. Prints GB/s, returns false when the
+		// readers do not agree on the contents.
+		bool BenchmarkFileReader(const std::string& directory, int nrOfRuns = 3);
+	}
+}
+
+#endif // !FILEREADER_H
\ No newline at end of file
@@ -14,18 +14,18 @@ namespace dae
 			std::wcout << L"m_pDiffusemapVariable not valid!\n";
 		}
 
-		// Create Vertex Layout
+		// Create Vertex Layout (FireVertex)
 		static constexpr uint32_t numElements{ 2 };
 		D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
 
 		vertexDesc[0].SemanticName = "POSITION";
-		vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[0].AlignedByteOffset = 0;
+		vertexDesc[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+		vertexDesc[0].AlignedByteOffset = offsetof(FireVertex, position);
 		vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[1].SemanticName = "TEXCOORD";
-		vertexDesc[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-		vertexDesc[1].AlignedByteOffset = 12;
+		vertexDesc[1].Format = DXGI_FORMAT_R16G16_UNORM;
+		vertexDesc[1].AlignedByteOffset = offsetof(FireVertex, uv);
 		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		// Create Input Layout
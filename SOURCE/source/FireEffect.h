@@ -2,6 +2,7 @@
 #define FIREEFFECT_H
 
 #include "BaseEffect.h"
+#include "VertexFormats.h"
 
 struct ID3DX11EffectShaderResourceVariable;
 
@@ -12,6 +13,9 @@ namespace dae
 	class FireEffect final : public BaseEffect
 	{
 	public:
+		// compact vertex stream matching the input layout
+		using VertexType = FireVertex;
+
 		explicit FireEffect(ID3D11Device* pDevice, const std::wstring& assertfile);
 		virtual ~FireEffect();
 
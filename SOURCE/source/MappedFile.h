@@ -0,0 +1,35 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+namespace dae
+{
+	// Read-only memory mapped file (MapViewOfFile on Windows, mmap elsewhere)
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) noexcept = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+		bool IsOpen() const;
+		const char* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		const char* m_pData;
+		size_t m_Size;
+
+#ifdef _WIN32
+		void* m_FileHandle;
+		void* m_MappingHandle;
+#else
+		int m_FileDescriptor;
+#endif
+	};
+}
+
+#endif // !MAPPEDFILE_H
\ No newline at end of file
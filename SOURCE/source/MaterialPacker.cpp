@@ -0,0 +1,330 @@
+#include "pch.h"
+#include "MaterialPacker.h"
+#include "Texture.h"
+#include "VehicleShader.h"
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+namespace dae
+{
+	namespace
+	{
+		// shading from the packed maps against the uncompressed separate ones: the specular tint is all
+		// the uncompressed packing loses, compressed it has to be as close as the separate BC formats
+		constexpr double g_MinPackedPSNR{ 45.0 };
+		constexpr double g_MaxPSNRLoss{ 1.0 };
+
+		inline uint32_t GetChannel(uint32_t texel, int channel)
+		{
+			return (texel >> (channel * 8)) & 0xFF;
+		}
+
+		// like ToARGB in SoftwareRasterizer.cpp
+		inline uint32_t ToChannel(float value)
+		{
+			return static_cast<uint32_t>(Saturate(value) * 255.f);
+		}
+
+		// top level only, the packed image gets its own mip chain at load time
+		std::unique_ptr<Texture> LoadSource(const std::string& path)
+		{
+			return std::unique_ptr<Texture>{ Texture::LoadFromFile(nullptr, path, MipSettings{ MipFilter::None }) };
+		}
+
+		bool WriteImage(const std::string& path, std::vector<uint32_t>& texels, int width, int height)
+		{
+			SDL_Surface* pSurface{ SDL_CreateRGBSurfaceWithFormatFrom(texels.data(), width, height, 32, width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_RGBA32) };
+			if (!pSurface) return false;
+
+			const bool isWritten{ IMG_SavePNG(pSurface, path.c_str()) == 0 };
+			SDL_FreeSurface(pSurface);
+			return isWritten;
+		}
+
+		bool PackImage(const std::string& rgbPath, const std::string& alphaPath, PackedAlpha packedAlpha, const std::string& outputPath)
+		{
+			const std::unique_ptr<Texture> pRGB{ LoadSource(rgbPath) };
+			const std::unique_ptr<Texture> pAlpha{ LoadSource(alphaPath) };
+			if (!pRGB || !pAlpha) return false;
+
+			if (pRGB->GetWidth() != pAlpha->GetWidth() || pRGB->GetHeight() != pAlpha->GetHeight())
+			{
+				std::cout << "Cannot pack " << rgbPath << " (" << pRGB->GetWidth() << "x" << pRGB->GetHeight() << ") with " << alphaPath
+					<< " (" << pAlpha->GetWidth() << "x" << pAlpha->GetHeight() << "), sizes differ\n";
+				return false;
+			}
+
+			const size_t nrOfTexels{ static_cast<size_t>(pRGB->GetWidth()) * pRGB->GetHeight() };
+			std::vector<uint32_t> texels{ PackTexels({ pRGB->GetTexels(), nrOfTexels }, { pAlpha->GetTexels(), nrOfTexels }, packedAlpha) };
+			if (!WriteImage(outputPath, texels, pRGB->GetWidth(), pRGB->GetHeight()))
+			{
+				std::cout << "Could not write packed image: " << outputPath << "\n";
+				return false;
+			}
+
+			std::cout << "Packed " << rgbPath << " + " << alphaPath << " into " << outputPath << "\n";
+			return true;
+		}
+
+		// missing, or older than one of the maps it is built from
+		bool IsOutOfDate(const std::string& outputPath, std::initializer_list<const std::string*> sourcePaths)
+		{
+			std::error_code errorCode{};
+			const std::filesystem::file_time_type outputTime{ std::filesystem::last_write_time(outputPath, errorCode) };
+			if (errorCode) return true;
+
+			for (const std::string* pSourcePath : sourcePaths)
+			{
+				const std::filesystem::file_time_type sourceTime{ std::filesystem::last_write_time(*pSourcePath, errorCode) };
+				if (errorCode || sourceTime > outputTime) return true;
+			}
+			return false;
+		}
+	}
+
+	MaterialPaths GetVehicleMaterialPaths()
+	{
+		return MaterialPaths{
+			"Resources/vehicle_diffuse.png",
+			"Resources/vehicle_normal.png",
+			"Resources/vehicle_specular.png",
+			"Resources/vehicle_gloss.png",
+			"Resources/vehicle_diffuse_gloss.png",
+			"Resources/vehicle_normal_specular.png" };
+	}
+
+	std::vector<uint32_t> PackTexels(std::span<const uint32_t> rgbTexels, std::span<const uint32_t> alphaTexels, PackedAlpha packedAlpha)
+	{
+		assert(rgbTexels.size() == alphaTexels.size());
+
+		std::vector<uint32_t> texels(rgbTexels.size());
+		for (size_t idx{}; idx < texels.size(); ++idx)
+		{
+			const uint32_t alphaTexel{ alphaTexels[idx] };
+			const uint32_t alpha{ packedAlpha == PackedAlpha::Red
+				? GetChannel(alphaTexel, 0)
+				: (GetChannel(alphaTexel, 0) + GetChannel(alphaTexel, 1) + GetChannel(alphaTexel, 2) + 1) / 3 };
+			texels[idx] = (rgbTexels[idx] & 0x00FFFFFFu) | (alpha << 24);
+		}
+		return texels;
+	}
+
+	bool BuildPackedMaterial(const MaterialPaths& paths, bool force)
+	{
+		bool isBuilt{ true };
+		if (force || IsOutOfDate(paths.diffuseGloss, { &paths.diffuse, &paths.glossiness }))
+		{
+			isBuilt &= PackImage(paths.diffuse, paths.glossiness, PackedAlpha::Red, paths.diffuseGloss);
+		}
+		if (force || IsOutOfDate(paths.normalSpecular, { &paths.normal, &paths.specular }))
+		{
+			isBuilt &= PackImage(paths.normal, paths.specular, PackedAlpha::Intensity, paths.normalSpecular);
+		}
+		return isBuilt;
+	}
+
+	VehicleSamples8 SampleVehicleMaps(const Texture& diffuseMap, const Texture& normalMap, const Texture& specularMap, const Texture& glossinessMap,
+		const TextureCoordinates8& coordinates, FilteringMode filteringMode)
+	{
+		return VehicleSamples8{
+			SampleTexture(diffuseMap, coordinates, filteringMode),
+			SampleTexture(normalMap, coordinates, filteringMode),
+			SampleTexture(specularMap, coordinates, filteringMode),
+			SampleTexture(glossinessMap, coordinates, filteringMode).x };
+	}
+
+	VehicleSamples8 SamplePackedVehicleMaps(const Texture& diffuseGlossMap, const Texture& normalSpecularMap, const TextureCoordinates8& coordinates, FilteringMode filteringMode)
+	{
+		const TextureSample8 diffuseGloss{ SampleTextureRGBA(diffuseGlossMap, coordinates, filteringMode) };
+		const TextureSample8 normalSpecular{ SampleTextureRGBA(normalSpecularMap, coordinates, filteringMode) };
+		return VehicleSamples8{
+			diffuseGloss.color,
+			normalSpecular.color,
+			Vector3x8{ normalSpecular.alpha, normalSpecular.alpha, normalSpecular.alpha },
+			diffuseGloss.alpha };
+	}
+
+	namespace Utils
+	{
+		bool CompareMaterialPacking(const MaterialPaths& paths, size_t nrOfFragments)
+		{
+			if (!BuildPackedMaterial(paths)) return false;
+
+			// the settings of Renderer::InitMesh, once without block compression
+			struct MaterialSet
+			{
+				const char* pName;
+				std::unique_ptr<Texture> pDiffuse;
+				std::unique_ptr<Texture> pNormal;
+				std::unique_ptr<Texture> pSpecular;
+				std::unique_ptr<Texture> pGlossiness;
+				std::unique_ptr<Texture> pDiffuseGloss;
+				std::unique_ptr<Texture> pNormalSpecular;
+			};
+			const auto loadSet = [&](const char* pName, bool isCompressed)
+				{
+					const auto load = [&](const std::string& path, MipContent content, BlockFormat format)
+						{
+							const CompressionSettings compression{ isCompressed ? format : BlockFormat::None, CompressionQuality::Quality };
+							return std::unique_ptr<Texture>{ Texture::LoadFromFile(nullptr, path, MipSettings{ MipFilter::Kaiser, content }, compression) };
+						};
+					return MaterialSet{ pName,
+						load(paths.diffuse, MipContent::SRGBColor, BlockFormat::BC1),
+						load(paths.normal, MipContent::NormalMap, BlockFormat::BC5),
+						load(paths.specular, MipContent::Color, BlockFormat::BC1),
+						load(paths.glossiness, MipContent::Color, BlockFormat::BC4),
+						load(paths.diffuseGloss, MipContent::SRGBColor, BlockFormat::BC3),
+						load(paths.normalSpecular, MipContent::NormalMap, BlockFormat::BC3) };
+				};
+			MaterialSet sets[2]{ loadSet("R8G8B8A8", false), loadSet("BC", true) };
+			for (const MaterialSet& set : sets)
+			{
+				if (!set.pDiffuse || !set.pNormal || !set.pSpecular || !set.pGlossiness || !set.pDiffuseGloss || !set.pNormalSpecular) return false;
+			}
+
+			constexpr int nrOfLanes{ Float8::NrOfLanes };
+			nrOfFragments = std::max<size_t>((nrOfFragments + nrOfLanes - 1) / nrOfLanes * nrOfLanes, nrOfLanes);
+
+			// surface points like ValidateVehicleShading, coordinates like BenchmarkTextureSampler
+			std::mt19937 generator{ 42 };
+			std::uniform_real_distribution<float> unitDistribution{ 0.f, 1.f };
+			std::uniform_real_distribution<float> signedDistribution{ -1.f, 1.f };
+			const auto randomDirection = [&]()
+				{
+					Vector3 direction{};
+					while (direction.SqrMagnitude() < 0.01f) direction = Vector3{ signedDistribution(generator), signedDistribution(generator), signedDistribution(generator) };
+					return direction.Normalized();
+				};
+			const Vector3 cameraPosition{ 0.f, 0.f, -50.f };
+			const float texelSize{ 1.f / std::max(sets[0].pDiffuse->GetWidth(), sets[0].pDiffuse->GetHeight()) };
+
+			// SoA: world position, normal, tangent, u, v, ddx u, ddx v, ddy u, ddy v
+			constexpr int nrOfComponents{ 15 };
+			std::vector<float> soa(nrOfFragments * nrOfComponents);
+			const auto getSoA = [&](int component) { return soa.data() + nrOfFragments * component; };
+			for (size_t idx{}; idx < nrOfFragments; ++idx)
+			{
+				const Vector3 worldPosition{ Vector3{ signedDistribution(generator), signedDistribution(generator), signedDistribution(generator) } * 20.f };
+				const Vector3 normal{ randomDirection() };
+				Vector3 tangent{ randomDirection() };
+				tangent = tangent - normal * Vector3::Dot(tangent, normal);
+				tangent = tangent.SqrMagnitude() > 1e-4f ? tangent.Normalized() : Vector3::Cross(normal, Vector3::UnitY).Normalized();
+
+				const float angle{ unitDistribution(generator) * 6.2831853f };
+				const float length{ texelSize * std::exp2(-3.f + 9.f * unitDistribution(generator)) };
+				const float anisotropy{ std::exp2(5.f * unitDistribution(generator)) };
+				const float values[nrOfComponents]{
+					worldPosition.x, worldPosition.y, worldPosition.z, normal.x, normal.y, normal.z, tangent.x, tangent.y, tangent.z,
+					unitDistribution(generator), unitDistribution(generator),
+					std::cos(angle) * length, std::sin(angle) * length,
+					-std::sin(angle) * length / anisotropy, std::cos(angle) * length / anisotropy };
+				for (int component{}; component < nrOfComponents; ++component) getSoA(component)[idx] = values[component];
+			}
+
+			// 8-bit rgb of every fragment, what ends up in the framebuffer
+			const auto shade = [&](const MaterialSet& set, bool isPacked, FilteringMode filteringMode, std::vector<uint8_t>& output)
+				{
+					const auto startTime{ std::chrono::steady_clock::now() };
+					for (size_t idx{}; idx < nrOfFragments; idx += nrOfLanes)
+					{
+						const auto load2 = [&](int component) { return Vector2x8{ Float8::Load(getSoA(component) + idx), Float8::Load(getSoA(component + 1) + idx) }; };
+						const auto load3 = [&](int component) { return Vector3x8::Load(getSoA(component) + idx, getSoA(component + 1) + idx, getSoA(component + 2) + idx); };
+						const TextureCoordinates8 coordinates{ load2(9), load2(11), load2(13) };
+
+						const VehicleSamples8 samples{ isPacked
+							? SamplePackedVehicleMaps(*set.pDiffuseGloss, *set.pNormalSpecular, coordinates, filteringMode)
+							: SampleVehicleMaps(*set.pDiffuse, *set.pNormal, *set.pSpecular, *set.pGlossiness, coordinates, filteringMode) };
+						const VehicleFragments8 fragments{ load3(0), load3(3), load3(6), samples.diffuse, samples.normal, samples.specular, samples.glossiness };
+
+						alignas(32) float channels[3][nrOfLanes];
+						ShadeVehicle(fragments, cameraPosition).Store(channels[0], channels[1], channels[2]);
+						for (int lane{}; lane < nrOfLanes; ++lane)
+						{
+							for (int channel{}; channel < 3; ++channel) output[(idx + lane) * 3 + channel] = static_cast<uint8_t>(ToChannel(channels[channel][lane]));
+						}
+					}
+					return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+				};
+
+			const auto getPSNR = [&](const std::vector<uint8_t>& colors, const std::vector<uint8_t>& referenceColors)
+				{
+					double squaredError{};
+					for (size_t idx{}; idx < colors.size(); ++idx)
+					{
+						const int difference{ colors[idx] - referenceColors[idx] };
+						squaredError += difference * difference;
+					}
+					const double meanSquaredError{ squaredError / colors.size() };
+					return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+				};
+
+#if defined(__AVX2__)
+			const char* pInstructionSet{ "AVX2" };
+#else
+			const char* pInstructionSet{ "scalar" };
+#endif
+			std::cout << "Material Packing Comparison: " << paths.diffuseGloss << " + " << paths.normalSpecular << ", " << nrOfFragments << " fragments, " << pInstructionSet << "\n";
+
+			// GPU bytes of all levels per top level texel
+			for (const MaterialSet& set : sets)
+			{
+				const auto getBytesPerTexel = [&](std::initializer_list<const Texture*> textures)
+					{
+						size_t size{};
+						for (const Texture* pTexture : textures) size += pTexture->GetGPUSize();
+						return static_cast<double>(size) / (static_cast<double>(set.pDiffuse->GetWidth()) * set.pDiffuse->GetHeight());
+					};
+				std::cout << "  " << set.pName << ": separate " << getBytesPerTexel({ set.pDiffuse.get(), set.pNormal.get(), set.pSpecular.get(), set.pGlossiness.get() })
+					<< " bytes / texel (4 fetches), packed " << getBytesPerTexel({ set.pDiffuseGloss.get(), set.pNormalSpecular.get() }) << " bytes / texel (2 fetches)\n";
+			}
+
+			const char* modeNames[3]{ "Point", "Linear", "Anisotropic" };
+			std::vector<uint8_t> referenceColors(nrOfFragments * 3);
+			std::vector<uint8_t> separateColors(nrOfFragments * 3);
+			std::vector<uint8_t> packedColors(nrOfFragments * 3);
+			bool isValid{ true };
+			for (int mode{}; mode < 3; ++mode)
+			{
+				const FilteringMode filteringMode{ static_cast<FilteringMode>(mode) };
+				shade(sets[0], false, filteringMode, referenceColors);
+
+				for (const MaterialSet& set : sets)
+				{
+					const double separateMs{ shade(set, false, filteringMode, separateColors) };
+					const double packedMs{ shade(set, true, filteringMode, packedColors) };
+
+					uint32_t maxDifference{};
+					uint64_t sumDifference{};
+					size_t nrOfDifferentPixels{};
+					for (size_t idx{}; idx < nrOfFragments; ++idx)
+					{
+						uint32_t pixelDifference{};
+						for (int channel{}; channel < 3; ++channel)
+						{
+							const int difference{ std::abs(packedColors[idx * 3 + channel] - separateColors[idx * 3 + channel]) };
+							pixelDifference = std::max(pixelDifference, static_cast<uint32_t>(difference));
+							sumDifference += difference;
+						}
+						maxDifference = std::max(maxDifference, pixelDifference);
+						if (pixelDifference > 1) ++nrOfDifferentPixels;
+					}
+
+					const double separatePSNR{ getPSNR(separateColors, referenceColors) };
+					const double packedPSNR{ getPSNR(packedColors, referenceColors) };
+					const double meanDifference{ static_cast<double>(sumDifference) / (nrOfFragments * 3) };
+					if (packedPSNR < std::min(separatePSNR - g_MaxPSNRLoss, g_MinPackedPSNR)) isValid = false;
+
+					std::cout << "  " << set.pName << ", " << modeNames[mode] << ": separate " << separateMs << " ms, packed " << packedMs << " ms ("
+						<< separateMs / packedMs << "x), max difference " << maxDifference << " / 255, mean " << meanDifference << " / 255, "
+						<< 100.0 * nrOfDifferentPixels / nrOfFragments << "% pixels off by more than 1 / 255, PSNR vs R8G8B8A8 separate: separate "
+						<< separatePSNR << " dB, packed " << packedPSNR << " dB\n";
+				}
+			}
+
+			std::cout << (isValid ? "  Material packing: OK\n" : "  Material packing: MISMATCH\n");
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef MATERIALPACKER_H
+#define MATERIALPACKER_H
+
+#include "TextureSampler.h"
+
+namespace dae
+{
+	class Texture;
+
+	// Channel packing of the vehicle material, 4 maps in 2 textures (half the fetches per pixel):
+	// diffuse gloss    rgb = diffuse,    a = glossiness (r)                 -> MipContent::SRGBColor, BC3
+	// normal specular  rgb = normal map, a = specular intensity (mean of rgb) -> MipContent::NormalMap, BC3
+	// Both contents filter alpha as linear data, the packed mip levels match the levels of the separate maps.
+	// Specular as an intensity drops its colour tint, an accepted difference (rgb specular needs a third texture).
+	struct MaterialPaths
+	{
+		std::string diffuse;
+		std::string normal;
+		std::string specular;
+		std::string glossiness;
+		std::string diffuseGloss;
+		std::string normalSpecular;
+	};
+
+	// Resources/vehicle_*.png
+	MaterialPaths GetVehicleMaterialPaths();
+
+	// where the alpha of a packed texel comes from
+	enum class PackedAlpha
+	{
+		Red = 0,   // single channel map (glossiness)
+		Intensity, // mean of rgb, a tinted map loses its tint (specular)
+	};
+
+	// rgb of rgbTexels, alpha from alphaTexels, both the same size
+	std::vector<uint32_t> PackTexels(std::span<const uint32_t> rgbTexels, std::span<const uint32_t> alphaTexels, PackedAlpha packedAlpha);
+
+	// Asset build step: writes the two packed images when they are missing, older than one of the source maps
+	// or when forced. The packed images load through Texture::LoadFromFile like any other (mips, BC3, cache).
+	bool BuildPackedMaterial(const MaterialPaths& paths, bool force = false);
+
+	// the 4 samples Vehicle.fx shades with, 8 pixels
+	struct VehicleSamples8
+	{
+		Vector3x8 diffuse;
+		Vector3x8 normal;
+		Vector3x8 specular;
+		Float8 glossiness;
+	};
+
+	// CPU counterparts of ShadeSeparate (4 fetches) and ShadePacked (2 fetches) in Vehicle.fx
+	VehicleSamples8 SampleVehicleMaps(const Texture& diffuseMap, const Texture& normalMap, const Texture& specularMap, const Texture& glossinessMap,
+		const TextureCoordinates8& coordinates, FilteringMode filteringMode);
+	VehicleSamples8 SamplePackedVehicleMaps(const Texture& diffuseGlossMap, const Texture& normalSpecularMap, const TextureCoordinates8& coordinates, FilteringMode filteringMode);
+
+	namespace Utils
+	{
+		// Random fragments shaded from the separate and from the packed maps (same coordinates, every filtering mode),
+		// uncompressed and block compressed: output difference in 8-bit steps, PSNR against the uncompressed separate
+		// maps, texture bytes per texel and sampling time. Returns false when packing costs more than it should.
+		bool CompareMaterialPacking(const MaterialPaths& paths, size_t nrOfFragments = 1 << 18);
+	}
+}
+
+#endif // !MATERIALPACKER_H
\ No newline at end of file
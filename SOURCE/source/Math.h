@@ -6,6 +6,7 @@
 #include "Vector3.h"
 #include "Vector4.h"
 #include "Matrix.h"
+#include "Quaternion.h"
 #include "MathHelpers.h"
 
 #endif // !MATH_H
\ No newline at end of file
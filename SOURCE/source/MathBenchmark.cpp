@@ -0,0 +1,148 @@
+#include "pch.h"
+#include "MathBenchmark.h"
+#include "DataTypes.h"
+#include "VectorN.h"
+
+#include <chrono>
+#include <random>
+
+namespace dae
+{
+	namespace Utils
+	{
+		namespace
+		{
+			double GetElapsedMs(std::chrono::steady_clock::time_point start)
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			// best of nrOfRuns, in ms
+			template<typename Function>
+			double MeasureBest(int nrOfRuns, const Function& function)
+			{
+				double bestMs{ DBL_MAX };
+				for (int run{}; run < nrOfRuns; ++run)
+				{
+					const auto startTime{ std::chrono::steady_clock::now() };
+					function();
+					bestMs = std::min(bestMs, GetElapsedMs(startTime));
+				}
+				return bestMs;
+			}
+
+			void PrintResult(const char* label, size_t nrOfVertices, double bestMs, double referenceMs)
+			{
+				const double verticesPerSecond{ nrOfVertices / (bestMs / 1000.0) };
+				std::cout << "  " << label << bestMs << " ms, " << verticesPerSecond / 1e6 << " M vertices/s/core"
+					<< " (" << referenceMs / bestMs << "x)\n";
+			}
+		}
+
+		void BenchmarkTransform(size_t nrOfVertices, int nrOfRuns)
+		{
+			std::mt19937 generator{ 42 };
+			std::uniform_real_distribution<float> distribution{ -10.f, 10.f };
+
+			std::vector<Vertex> vertices(nrOfVertices);
+			std::vector<float> positionsX(nrOfVertices);
+			std::vector<float> positionsY(nrOfVertices);
+			std::vector<float> positionsZ(nrOfVertices);
+			for (size_t idx{}; idx < nrOfVertices; ++idx)
+			{
+				vertices[idx].position = Vector3{ distribution(generator), distribution(generator), distribution(generator) };
+				positionsX[idx] = vertices[idx].position.x;
+				positionsY[idx] = vertices[idx].position.y;
+				positionsZ[idx] = vertices[idx].position.z;
+			}
+
+			const Matrix worldViewProjection{ Matrix::CreateRotation(0.3f, 0.7f, 0.f) * Matrix::CreateTranslation(0.f, 0.f, 50.f)
+				* Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS / 2.f), 640.f / 480.f, 0.1f, 1000.f) };
+			std::vector<Vector4> clipPositions(nrOfVertices);
+
+#if defined(__AVX2__)
+			const char* pInstructionSet{ "AVX2" };
+#else
+			const char* pInstructionSet{ "SSE" };
+#endif
+			std::cout << "Transform Benchmark: " << nrOfVertices << " vertices, " << nrOfRuns << " runs, " << pInstructionSet << "\n";
+
+			const double scalarMs{ MeasureBest(nrOfRuns, [&]()
+				{
+					for (size_t idx{}; idx < nrOfVertices; ++idx)
+					{
+						clipPositions[idx] = worldViewProjection.TransformPoint(Vector4{ vertices[idx].position, 1.f });
+					}
+				}) };
+			const std::vector<Vector4> referencePositions{ clipPositions };
+
+			const double batchAoSMs{ MeasureBest(nrOfRuns, [&]() { worldViewProjection.TransformPoints(vertices, clipPositions); }) };
+			float maxDifference{};
+			for (size_t idx{}; idx < nrOfVertices; ++idx)
+			{
+				maxDifference = std::max(maxDifference, (clipPositions[idx] - referencePositions[idx]).Magnitude());
+			}
+
+			const double batchSoAMs{ MeasureBest(nrOfRuns, [&]()
+				{
+					worldViewProjection.TransformPoints(positionsX.data(), positionsY.data(), positionsZ.data(), clipPositions.data(), nrOfVertices);
+				}) };
+			for (size_t idx{}; idx < nrOfVertices; ++idx)
+			{
+				maxDifference = std::max(maxDifference, (clipPositions[idx] - referencePositions[idx]).Magnitude());
+			}
+
+			// same SoA streams through the generic wide types (tail handled by the scalar path)
+			constexpr int width{ 8 };
+			const Matrixx8 wideWorldViewProjection{ Matrixx8::Broadcast(worldViewProjection) };
+			const double wideMs{ MeasureBest(nrOfRuns, [&]()
+				{
+					size_t idx{};
+					for (; idx + width <= nrOfVertices; idx += width)
+					{
+						const Vector3x8 positions{ Vector3x8::Load(&positionsX[idx], &positionsY[idx], &positionsZ[idx]) };
+						TransformPoint(wideWorldViewProjection, positions).Store(&clipPositions[idx], sizeof(Vector4));
+					}
+					for (; idx < nrOfVertices; ++idx)
+					{
+						clipPositions[idx] = worldViewProjection.TransformPoint(Vector4{ positionsX[idx], positionsY[idx], positionsZ[idx], 1.f });
+					}
+				}) };
+			for (size_t idx{}; idx < nrOfVertices; ++idx)
+			{
+				maxDifference = std::max(maxDifference, (clipPositions[idx] - referencePositions[idx]).Magnitude());
+			}
+
+			// world matrices of many instances: Euler matrices vs quaternions (vertices = instances here)
+			std::vector<Vector3> angles(nrOfVertices);
+			std::vector<Vector3> translations(nrOfVertices);
+			std::vector<Quaternion> rotations(nrOfVertices);
+			std::vector<Matrix> worldMatrices(nrOfVertices);
+			for (size_t idx{}; idx < nrOfVertices; ++idx)
+			{
+				angles[idx] = Vector3{ distribution(generator), distribution(generator), distribution(generator) } * 0.1f;
+				translations[idx] = vertices[idx].position;
+				rotations[idx] = Quaternion::CreateRotation(angles[idx]);
+			}
+			const double eulerMs{ MeasureBest(nrOfRuns, [&]()
+				{
+					for (size_t idx{}; idx < nrOfVertices; ++idx)
+					{
+						worldMatrices[idx] = Matrix::CreateRotation(angles[idx]) * Matrix::CreateTranslation(translations[idx]);
+					}
+				}) };
+			const double quaternionMs{ MeasureBest(nrOfRuns, [&]()
+				{
+					Quaternion::ToMatrices(rotations, translations, worldMatrices);
+				}) };
+
+			PrintResult("Scalar TransformPoint:  ", nrOfVertices, scalarMs, scalarMs);
+			PrintResult("Batch (AoS Vertex):     ", nrOfVertices, batchAoSMs, scalarMs);
+			PrintResult("Batch (SoA streams):    ", nrOfVertices, batchSoAMs, scalarMs);
+			PrintResult("Vector3x8 (SoA):        ", nrOfVertices, wideMs, scalarMs);
+			std::cout << "  Max difference vs scalar: " << maxDifference << "\n";
+			PrintResult("Instances (Euler):      ", nrOfVertices, eulerMs, eulerMs);
+			PrintResult("Instances (Quaternion): ", nrOfVertices, quaternionMs, eulerMs);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef MATHBENCHMARK_H
+#define MATHBENCHMARK_H
+
+namespace dae
+{
+	namespace Utils
+	{
+		// Single threaded vertices / second of scalar Matrix::TransformPoint vs the batch
+		// transforms (AoS Vertex input and SoA input, clip space Vector4 output)
+		void BenchmarkTransform(size_t nrOfVertices = 1 << 20, int nrOfRuns = 5);
+	}
+}
+
+#endif // !MATHBENCHMARK_H
\ No newline at end of file
@@ -5,8 +5,150 @@
 #include <cmath>
 
 #include "MathHelpers.h"
+#include "DataTypes.h"
+
+#include <immintrin.h>
 
 namespace dae {
+	namespace
+	{
+		// rows of the matrix, out = x * row0 + y * row1 + z * row2 (+ row3 for points)
+		struct MatrixRows
+		{
+			__m128 row0;
+			__m128 row1;
+			__m128 row2;
+			__m128 row3;
+		};
+
+		inline MatrixRows GetRows(const Matrix& matrix)
+		{
+			const Vector4 rows[4]{ matrix[0], matrix[1], matrix[2], matrix[3] };
+			return MatrixRows{ _mm_loadu_ps(&rows[0].x), _mm_loadu_ps(&rows[1].x), _mm_loadu_ps(&rows[2].x), _mm_loadu_ps(&rows[3].x) };
+		}
+
+		inline const float* GetElement(const void* pBase, size_t stride, size_t index)
+		{
+			return reinterpret_cast<const float*>(static_cast<const char*>(pBase) + stride * index);
+		}
+
+		inline float* GetElement(void* pBase, size_t stride, size_t index)
+		{
+			return reinterpret_cast<float*>(static_cast<char*>(pBase) + stride * index);
+		}
+
+		inline __m128 TransformSSE(const MatrixRows& rows, float x, float y, float z, bool isPoint)
+		{
+			__m128 result{ _mm_mul_ps(_mm_set1_ps(x), rows.row0) };
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(y), rows.row1));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(z), rows.row2));
+			return isPoint ? _mm_add_ps(result, rows.row3) : result;
+		}
+
+		// writes xyz only, never touches the 4th float (the next element of a packed Vector3 array)
+		inline void StoreVector3(float* pResult, __m128 value)
+		{
+			_mm_storel_pi(reinterpret_cast<__m64*>(pResult), value);
+			_mm_store_ss(pResult + 2, _mm_movehl_ps(value, value));
+		}
+
+		template<int Components>
+		inline void Store(float* pResult, __m128 value)
+		{
+			if constexpr (Components == 4) _mm_storeu_ps(pResult, value);
+			else StoreVector3(pResult, value);
+		}
+
+#if defined(__AVX2__)
+		// 8 elements at once in SoA form, then transposed back to 8 x (x, y, z, w)
+		struct WideRows
+		{
+			__m256 m[4][4]; // m[row][column] broadcast
+		};
+
+		inline WideRows GetWideRows(const Matrix& matrix)
+		{
+			WideRows rows{};
+			for (int row{}; row < 4; ++row)
+			{
+				for (int column{}; column < 4; ++column)
+				{
+					rows.m[row][column] = _mm256_set1_ps(matrix[row][column]);
+				}
+			}
+			return rows;
+		}
+
+		template<int Components>
+		inline void TransformAVX2(const WideRows& rows, __m256 x, __m256 y, __m256 z, bool isPoint, float* pResult, size_t resultStride)
+		{
+			__m256 result[4];
+			for (int column{}; column < 4; ++column)
+			{
+				__m256 value{ isPoint ? rows.m[3][column] : _mm256_setzero_ps() };
+				value = _mm256_fmadd_ps(x, rows.m[0][column], value);
+				value = _mm256_fmadd_ps(y, rows.m[1][column], value);
+				value = _mm256_fmadd_ps(z, rows.m[2][column], value);
+				result[column] = value;
+			}
+
+			// 4x8 transpose: x0 y0 z0 w0 | x4 y4 z4 w4, x1 .. | x5 .., ...
+			const __m256 xy0{ _mm256_unpacklo_ps(result[0], result[1]) };
+			const __m256 xy1{ _mm256_unpackhi_ps(result[0], result[1]) };
+			const __m256 zw0{ _mm256_unpacklo_ps(result[2], result[3]) };
+			const __m256 zw1{ _mm256_unpackhi_ps(result[2], result[3]) };
+			const __m256 elements[4]
+			{
+				_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2)),
+			};
+			for (int idx{}; idx < 4; ++idx)
+			{
+				Store<Components>(GetElement(pResult, resultStride, idx), _mm256_castps256_ps128(elements[idx]));
+				Store<Components>(GetElement(pResult, resultStride, idx + 4), _mm256_extractf128_ps(elements[idx], 1));
+			}
+		}
+
+		inline __m256i GetGatherOffsets(size_t stride)
+		{
+			const int strideInFloats{ static_cast<int>(stride / sizeof(float)) };
+			return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(strideInFloats));
+		}
+#endif
+
+		template<int Components>
+		void TransformStream(const Matrix& matrix, const Vector3* pInput, size_t inputStride, float* pResult, size_t resultStride, size_t count, bool isPoint)
+		{
+			size_t idx{};
+
+#if defined(__AVX2__)
+			// gathers need a whole number of floats between elements
+			if (inputStride % sizeof(float) == 0 && inputStride * 8 <= INT32_MAX)
+			{
+				const WideRows rows{ GetWideRows(matrix) };
+				const __m256i offsets{ GetGatherOffsets(inputStride) };
+				for (; idx + 8 <= count; idx += 8)
+				{
+					const float* pFirst{ GetElement(pInput, inputStride, idx) };
+					const __m256 x{ _mm256_i32gather_ps(pFirst, offsets, 4) };
+					const __m256 y{ _mm256_i32gather_ps(pFirst + 1, offsets, 4) };
+					const __m256 z{ _mm256_i32gather_ps(pFirst + 2, offsets, 4) };
+					TransformAVX2<Components>(rows, x, y, z, isPoint, GetElement(pResult, resultStride, idx), resultStride);
+				}
+			}
+#endif
+
+			const MatrixRows rows{ GetRows(matrix) };
+			for (; idx < count; ++idx)
+			{
+				const float* pElement{ GetElement(pInput, inputStride, idx) };
+				Store<Components>(GetElement(pResult, resultStride, idx), TransformSSE(rows, pElement[0], pElement[1], pElement[2], isPoint));
+			}
+		}
+	}
+
 	Matrix::Matrix(const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis, const Vector3& t) :
 		Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
 	{
@@ -71,6 +213,47 @@ namespace dae {
 		};
 	}
 
+	void Matrix::TransformPoints(const Vector3* pPoints, size_t pointStride, Vector4* pResult, size_t resultStride, size_t count) const
+	{
+		TransformStream<4>(*this, pPoints, pointStride, &pResult->x, resultStride, count, true);
+	}
+
+	void Matrix::TransformPoints(const Vector3* pPoints, size_t pointStride, Vector3* pResult, size_t resultStride, size_t count) const
+	{
+		TransformStream<3>(*this, pPoints, pointStride, &pResult->x, resultStride, count, true);
+	}
+
+	void Matrix::TransformVectors(const Vector3* pVectors, size_t vectorStride, Vector3* pResult, size_t resultStride, size_t count) const
+	{
+		TransformStream<3>(*this, pVectors, vectorStride, &pResult->x, resultStride, count, false);
+	}
+
+	void Matrix::TransformPoints(const float* pX, const float* pY, const float* pZ, Vector4* pResult, size_t count) const
+	{
+		size_t idx{};
+
+#if defined(__AVX2__)
+		const WideRows wideRows{ GetWideRows(*this) };
+		for (; idx + 8 <= count; idx += 8)
+		{
+			TransformAVX2<4>(wideRows, _mm256_loadu_ps(pX + idx), _mm256_loadu_ps(pY + idx), _mm256_loadu_ps(pZ + idx), true, &pResult[idx].x, sizeof(Vector4));
+		}
+#endif
+
+		const MatrixRows rows{ GetRows(*this) };
+		for (; idx < count; ++idx)
+		{
+			_mm_storeu_ps(&pResult[idx].x, TransformSSE(rows, pX[idx], pY[idx], pZ[idx], true));
+		}
+	}
+
+	void Matrix::TransformPoints(std::span<const Vertex> vertices, std::span<Vector4> result) const
+	{
+		assert(result.size() >= vertices.size());
+		if (vertices.empty()) return;
+		TransformPoints(&vertices[0].position, sizeof(Vertex), result.data(), sizeof(Vector4), vertices.size());
+	}
+
 	const Matrix& Matrix::Transpose()
 	{
 		Matrix result{};
@@ -127,6 +310,50 @@ namespace dae {
 		return *this;
 	}
 
+	const Matrix& Matrix::InverseAffine()
+	{
+		assert(AreEqual(data[0].w, 0.f) && AreEqual(data[1].w, 0.f) && AreEqual(data[2].w, 0.f) && AreEqual(data[3].w, 1.f) && "ERROR: matrix is not affine!");
+
+		// inverse of the 3x3 part: the cross products of its rows are the columns of the adjugate
+		const Vector3 a{ data[0] };
+		const Vector3 b{ data[1] };
+		const Vector3 c{ data[2] };
+		const Vector3 t{ data[3] };
+
+		const Vector3 r0{ Vector3::Cross(b, c) };
+		const Vector3 r1{ Vector3::Cross(c, a) };
+		const Vector3 r2{ Vector3::Cross(a, b) };
+
+		const float det{ Vector3::Dot(a, r0) };
+		assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+		const float invDet{ 1.f / det };
+
+		data[0] = Vector4{ r0.x * invDet, r1.x * invDet, r2.x * invDet, 0.f };
+		data[1] = Vector4{ r0.y * invDet, r1.y * invDet, r2.y * invDet, 0.f };
+		data[2] = Vector4{ r0.z * invDet, r1.z * invDet, r2.z * invDet, 0.f };
+
+		// translation = -t * inverse(3x3)
+		const Vector3 invT{ TransformVector(t) };
+		data[3] = Vector4{ -invT.x, -invT.y, -invT.z, 1.f };
+
+		return *this;
+	}
+
+	const Matrix& Matrix::InverseOrthonormal()
+	{
+		// the inverse of a rotation is its transpose, translation = -t * transpose(3x3)
+		const Vector3 t{ data[3] };
+
+		std::swap(data[0].y, data[1].x);
+		std::swap(data[0].z, data[2].x);
+		std::swap(data[1].z, data[2].y);
+
+		const Vector3 invT{ TransformVector(t) };
+		data[3] = Vector4{ -invT.x, -invT.y, -invT.z, 1.f };
+
+		return *this;
+	}
+
 	Matrix Matrix::Transpose(const Matrix& m)
 	{
 		Matrix out{ m };
@@ -143,6 +370,22 @@ namespace dae {
 		return out;
 	}
 
+	Matrix Matrix::InverseAffine(const Matrix& m)
+	{
+		Matrix out{ m };
+		out.InverseAffine();
+
+		return out;
+	}
+
+	Matrix Matrix::InverseOrthonormal(const Matrix& m)
+	{
+		Matrix out{ m };
+		out.InverseOrthonormal();
+
+		return out;
+	}
+
 	Matrix Matrix::CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
 	{
 		/*zaxis = normal(At - Eye)
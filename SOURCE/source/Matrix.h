@@ -6,6 +6,8 @@
 
 namespace dae
 {
+	struct Vertex;
+
 	struct Matrix
 	{
 		Matrix() = default;
@@ -31,8 +33,22 @@ namespace dae
 		Vector4 TransformPoint(const Vector4& p) const;
 		Vector4 TransformPoint(float x, float y, float z, float w) const;
 
+		// Batch transforms (SSE, AVX2 when built with /arch:AVX2), same math as the scalar versions.
+		// Strides are in bytes, so AoS streams such as Vertex::position can be read / written in place.
+		void TransformPoints(const Vector3* pPoints, size_t pointStride, Vector4* pResult, size_t resultStride, size_t count) const;
+		void TransformPoints(const Vector3* pPoints, size_t pointStride, Vector3* pResult, size_t resultStride, size_t count) const;
+		void TransformVectors(const Vector3* pVectors, size_t vectorStride, Vector3* pResult, size_t resultStride, size_t count) const;
+		// SoA input
+		void TransformPoints(const float* pX, const float* pY, const float* pZ, Vector4* pResult, size_t count) const;
+		// (position, 1) of every vertex to clip space
+		void TransformPoints(std::span<const Vertex> vertices, std::span<Vector4> result) const;
+
 		const Matrix& Transpose();
 		const Matrix& Inverse();
+		// Fast paths for matrices with (0, 0, 0, 1) as last column (world / view matrices).
+		// InverseAffine: any invertible 3x3 part (scale, shear). InverseOrthonormal: rotation + translation only.
+		const Matrix& InverseAffine();
+		const Matrix& InverseOrthonormal();
 
 		Vector3 GetAxisX() const;
 		Vector3 GetAxisY() const;
@@ -50,6 +66,8 @@ namespace dae
 		static Matrix CreateScale(const Vector3& s);
 		static Matrix Transpose(const Matrix& m);
 		static Matrix Inverse(const Matrix& m);
+		static Matrix InverseAffine(const Matrix& m);
+		static Matrix InverseOrthonormal(const Matrix& m);
 
 		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
 		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
@@ -2,9 +2,14 @@
 #define MESH_H
 
 #include "DataTypes.h"
+#include "MeshData.h"
+#include "VertexFormats.h"
 #include "Matrix.h"
+#include "ResourceCache.h"
+#ifdef DAE_HAS_DIRECTX
 #include "VehicleEffect.h"
 #include "FireEffect.h"
+#endif
 
 namespace dae
 {
@@ -19,7 +24,8 @@ namespace dae
 	class Mesh final
 	{
 	public:
-		explicit Mesh(ID3D11Device* pDevice, const std::vector<Vertex>& rawVertices, const std::vector<uint32_t>& rawIndices, const std::wstring& effectFileName);
+		// pDevice nullptr (headless / software only, always without DirectX): no effect and no buffers
+		explicit Mesh(ID3D11Device* pDevice, std::unique_ptr<MeshData> pMeshData, const std::wstring& effectFileName);
 		virtual ~Mesh();
 
 		Mesh(const Mesh&) = delete;
@@ -28,32 +34,76 @@ namespace dae
 		Mesh& operator=(Mesh&&) noexcept = delete;
 
 		EffectClass* GetEffect() const;
-
+		std::span<const Vertex> GetVertices() const;
+		std::span<const uint32_t> GetIndices() const;
+		// HashBytes of the mesh data and the effect file, meshes are shared through a ResourceCache
+		ContentHash GetContentHash() const;
+		// CPU arrays + vertex / index buffers
+		size_t GetMemorySize() const;
+
+		// ResourceCache key of an OBJ drawn with this effect
+		static std::string GetCacheKey(const std::string& objPath, const std::wstring& effectFileName);
+		// GetContentHash of the mesh this data would make, before it is created
+		static ContentHash HashContent(const MeshData& meshData, const std::wstring& effectFileName);
+
+#ifdef DAE_HAS_DIRECTX
 		void Render(ID3D11DeviceContext* pDeviceContext, uint32_t filterModeIndex) const;
+#endif
 
 	private:
 		EffectClass* m_pEffect;
+#ifdef DAE_HAS_DIRECTX
 		ID3D11Buffer* m_pVertexBuffer;
 		ID3D11Buffer* m_pIndexBuffer;
+#endif
 		uint32_t m_NumIndices;
+		ContentHash m_ContentHash;
+
+		// CPU side data for the software rasterizer (owned arrays or mapped mesh cache)
+		std::unique_ptr<MeshData> m_pMeshData;
 	};
 
 	// sorry for unstructured implementation, dividing .h and .cpp gets me linker errors
 	template<typename EffectClass>
-	Mesh<EffectClass>::Mesh(ID3D11Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::wstring& effectFileName)
+	Mesh<EffectClass>::Mesh(ID3D11Device* pDevice, std::unique_ptr<MeshData> pMeshData, const std::wstring& effectFileName)
+		: m_pEffect{ nullptr }
+#ifdef DAE_HAS_DIRECTX
+		, m_pVertexBuffer{ nullptr }
+		, m_pIndexBuffer{ nullptr }
+#endif
+		, m_NumIndices{ static_cast<uint32_t>(pMeshData->GetIndices().size()) }
+		, m_ContentHash{ HashContent(*pMeshData, effectFileName) }
+		, m_pMeshData{ std::move(pMeshData) }
 	{
+#ifdef DAE_HAS_DIRECTX
+		const std::span<const Vertex> vertices{ m_pMeshData->GetVertices() };
+		const std::span<const uint32_t> indices{ m_pMeshData->GetIndices() };
+
+		// no device (headless / software only)
+		if (!pDevice) return;
+
 		m_pEffect = new EffectClass{ pDevice, effectFileName };
 
+		// Compact vertex stream of the effect (quantized to the mesh bounds)
+		using VertexType = typename EffectClass::VertexType;
+		const VertexQuantization quantization{ VertexQuantization::FromVertices(vertices) };
+		std::vector<VertexType> compactVertices(vertices.size());
+		for (size_t idx{}; idx < vertices.size(); ++idx)
+		{
+			EncodeVertex(vertices[idx], quantization, compactVertices[idx]);
+		}
+		m_pEffect->SetQuantization(quantization);
+
 		// Create Vertex Buffer
 		D3D11_BUFFER_DESC bd{};
 		bd.Usage = D3D11_USAGE_IMMUTABLE;
-		bd.ByteWidth = sizeof(Vertex) * static_cast<uint32_t>(vertices.size());
+		bd.ByteWidth = sizeof(VertexType) * static_cast<uint32_t>(compactVertices.size());
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 		bd.CPUAccessFlags = 0;
 		bd.MiscFlags = 0;
 
 		D3D11_SUBRESOURCE_DATA initData{};
-		initData.pSysMem = vertices.data();
+		initData.pSysMem = compactVertices.data();
 
 		HRESULT result{ pDevice->CreateBuffer(&bd, &initData, &m_pVertexBuffer) };
 		if (FAILED(result))
@@ -62,8 +112,7 @@ namespace dae
 			return;
 		}
 
-		// Create Index Buffer
-		m_NumIndices = static_cast<uint32_t>(indices.size());
+		// Create Index Buffer (straight from the owned / mapped array)
 		bd.Usage = D3D11_USAGE_IMMUTABLE;
 		bd.ByteWidth = sizeof(uint32_t) * m_NumIndices;
 		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
@@ -76,14 +125,20 @@ namespace dae
 			assert(false);
 			return;
 		}
+#else
+		assert(!pDevice);
+		(void)pDevice;
+#endif
 	}
 
 	template<typename EffectClass>
 	Mesh<EffectClass>::~Mesh()
 	{
+#ifdef DAE_HAS_DIRECTX
 		if (m_pEffect) delete m_pEffect;
 		if (m_pVertexBuffer) m_pVertexBuffer->Release();
 		if (m_pIndexBuffer) m_pIndexBuffer->Release();
+#endif
 	}
 
 	template<typename EffectClass>
@@ -92,6 +147,49 @@ namespace dae
 		return m_pEffect;
 	}
 
+	template<typename EffectClass>
+	std::span<const Vertex> Mesh<EffectClass>::GetVertices() const
+	{
+		return m_pMeshData->GetVertices();
+	}
+
+	template<typename EffectClass>
+	std::span<const uint32_t> Mesh<EffectClass>::GetIndices() const
+	{
+		return m_pMeshData->GetIndices();
+	}
+
+	template<typename EffectClass>
+	ContentHash Mesh<EffectClass>::GetContentHash() const
+	{
+		return m_ContentHash;
+	}
+
+	template<typename EffectClass>
+	size_t Mesh<EffectClass>::GetMemorySize() const
+	{
+		const size_t cpuSize{ GetVertices().size_bytes() + GetIndices().size_bytes() };
+#ifdef DAE_HAS_DIRECTX
+		const size_t gpuSize{ m_pVertexBuffer ? GetVertices().size() * sizeof(typename EffectClass::VertexType) + GetIndices().size_bytes() : 0 };
+		return cpuSize + gpuSize;
+#else
+		return cpuSize;
+#endif
+	}
+
+	template<typename EffectClass>
+	std::string Mesh<EffectClass>::GetCacheKey(const std::string& objPath, const std::wstring& effectFileName)
+	{
+		return "mesh " + ResourceCache::GetCanonicalPath(objPath) + " effect " + ResourceCache::GetCanonicalPath(effectFileName);
+	}
+
+	template<typename EffectClass>
+	ContentHash Mesh<EffectClass>::HashContent(const MeshData& meshData, const std::wstring& effectFileName)
+	{
+		return HashBytes(effectFileName.data(), effectFileName.size() * sizeof(wchar_t), meshData.GetContentHash());
+	}
+
+#ifdef DAE_HAS_DIRECTX
 	template<typename EffectClass>
 	void Mesh<EffectClass>::Render(ID3D11DeviceContext* pDeviceContext, uint32_t filterModeIndex) const
 	{
@@ -102,7 +200,7 @@ namespace dae
 		pDeviceContext->IASetInputLayout(m_pEffect->GetInputLayout());
 
 		// 3. Set VertexBuffer
-		constexpr UINT stride{ sizeof(Vertex) };
+		constexpr UINT stride{ sizeof(typename EffectClass::VertexType) };
 		constexpr UINT offset{ 0 };
 		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
 
@@ -115,6 +213,7 @@ namespace dae
 		m_pEffect->GetTechnique()->GetPassByIndex(filterModeIndex)->Apply(0, pDeviceContext);
 		pDeviceContext->DrawIndexed(m_NumIndices, 0, 0);
 	}
+#endif
 }
 
 #endif // !MESH_H
\ No newline at end of file
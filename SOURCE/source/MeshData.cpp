@@ -0,0 +1,212 @@
+#include "pch.h"
+#include "MeshData.h"
+#include "MappedFile.h"
+#include "ObjLoader.h"
+#include "MeshOptimizer.h"
+#include "ResourceCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr uint32_t g_MeshCacheMagic{ 0x434D5244 }; // "DRMC"
+		constexpr uint32_t g_MeshCacheVersion{ 2 };
+		constexpr uint32_t g_FlipAxisAndWindingFlag{ 1 << 0 };
+
+		// followed by the Vertex array at vertexOffset and the uint32_t index array at indexOffset
+		struct MeshCacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexStride; // sizeof(Vertex), guards against layout changes
+			uint32_t flags;
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			uint64_t nrOfVertices;
+			uint64_t nrOfIndices;
+			uint64_t vertexOffset;
+			uint64_t indexOffset;
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+		static_assert(sizeof(MeshCacheHeader) % alignof(Vertex) == 0);
+	}
+
+	MeshData::MeshData(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices)
+		: m_pMappedFile{ nullptr }
+		, m_OwnedVertices{ std::move(vertices) }
+		, m_OwnedIndices{ std::move(indices) }
+		, m_Vertices{ m_OwnedVertices }
+		, m_Indices{ m_OwnedIndices }
+		, m_BoundsMin{ Vector3::Zero }
+		, m_BoundsMax{ Vector3::Zero }
+		, m_ContentHash{ HashContent() }
+	{
+		if (m_OwnedVertices.empty()) return;
+
+		m_BoundsMin = m_OwnedVertices[0].position;
+		m_BoundsMax = m_OwnedVertices[0].position;
+		for (const Vertex& vertex : m_OwnedVertices)
+		{
+			m_BoundsMin = Vector3{ std::min(m_BoundsMin.x, vertex.position.x), std::min(m_BoundsMin.y, vertex.position.y), std::min(m_BoundsMin.z, vertex.position.z) };
+			m_BoundsMax = Vector3{ std::max(m_BoundsMax.x, vertex.position.x), std::max(m_BoundsMax.y, vertex.position.y), std::max(m_BoundsMax.z, vertex.position.z) };
+		}
+	}
+
+	MeshData::MeshData(std::unique_ptr<MappedFile> pMappedFile, std::span<const Vertex> vertices, std::span<const uint32_t> indices, const Vector3& boundsMin, const Vector3& boundsMax)
+		: m_pMappedFile{ std::move(pMappedFile) }
+		, m_Vertices{ vertices }
+		, m_Indices{ indices }
+		, m_BoundsMin{ boundsMin }
+		, m_BoundsMax{ boundsMax }
+		, m_ContentHash{ HashContent() }
+	{
+	}
+
+	MeshData::~MeshData() = default;
+
+	std::span<const Vertex> MeshData::GetVertices() const
+	{
+		return m_Vertices;
+	}
+
+	std::span<const uint32_t> MeshData::GetIndices() const
+	{
+		return m_Indices;
+	}
+
+	const Vector3& MeshData::GetBoundsMin() const
+	{
+		return m_BoundsMin;
+	}
+
+	const Vector3& MeshData::GetBoundsMax() const
+	{
+		return m_BoundsMax;
+	}
+
+	bool MeshData::IsMapped() const
+	{
+		return m_pMappedFile != nullptr;
+	}
+
+	ContentHash MeshData::GetContentHash() const
+	{
+		return m_ContentHash;
+	}
+
+	ContentHash MeshData::HashContent() const
+	{
+		return HashBytes(m_Indices.data(), m_Indices.size_bytes(), HashBytes(m_Vertices.data(), m_Vertices.size_bytes(), ContentHash{}));
+	}
+
+	std::unique_ptr<MeshData> MeshData::LoadFromFile(const std::string& objPath, bool flipAxisAndWinding, uint32_t nrOfThreads)
+	{
+		std::error_code errorCode{};
+		const uint64_t sourceSize{ std::filesystem::file_size(objPath, errorCode) };
+		if (errorCode)
+		{
+			std::cout << "File Not Found: " << objPath << "\n";
+			return nullptr;
+		}
+		const int64_t sourceWriteTime{ static_cast<int64_t>(std::filesystem::last_write_time(objPath, errorCode).time_since_epoch().count()) };
+
+		// 1. Up to date cache: map it, no parsing
+		const std::string cachePath{ objPath + ".meshcache" };
+		std::unique_ptr<MeshData> pMeshData{ LoadCache(cachePath, sourceSize, sourceWriteTime, flipAxisAndWinding) };
+		if (pMeshData)
+		{
+			std::cout << "Loaded " << objPath << " from " << cachePath << ": " << pMeshData->GetIndices().size() / 3 << " triangles\n";
+			return pMeshData;
+		}
+
+		// 2. Import the OBJ and write the cache for the next run
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Utils::ObjLoadStats stats{};
+		if (!Utils::LoadOBJ(objPath, vertices, indices, flipAxisAndWinding, &stats, nrOfThreads)) return nullptr;
+		Utils::PrintStats(objPath, stats);
+
+		// vertex cache + overdraw order and fetch order, before any buffer is created (and cached like that)
+		Utils::OptimizeMesh(vertices, indices);
+
+		pMeshData = std::make_unique<MeshData>(std::move(vertices), std::move(indices));
+		if (!WriteCache(cachePath, *pMeshData, sourceSize, sourceWriteTime, flipAxisAndWinding))
+		{
+			std::cout << "Could not write mesh cache: " << cachePath << "\n";
+		}
+		return pMeshData;
+	}
+
+	std::unique_ptr<MeshData> MeshData::LoadCache(const std::string& cachePath, uint64_t sourceSize, int64_t sourceWriteTime, bool flipAxisAndWinding)
+	{
+		std::unique_ptr<MappedFile> pMappedFile{ std::make_unique<MappedFile>(cachePath) };
+		if (!pMappedFile->IsOpen() || pMappedFile->GetSize() < sizeof(MeshCacheHeader)) return nullptr;
+
+		MeshCacheHeader header{};
+		std::memcpy(&header, pMappedFile->GetData(), sizeof(MeshCacheHeader));
+
+		// Invalidation
+		const uint32_t flags{ flipAxisAndWinding ? g_FlipAxisAndWindingFlag : 0u };
+		if (header.magic != g_MeshCacheMagic || header.version != g_MeshCacheVersion || header.vertexStride != sizeof(Vertex) || header.flags != flags) return nullptr;
+		if (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime) return nullptr;
+
+		const uint64_t vertexBytes{ header.nrOfVertices * sizeof(Vertex) };
+		const uint64_t indexBytes{ header.nrOfIndices * sizeof(uint32_t) };
+		if (header.vertexOffset % alignof(Vertex) != 0 || header.indexOffset % alignof(uint32_t) != 0) return nullptr;
+		if (header.vertexOffset + vertexBytes > pMappedFile->GetSize() || header.indexOffset + indexBytes > pMappedFile->GetSize()) return nullptr;
+
+		const char* pData{ pMappedFile->GetData() };
+		const std::span<const Vertex> vertices{ reinterpret_cast<const Vertex*>(pData + header.vertexOffset), static_cast<size_t>(header.nrOfVertices) };
+		const std::span<const uint32_t> indices{ reinterpret_cast<const uint32_t*>(pData + header.indexOffset), static_cast<size_t>(header.nrOfIndices) };
+		for (const uint32_t index : indices)
+		{
+			if (index >= header.nrOfVertices) return nullptr;
+		}
+
+		const Vector3 boundsMin{ header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] };
+		const Vector3 boundsMax{ header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] };
+		return std::make_unique<MeshData>(std::move(pMappedFile), vertices, indices, boundsMin, boundsMax);
+	}
+
+	bool MeshData::WriteCache(const std::string& cachePath, const MeshData& meshData, uint64_t sourceSize, int64_t sourceWriteTime, bool flipAxisAndWinding)
+	{
+		MeshCacheHeader header{};
+		header.magic = g_MeshCacheMagic;
+		header.version = g_MeshCacheVersion;
+		header.vertexStride = sizeof(Vertex);
+		header.flags = flipAxisAndWinding ? g_FlipAxisAndWindingFlag : 0u;
+		header.sourceSize = sourceSize;
+		header.sourceWriteTime = sourceWriteTime;
+		header.nrOfVertices = meshData.GetVertices().size();
+		header.nrOfIndices = meshData.GetIndices().size();
+		header.vertexOffset = sizeof(MeshCacheHeader);
+		header.indexOffset = header.vertexOffset + header.nrOfVertices * sizeof(Vertex);
+		header.boundsMin[0] = meshData.GetBoundsMin().x;
+		header.boundsMin[1] = meshData.GetBoundsMin().y;
+		header.boundsMin[2] = meshData.GetBoundsMin().z;
+		header.boundsMax[0] = meshData.GetBoundsMax().x;
+		header.boundsMax[1] = meshData.GetBoundsMax().y;
+		header.boundsMax[2] = meshData.GetBoundsMax().z;
+
+		// write to a temporary file first, a crash never leaves a half written cache behind
+		const std::string tempPath{ cachePath + ".tmp" };
+		{
+			std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!file) return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+			file.write(reinterpret_cast<const char*>(meshData.GetVertices().data()), static_cast<std::streamsize>(meshData.GetVertices().size_bytes()));
+			file.write(reinterpret_cast<const char*>(meshData.GetIndices().data()), static_cast<std::streamsize>(meshData.GetIndices().size_bytes()));
+			if (!file) return false;
+		}
+
+		std::error_code errorCode{};
+		std::filesystem::rename(tempPath, cachePath, errorCode);
+		return !errorCode;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include "DataTypes.h"
+#include "ResourceCache.h"
+
+namespace dae
+{
+	class MappedFile;
+
+	// CPU side vertex / index data of a mesh. Either owns its arrays (fresh OBJ import)
+	// or points straight into a memory mapped binary mesh cache (no copies).
+	class MeshData final
+	{
+	public:
+		explicit MeshData(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices);
+		explicit MeshData(std::unique_ptr<MappedFile> pMappedFile, std::span<const Vertex> vertices, std::span<const uint32_t> indices, const Vector3& boundsMin, const Vector3& boundsMax);
+		~MeshData();
+
+		MeshData(const MeshData&) = delete;
+		MeshData(MeshData&&) noexcept = delete;
+		MeshData& operator=(const MeshData&) = delete;
+		MeshData& operator=(MeshData&&) noexcept = delete;
+
+		std::span<const Vertex> GetVertices() const;
+		std::span<const uint32_t> GetIndices() const;
+		const Vector3& GetBoundsMin() const;
+		const Vector3& GetBoundsMax() const;
+		bool IsMapped() const;
+		// HashBytes of the vertices and indices, computed once by the constructor (on the loading thread)
+		ContentHash GetContentHash() const;
+
+		// Loads "<objPath>.meshcache" when it is up to date with the OBJ (size + write time),
+		// otherwise imports the OBJ and (re)writes the cache next to it.
+		// nrOfThreads for the parse and the tangents (0: one per hardware thread), 1 on the asset workers.
+		static std::unique_ptr<MeshData> LoadFromFile(const std::string& objPath, bool flipAxisAndWinding = true, uint32_t nrOfThreads = 0);
+
+	private:
+		std::unique_ptr<MappedFile> m_pMappedFile;
+		std::vector<Vertex> m_OwnedVertices;
+		std::vector<uint32_t> m_OwnedIndices;
+
+		std::span<const Vertex> m_Vertices;
+		std::span<const uint32_t> m_Indices;
+		Vector3 m_BoundsMin;
+		Vector3 m_BoundsMax;
+		ContentHash m_ContentHash;
+
+		ContentHash HashContent() const;
+
+		static std::unique_ptr<MeshData> LoadCache(const std::string& cachePath, uint64_t sourceSize, int64_t sourceWriteTime, bool flipAxisAndWinding);
+		static bool WriteCache(const std::string& cachePath, const MeshData& meshData, uint64_t sourceSize, int64_t sourceWriteTime, bool flipAxisAndWinding);
+	};
+}
+
+#endif // !MESHDATA_H
\ No newline at end of file
@@ -0,0 +1,434 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+#include "VertexFormats.h"
+
+#include <chrono>
+#include <numeric>
+
+namespace dae
+{
+	namespace Utils
+	{
+		namespace
+		{
+			constexpr uint32_t g_InvalidIndex{ UINT32_MAX };
+
+			// FIFO cache simulated with time stamps: a vertex is cached when it was (re)loaded
+			// less than cacheSize loads ago. Returns the number of misses of the triangle.
+			inline uint32_t UpdateCache(const uint32_t* pTriangle, std::vector<uint32_t>& cacheTimeStamps, uint32_t& timeStamp, uint32_t cacheSize)
+			{
+				uint32_t nrOfMisses{};
+				for (int corner{}; corner < 3; ++corner)
+				{
+					uint32_t& vertexTimeStamp{ cacheTimeStamps[pTriangle[corner]] };
+					if (timeStamp - vertexTimeStamp > cacheSize)
+					{
+						vertexTimeStamp = timeStamp++;
+						++nrOfMisses;
+					}
+				}
+				return nrOfMisses;
+			}
+
+			// vertex -> triangles, as one flat array (offsets[v] .. offsets[v + 1])
+			struct TriangleAdjacency
+			{
+				std::vector<uint32_t> offsets;
+				std::vector<uint32_t> triangles;
+			};
+
+			TriangleAdjacency BuildAdjacency(const std::vector<uint32_t>& indices, size_t nrOfVertices)
+			{
+				TriangleAdjacency adjacency{};
+				adjacency.offsets.resize(nrOfVertices + 1);
+				adjacency.triangles.resize(indices.size());
+
+				for (const uint32_t index : indices) ++adjacency.offsets[index + 1];
+				std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+				std::vector<uint32_t> fillCounts(nrOfVertices);
+				for (size_t i{}; i < indices.size(); ++i)
+				{
+					const uint32_t vertex{ indices[i] };
+					adjacency.triangles[adjacency.offsets[vertex] + fillCounts[vertex]++] = static_cast<uint32_t>(i / 3);
+				}
+				return adjacency;
+			}
+
+			Vector3 GetTriangleNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+			{
+				// not normalized, length = 2 x area. Points towards the viewer for front faces
+				// (clockwise on screen, left handed), so outwards on a closed mesh
+				return Vector3::Cross(p1 - p0, p2 - p0);
+			}
+
+			double GetElapsedMs(std::chrono::steady_clock::time_point start)
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+
+			void PrintAnalysis(const char* label, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+			{
+				const VertexCacheStats cacheStats{ AnalyzeVertexCache(indices, vertices.size()) };
+				const OverdrawStats overdrawStats{ AnalyzeOverdraw(vertices, indices) };
+
+				std::cout << "  " << label
+					<< " ACMR: " << cacheStats.ACMR
+					<< ", ATVR: " << cacheStats.ATVR
+					<< ", overdraw: " << overdrawStats.overdraw
+					<< " (" << overdrawStats.nrOfShadedPixels << " shaded / " << overdrawStats.nrOfCoveredPixels << " covered pixels)\n";
+			}
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t nrOfVertices, uint32_t cacheSize)
+		{
+			const size_t nrOfTriangles{ indices.size() / 3 };
+			if (nrOfTriangles == 0) return;
+
+			const TriangleAdjacency adjacency{ BuildAdjacency(indices, nrOfVertices) };
+
+			// triangles not emitted yet, per vertex
+			std::vector<uint32_t> liveTriangles(nrOfVertices);
+			for (uint32_t vertex{}; vertex < nrOfVertices; ++vertex)
+			{
+				liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+			}
+
+			std::vector<uint32_t> cacheTimeStamps(nrOfVertices);
+			std::vector<bool> isEmitted(nrOfTriangles);
+			std::vector<uint32_t> deadEndStack;
+			std::vector<uint32_t> candidates;
+			std::vector<uint32_t> result;
+			result.reserve(indices.size());
+
+			uint32_t timeStamp{ cacheSize + 1 };
+			uint32_t cursor{};
+			uint32_t fanningVertex{};
+
+			// next vertex with live triangles when the candidates are exhausted
+			const auto skipDeadEnd{ [&]() -> uint32_t
+				{
+					while (!deadEndStack.empty())
+					{
+						const uint32_t vertex{ deadEndStack.back() };
+						deadEndStack.pop_back();
+						if (liveTriangles[vertex] > 0) return vertex;
+					}
+					while (cursor < nrOfVertices)
+					{
+						if (liveTriangles[cursor] > 0) return cursor;
+						++cursor;
+					}
+					return g_InvalidIndex;
+				} };
+
+			while (fanningVertex != g_InvalidIndex)
+			{
+				// 1. Emit all remaining triangles around the fanning vertex
+				candidates.clear();
+				for (uint32_t i{ adjacency.offsets[fanningVertex] }; i < adjacency.offsets[fanningVertex + 1]; ++i)
+				{
+					const uint32_t triangle{ adjacency.triangles[i] };
+					if (isEmitted[triangle]) continue;
+
+					for (int corner{}; corner < 3; ++corner)
+					{
+						const uint32_t vertex{ indices[triangle * 3 + corner] };
+						result.push_back(vertex);
+						deadEndStack.push_back(vertex);
+						candidates.push_back(vertex);
+						--liveTriangles[vertex];
+
+						if (timeStamp - cacheTimeStamps[vertex] > cacheSize)
+						{
+							cacheTimeStamps[vertex] = timeStamp++;
+						}
+					}
+					isEmitted[triangle] = true;
+				}
+
+				// 2. Next fanning vertex: the candidate that stays in the cache longest while
+				// its remaining triangles are emitted, otherwise the most recent dead end
+				uint32_t nextVertex{ g_InvalidIndex };
+				uint32_t bestPriority{};
+				for (const uint32_t vertex : candidates)
+				{
+					if (liveTriangles[vertex] == 0) continue;
+
+					uint32_t priority{};
+					if (timeStamp - cacheTimeStamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+					{
+						priority = timeStamp - cacheTimeStamps[vertex];
+					}
+					if (priority > bestPriority || nextVertex == g_InvalidIndex)
+					{
+						bestPriority = priority;
+						nextVertex = vertex;
+					}
+				}
+
+				fanningVertex = nextVertex != g_InvalidIndex ? nextVertex : skipDeadEnd();
+			}
+
+			indices = std::move(result);
+		}
+
+		void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold, uint32_t cacheSize)
+		{
+			const size_t nrOfTriangles{ indices.size() / 3 };
+			if (nrOfTriangles == 0) return;
+
+			std::vector<uint32_t> cacheTimeStamps(vertices.size());
+			uint32_t timeStamp{ cacheSize + 1 };
+
+			// 1. Hard boundaries: triangles that miss the cache with all 3 vertices (the optimizer jumped)
+			std::vector<uint32_t> hardClusters;
+			for (size_t triangle{}; triangle < nrOfTriangles; ++triangle)
+			{
+				const uint32_t nrOfMisses{ UpdateCache(&indices[triangle * 3], cacheTimeStamps, timeStamp, cacheSize) };
+				if (triangle == 0 || nrOfMisses == 3) hardClusters.push_back(static_cast<uint32_t>(triangle));
+			}
+			hardClusters.push_back(static_cast<uint32_t>(nrOfTriangles));
+
+			// 2. Soft boundaries: split a cluster as soon as its prefix is within threshold x its ACMR
+			std::vector<uint32_t> clusters;
+			for (size_t hardCluster{}; hardCluster + 1 < hardClusters.size(); ++hardCluster)
+			{
+				const uint32_t begin{ hardClusters[hardCluster] };
+				const uint32_t end{ hardClusters[hardCluster + 1] };
+
+				timeStamp += cacheSize + 1;
+				uint32_t nrOfClusterMisses{};
+				for (uint32_t triangle{ begin }; triangle < end; ++triangle)
+				{
+					nrOfClusterMisses += UpdateCache(&indices[triangle * 3], cacheTimeStamps, timeStamp, cacheSize);
+				}
+				const float maxACMR{ threshold * nrOfClusterMisses / (end - begin) };
+
+				timeStamp += cacheSize + 1;
+				clusters.push_back(begin);
+				uint32_t nrOfMisses{};
+				uint32_t nrOfClusterTriangles{};
+				for (uint32_t triangle{ begin }; triangle < end; ++triangle)
+				{
+					nrOfMisses += UpdateCache(&indices[triangle * 3], cacheTimeStamps, timeStamp, cacheSize);
+					++nrOfClusterTriangles;
+
+					if (triangle + 1 < end && nrOfMisses <= maxACMR * nrOfClusterTriangles)
+					{
+						clusters.push_back(triangle + 1);
+						timeStamp += cacheSize + 1;
+						nrOfMisses = 0;
+						nrOfClusterTriangles = 0;
+					}
+				}
+			}
+			clusters.push_back(static_cast<uint32_t>(nrOfTriangles));
+
+			// 3. Sort key: how much a cluster faces away from the mesh center
+			Vector3 meshCentroid{};
+			for (const uint32_t index : indices) meshCentroid += vertices[index].position;
+			meshCentroid /= static_cast<float>(indices.size());
+
+			const size_t nrOfClusters{ clusters.size() - 1 };
+			std::vector<float> sortKeys(nrOfClusters);
+			for (size_t cluster{}; cluster < nrOfClusters; ++cluster)
+			{
+				Vector3 centroid{};
+				Vector3 normal{};
+				float area{};
+				for (uint32_t triangle{ clusters[cluster] }; triangle < clusters[cluster + 1]; ++triangle)
+				{
+					const Vector3& p0{ vertices[indices[triangle * 3]].position };
+					const Vector3& p1{ vertices[indices[triangle * 3 + 1]].position };
+					const Vector3& p2{ vertices[indices[triangle * 3 + 2]].position };
+
+					const Vector3 triangleNormal{ GetTriangleNormal(p0, p1, p2) };
+					const float triangleArea{ triangleNormal.Magnitude() };
+
+					centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+					normal += triangleNormal;
+					area += triangleArea;
+				}
+
+				if (area <= 0.f) continue;
+				centroid /= area;
+				sortKeys[cluster] = Vector3::Dot(centroid - meshCentroid, normal.Normalized());
+			}
+
+			// 4. Outward facing clusters first
+			std::vector<uint32_t> clusterOrder(nrOfClusters);
+			std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+			std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+			std::vector<uint32_t> result;
+			result.reserve(indices.size());
+			for (const uint32_t cluster : clusterOrder)
+			{
+				result.insert(result.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+			}
+			indices = std::move(result);
+		}
+
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			std::vector<uint32_t> remap(vertices.size(), g_InvalidIndex);
+			std::vector<Vertex> result;
+			result.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == g_InvalidIndex)
+				{
+					remap[index] = static_cast<uint32_t>(result.size());
+					result.push_back(vertices[index]);
+				}
+				index = remap[index];
+			}
+			vertices = std::move(result);
+		}
+
+		void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			OptimizeVertexCache(indices, vertices.size());
+			OptimizeOverdraw(indices, vertices);
+			OptimizeVertexFetch(vertices, indices);
+		}
+
+		VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t nrOfVertices, uint32_t cacheSize)
+		{
+			VertexCacheStats stats{};
+			const size_t nrOfTriangles{ indices.size() / 3 };
+			if (nrOfTriangles == 0 || nrOfVertices == 0) return stats;
+
+			std::vector<uint32_t> cacheTimeStamps(nrOfVertices);
+			uint32_t timeStamp{ cacheSize + 1 };
+			for (size_t triangle{}; triangle < nrOfTriangles; ++triangle)
+			{
+				stats.nrOfTransformedVertices += UpdateCache(&indices[triangle * 3], cacheTimeStamps, timeStamp, cacheSize);
+			}
+
+			stats.ACMR = static_cast<float>(stats.nrOfTransformedVertices) / nrOfTriangles;
+			stats.ATVR = static_cast<float>(stats.nrOfTransformedVertices) / nrOfVertices;
+			return stats;
+		}
+
+		OverdrawStats AnalyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool cullBackFaces, int resolution)
+		{
+			OverdrawStats stats{};
+			if (vertices.empty() || indices.size() < 3) return stats;
+
+			Vector3 boundsMin{ vertices[0].position };
+			Vector3 boundsMax{ vertices[0].position };
+			for (const Vertex& vertex : vertices)
+			{
+				boundsMin = Vector3{ std::min(boundsMin.x, vertex.position.x), std::min(boundsMin.y, vertex.position.y), std::min(boundsMin.z, vertex.position.z) };
+				boundsMax = Vector3{ std::max(boundsMax.x, vertex.position.x), std::max(boundsMax.y, vertex.position.y), std::max(boundsMax.z, vertex.position.z) };
+			}
+			const float extent{ std::max(std::max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y), std::max(boundsMax.z - boundsMin.z, FLT_EPSILON)) };
+			const float scale{ (resolution - 1) / extent };
+
+			std::vector<float> depthBuffer(static_cast<size_t>(resolution) * resolution);
+
+			// look along +X, -X, +Y, -Y, +Z, -Z
+			for (int view{}; view < 6; ++view)
+			{
+				const int axis{ view / 2 };
+				const float sign{ view % 2 == 0 ? 1.f : -1.f };
+				Vector3 viewDirection{};
+				viewDirection[axis] = sign;
+
+				std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+
+				for (size_t i{}; i + 2 < indices.size(); i += 3)
+				{
+					const Vector3& p0{ vertices[indices[i]].position };
+					const Vector3& p1{ vertices[indices[i + 1]].position };
+					const Vector3& p2{ vertices[indices[i + 2]].position };
+
+					if (cullBackFaces && Vector3::Dot(GetTriangleNormal(p0, p1, p2), viewDirection) >= 0.f) continue;
+
+					// screen position (other two axes) + depth along the view direction
+					Vector3 screen[3]{};
+					const Vector3* pPositions[3]{ &p0, &p1, &p2 };
+					for (int corner{}; corner < 3; ++corner)
+					{
+						const Vector3 offset{ *pPositions[corner] - boundsMin };
+						screen[corner] = Vector3{ offset[(axis + 1) % 3] * scale, offset[(axis + 2) % 3] * scale, sign * (*pPositions[corner])[axis] };
+					}
+
+					float area{ (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[1].y - screen[0].y) * (screen[2].x - screen[0].x) };
+					if (std::abs(area) <= FLT_EPSILON) continue;
+					if (area < 0.f)
+					{
+						std::swap(screen[1], screen[2]);
+						area = -area;
+					}
+
+					const int minX{ std::max(static_cast<int>(std::min({ screen[0].x, screen[1].x, screen[2].x })), 0) };
+					const int minY{ std::max(static_cast<int>(std::min({ screen[0].y, screen[1].y, screen[2].y })), 0) };
+					const int maxX{ std::min(static_cast<int>(std::max({ screen[0].x, screen[1].x, screen[2].x })) + 1, resolution - 1) };
+					const int maxY{ std::min(static_cast<int>(std::max({ screen[0].y, screen[1].y, screen[2].y })) + 1, resolution - 1) };
+
+					for (int py{ minY }; py <= maxY; ++py)
+					{
+						for (int px{ minX }; px <= maxX; ++px)
+						{
+							const float x{ px + 0.5f };
+							const float y{ py + 0.5f };
+							const float w0{ (screen[2].x - screen[1].x) * (y - screen[1].y) - (screen[2].y - screen[1].y) * (x - screen[1].x) };
+							const float w1{ (screen[0].x - screen[2].x) * (y - screen[2].y) - (screen[0].y - screen[2].y) * (x - screen[2].x) };
+							const float w2{ (screen[1].x - screen[0].x) * (y - screen[0].y) - (screen[1].y - screen[0].y) * (x - screen[0].x) };
+							if (w0 < 0.f || w1 < 0.f || w2 < 0.f) continue;
+
+							const float depth{ (w0 * screen[0].z + w1 * screen[1].z + w2 * screen[2].z) / area };
+							float& storedDepth{ depthBuffer[static_cast<size_t>(py) * resolution + px] };
+							if (depth < storedDepth)
+							{
+								storedDepth = depth;
+								++stats.nrOfShadedPixels;
+							}
+						}
+					}
+				}
+
+				stats.nrOfCoveredPixels += std::count_if(depthBuffer.begin(), depthBuffer.end(), [](float depth) { return depth != FLT_MAX; });
+			}
+
+			stats.overdraw = stats.nrOfCoveredPixels > 0 ? static_cast<float>(stats.nrOfShadedPixels) / stats.nrOfCoveredPixels : 0.f;
+			return stats;
+		}
+
+		void AnalyzeMesh(const std::string& filename)
+		{
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+			ObjLoadStats loadStats{};
+			if (!LoadOBJ(filename, vertices, indices, true, &loadStats)) return;
+			PrintStats(filename, loadStats);
+
+			std::cout << "Mesh Analysis: " << filename << " (FIFO cache of 16 vertices)\n";
+			PrintAnalysis("File order:     ", vertices, indices);
+
+			auto startTime{ std::chrono::steady_clock::now() };
+			OptimizeVertexCache(indices, vertices.size());
+			const double vertexCacheMs{ GetElapsedMs(startTime) };
+			PrintAnalysis("Vertex cache:   ", vertices, indices);
+
+			startTime = std::chrono::steady_clock::now();
+			OptimizeOverdraw(indices, vertices);
+			const double overdrawMs{ GetElapsedMs(startTime) };
+			PrintAnalysis("+ Overdraw:     ", vertices, indices);
+
+			startTime = std::chrono::steady_clock::now();
+			OptimizeVertexFetch(vertices, indices);
+			const double vertexFetchMs{ GetElapsedMs(startTime) };
+
+			std::cout << "  Optimize time: " << vertexCacheMs << " ms vertex cache, " << overdrawMs << " ms overdraw, " << vertexFetchMs << " ms vertex fetch\n";
+
+			std::cout << "Vertex Quantization: " << filename << "\n";
+			PrintQuantizationError(MeasureQuantizationError(vertices));
+		}
+	}
+}
\ No newline at end of file
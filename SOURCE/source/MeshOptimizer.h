@@ -0,0 +1,49 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace Utils
+	{
+		struct VertexCacheStats
+		{
+			size_t nrOfTransformedVertices{}; // FIFO cache misses
+			float ACMR{}; // average cache miss ratio: transformed vertices per triangle (0.5 .. 3)
+			float ATVR{}; // average transformed vertex ratio: transformed vertices per vertex (1 is optimal)
+		};
+
+		struct OverdrawStats
+		{
+			size_t nrOfCoveredPixels{};
+			size_t nrOfShadedPixels{};
+			float overdraw{}; // shaded / covered pixels (1 is optimal)
+		};
+
+		// Tipsify (Sander et al. 2007): reorders triangles so consecutive triangles share vertices
+		// that are still in a post-transform FIFO cache of cacheSize entries
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t nrOfVertices, uint32_t cacheSize = 16);
+
+		// Splits the (cache optimized) triangle order into clusters that cost at most threshold x the
+		// cache efficiency and draws the clusters facing outwards first, so fewer pixels get shaded twice
+		void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f, uint32_t cacheSize = 16);
+
+		// Renumbers vertices in the order the index buffer first uses them (unused ones are removed)
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		// All of the above, in that order
+		void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		// Offline analysis: FIFO cache simulation and an overdraw estimate from 6 axis aligned
+		// orthographic views (depth test less, triangles in index buffer order)
+		VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t nrOfVertices, uint32_t cacheSize = 16);
+		OverdrawStats AnalyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool cullBackFaces = true, int resolution = 256);
+
+		// Loads the OBJ and prints the statistics of the file order vs the optimized order,
+		// plus the error of the compact (quantized) vertex formats
+		void AnalyzeMesh(const std::string& filename);
+	}
+}
+
+#endif // !MESHOPTIMIZER_H
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "pch.h"
+#include "MipGenerator.h"
+#include "TileScheduler.h"
+#include "VectorN.h"
+
+#include <cfloat>
+#include <chrono>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr int g_MaxTaps{ 8 };
+		constexpr int g_RowsPerTask{ 8 };
+		constexpr int g_NrOfChannels{ 4 };
+		constexpr int g_NrOfLinearSteps{ 4096 }; // linear -> sRGB table
+
+		// 2:1 downsampling filter, output texel i reads input texels 2 * i + firstTap ... (wrapped)
+		struct MipKernel
+		{
+			int firstTap;
+			int nrOfTaps;
+			float weights[g_MaxTaps];
+		};
+
+		// modified Bessel function of the first kind, order 0 (Kaiser window)
+		float BesselI0(float x)
+		{
+			float sum{ 1.f };
+			float term{ 1.f };
+			for (int k{ 1 }; k < 32; ++k)
+			{
+				const float factor{ x / (2.f * k) };
+				term *= factor * factor;
+				sum += term;
+			}
+			return sum;
+		}
+
+		MipKernel CreateKernel(MipFilter filter)
+		{
+			if (filter != MipFilter::Kaiser) return MipKernel{ 0, 2, { 0.5f, 0.5f } };
+
+			// sinc at half the input rate, Kaiser window (beta 4) over 4 input texels on each side of the center
+			constexpr float radius{ 4.f };
+			constexpr float beta{ 4.f };
+			MipKernel kernel{ -3, g_MaxTaps, {} };
+			float sum{};
+			for (int tap{}; tap < kernel.nrOfTaps; ++tap)
+			{
+				const float distance{ kernel.firstTap + tap - 0.5f };
+				const float x{ static_cast<float>(M_PI) * distance * 0.5f };
+				const float window{ BesselI0(beta * std::sqrt(1.f - (distance / radius) * (distance / radius))) / BesselI0(beta) };
+				kernel.weights[tap] = std::sin(x) / x * window;
+				sum += kernel.weights[tap];
+			}
+			for (float& weight : kernel.weights) weight /= sum;
+			return kernel;
+		}
+
+		inline int Wrap(int idx, int size)
+		{
+			idx %= size;
+			return idx < 0 ? idx + size : idx;
+		}
+
+		inline float ToLinear(float srgb)
+		{
+			return srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+		}
+
+		inline float ToSRGB(float linear)
+		{
+			return linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f;
+		}
+
+		inline uint32_t ToByte(float value)
+		{
+			return static_cast<uint32_t>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+		}
+
+		// conversions between the stored bytes and the float texels the levels are filtered in
+		class TexelCodec final
+		{
+		public:
+			explicit TexelCodec(MipContent content)
+				: m_Content{ content }
+				, m_ColorScale{ content == MipContent::NormalMap ? 0.5f : 1.f }
+				, m_ColorBias{ content == MipContent::NormalMap ? 0.5f : 0.f }
+			{
+				for (int idx{}; idx < 256; ++idx)
+				{
+					const float value{ idx / 255.f };
+					m_ToFloat[0][idx] = content == MipContent::SRGBColor ? ToLinear(value) : (value - m_ColorBias) / m_ColorScale;
+					m_ToFloat[1][idx] = value;
+				}
+				for (int idx{}; idx < g_NrOfLinearSteps; ++idx) m_ToSRGB[idx] = static_cast<uint8_t>(ToByte(ToSRGB(idx / (g_NrOfLinearSteps - 1.f))));
+			}
+
+			void Decode(uint32_t texel, float* pTexel) const
+			{
+				pTexel[0] = m_ToFloat[0][texel & 0xFF];
+				pTexel[1] = m_ToFloat[0][(texel >> 8) & 0xFF];
+				pTexel[2] = m_ToFloat[0][(texel >> 16) & 0xFF];
+				pTexel[3] = m_ToFloat[1][texel >> 24];
+			}
+
+			uint32_t Encode(const float* pTexel) const
+			{
+				uint32_t texel{ ToByte(pTexel[3]) << 24 };
+				for (int channel{}; channel < 3; ++channel)
+				{
+					const uint32_t byte{ m_Content == MipContent::SRGBColor
+						? m_ToSRGB[static_cast<int>(std::clamp(pTexel[channel], 0.f, 1.f) * (g_NrOfLinearSteps - 1) + 0.5f)]
+						: ToByte(pTexel[channel] * m_ColorScale + m_ColorBias) };
+					texel |= byte << (channel * 8);
+				}
+				return texel;
+			}
+
+			// filtered normals are shorter than 1, the next level is filtered from the renormalized ones
+			void Renormalize(float* pTexel) const
+			{
+				if (m_Content != MipContent::NormalMap) return;
+
+				const float length{ std::sqrt(pTexel[0] * pTexel[0] + pTexel[1] * pTexel[1] + pTexel[2] * pTexel[2]) };
+				if (length < 1e-6f)
+				{
+					pTexel[0] = 0.f;
+					pTexel[1] = 0.f;
+					pTexel[2] = 1.f;
+					return;
+				}
+				for (int channel{}; channel < 3; ++channel) pTexel[channel] /= length;
+			}
+
+		private:
+			const MipContent m_Content;
+			const float m_ColorScale;
+			const float m_ColorBias;
+			float m_ToFloat[2][256]; // rgb, alpha
+			uint8_t m_ToSRGB[g_NrOfLinearSteps];
+		};
+
+		// per worker row of source width
+		struct FilterScratch
+		{
+			std::vector<float> column;
+		};
+
+		// the float texels a level is filtered from
+		struct SourceLevel
+		{
+			const float* pTexels;
+			int width;
+			int height;
+		};
+
+		// stored rows [firstRow, endRow) to the float texels the levels are filtered in
+		void DecodeRows(const TexelCodec& codec, const uint32_t* pTexels, float* pTarget, int width, int firstRow, int endRow)
+		{
+			for (size_t idx{ static_cast<size_t>(firstRow) * width }; idx < static_cast<size_t>(endRow) * width; ++idx)
+			{
+				float* pTexel{ pTarget + idx * g_NrOfChannels };
+				codec.Decode(pTexels[idx], pTexel);
+				codec.Renormalize(pTexel);
+			}
+		}
+
+		// output rows [firstRow, endRow) of the level below source
+		// sourceColumns: wrapped float offset of every horizontal tap, nrOfTaps per output column
+		void FilterRows(const MipKernel& kernel, const TexelCodec& codec, const SourceLevel& source, const int* pSourceColumns,
+			float* pTarget, uint32_t* pTargetTexels, int targetWidth, int firstRow, int endRow, FilterScratch& scratch)
+		{
+			const int rowSize{ source.width * g_NrOfChannels };
+			std::vector<float>& column{ scratch.column };
+			column.resize(rowSize);
+
+			for (int row{ firstRow }; row < endRow; ++row)
+			{
+				// vertical: weighted sum of whole source rows, 8 floats (2 texels) at a time
+				std::fill(column.begin(), column.end(), 0.f);
+				for (int tap{}; tap < kernel.nrOfTaps; ++tap)
+				{
+					const size_t sourceRow{ static_cast<size_t>(Wrap(2 * row + kernel.firstTap + tap, source.height)) };
+					const float* pSourceRow{ source.pTexels + sourceRow * rowSize };
+					const Float8 weight{ Float8::Broadcast(kernel.weights[tap]) };
+					int idx{};
+					for (; idx + Float8::NrOfLanes <= rowSize; idx += Float8::NrOfLanes)
+					{
+						MultiplyAdd(weight, Float8::Load(pSourceRow + idx), Float8::Load(column.data() + idx)).Store(column.data() + idx);
+					}
+					for (; idx < rowSize; ++idx) column[idx] += kernel.weights[tap] * pSourceRow[idx];
+				}
+
+				// horizontal: one RGBA texel per Float4
+				float* pTargetRow{ pTarget + static_cast<size_t>(row) * targetWidth * g_NrOfChannels };
+				uint32_t* pTargetTexelRow{ pTargetTexels + static_cast<size_t>(row) * targetWidth };
+				for (int x{}; x < targetWidth; ++x)
+				{
+					const int* pColumns{ pSourceColumns + x * kernel.nrOfTaps };
+					Float4 texel{ Float4::Broadcast(0.f) };
+					for (int tap{}; tap < kernel.nrOfTaps; ++tap)
+					{
+						texel = MultiplyAdd(Float4::Broadcast(kernel.weights[tap]), Float4::Load(column.data() + pColumns[tap]), texel);
+					}
+
+					float* pTexel{ pTargetRow + x * g_NrOfChannels };
+					texel.Store(pTexel);
+					codec.Renormalize(pTexel);
+					pTargetTexelRow[x] = codec.Encode(pTexel);
+				}
+			}
+		}
+	}
+
+	void GenerateMips(std::vector<uint32_t>& texels, std::vector<TextureLevel>& levels, const MipSettings& settings, uint32_t nrOfThreads)
+	{
+		if (levels.empty() || settings.filter == MipFilter::None) return;
+		levels.resize(1);
+
+		// level sizes up front, so the texel array grows once
+		size_t nrOfTexels{ static_cast<size_t>(levels[0].width) * levels[0].height };
+		while (levels.back().width > 1 || levels.back().height > 1)
+		{
+			const TextureLevel& above{ levels.back() };
+			const TextureLevel level{ static_cast<uint32_t>(nrOfTexels), std::max(above.width / 2, 1), std::max(above.height / 2, 1) };
+			nrOfTexels += static_cast<size_t>(level.width) * level.height;
+			levels.push_back(level);
+		}
+		texels.resize(nrOfTexels);
+
+		const MipKernel kernel{ CreateKernel(settings.filter) };
+		const TexelCodec codec{ settings.content };
+		TileScheduler scheduler{ nrOfThreads };
+		std::vector<FilterScratch> scratches(scheduler.GetNrOfThreads());
+
+		const auto getNrOfTasks = [](int height) { return static_cast<uint32_t>((height + g_RowsPerTask - 1) / g_RowsPerTask); };
+
+		// the top level is decoded once, every vertical tap of every level reads floats
+		std::vector<float> source(static_cast<size_t>(levels[0].width) * levels[0].height * g_NrOfChannels);
+		std::vector<float> target;
+		std::vector<int> sourceColumns;
+		scheduler.Run(getNrOfTasks(levels[0].height), [&](uint32_t taskIdx, uint32_t)
+			{
+				const int firstRow{ static_cast<int>(taskIdx) * g_RowsPerTask };
+				DecodeRows(codec, texels.data(), source.data(), levels[0].width, firstRow, std::min(firstRow + g_RowsPerTask, levels[0].height));
+			});
+
+		for (size_t levelIdx{ 1 }; levelIdx < levels.size(); ++levelIdx)
+		{
+			const TextureLevel& sourceLevel{ levels[levelIdx - 1] };
+			const TextureLevel& targetLevel{ levels[levelIdx] };
+			target.resize(static_cast<size_t>(targetLevel.width) * targetLevel.height * g_NrOfChannels);
+			sourceColumns.resize(static_cast<size_t>(targetLevel.width) * kernel.nrOfTaps);
+			for (int x{}; x < targetLevel.width; ++x)
+			{
+				for (int tap{}; tap < kernel.nrOfTaps; ++tap)
+				{
+					sourceColumns[x * kernel.nrOfTaps + tap] = Wrap(2 * x + kernel.firstTap + tap, sourceLevel.width) * g_NrOfChannels;
+				}
+			}
+
+			scheduler.Run(getNrOfTasks(targetLevel.height), [&](uint32_t taskIdx, uint32_t workerIdx)
+				{
+					const int firstRow{ static_cast<int>(taskIdx) * g_RowsPerTask };
+					const int endRow{ std::min(firstRow + g_RowsPerTask, targetLevel.height) };
+					const SourceLevel sourceTexels{ source.data(), sourceLevel.width, sourceLevel.height };
+					FilterRows(kernel, codec, sourceTexels, sourceColumns.data(), target.data(), texels.data() + targetLevel.offset,
+						targetLevel.width, firstRow, endRow, scratches[workerIdx]);
+				});
+			std::swap(source, target);
+		}
+	}
+
+	namespace Utils
+	{
+		bool BenchmarkMipGeneration(const std::string& path, int nrOfRuns)
+		{
+			const std::unique_ptr<Texture> pTexture{ Texture::LoadFromFile(nullptr, path, MipSettings{ MipFilter::None }) };
+			if (!pTexture) return false;
+
+			const TextureLevel topLevel{ pTexture->GetLevels()[0] };
+			const std::vector<uint32_t> topTexels(pTexture->GetTexels(), pTexture->GetTexels() + static_cast<size_t>(topLevel.width) * topLevel.height);
+			std::cout << "Mip Generation Benchmark: " << path << " (" << topLevel.width << "x" << topLevel.height << ")\n";
+
+			bool isValid{ true };
+			const char* filterNames[2]{ "Box", "Kaiser" };
+			const char* contentNames[3]{ "color", "sRGB color", "normal map" };
+			for (int filter{ static_cast<int>(MipFilter::Box) }; filter <= static_cast<int>(MipFilter::Kaiser); ++filter)
+			{
+				for (int content{}; content < 3; ++content)
+				{
+					const MipSettings settings{ static_cast<MipFilter>(filter), static_cast<MipContent>(content) };
+
+					// single threaded vs every hardware thread, both have to produce the same texels
+					double bestMs[2]{ DBL_MAX, DBL_MAX };
+					std::vector<uint32_t> results[2];
+					for (int threading{}; threading < 2; ++threading)
+					{
+						for (int run{}; run < nrOfRuns; ++run)
+						{
+							std::vector<uint32_t> texels{ topTexels };
+							std::vector<TextureLevel> levels{ topLevel };
+							const auto startTime{ std::chrono::steady_clock::now() };
+							GenerateMips(texels, levels, settings, threading == 0 ? 1 : 0);
+							bestMs[threading] = std::min(bestMs[threading], std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+							results[threading] = std::move(texels);
+						}
+					}
+					const bool isSame{ results[0] == results[1] };
+					if (!isSame) isValid = false;
+
+					const double nrOfMegaTexels{ (results[0].size() - topTexels.size()) / 1e6 };
+					std::cout << "  " << filterNames[filter - 1] << ", " << contentNames[content] << ": 1 thread " << bestMs[0] << " ms ("
+						<< nrOfMegaTexels / (bestMs[0] / 1000.0) << " M texels/s), all threads " << bestMs[1] << " ms ("
+						<< bestMs[0] / bestMs[1] << "x)" << (isSame ? "" : ", DIFFERENT RESULT") << "\n";
+				}
+			}
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
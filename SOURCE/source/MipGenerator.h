@@ -0,0 +1,23 @@
+#ifndef MIPGENERATOR_H
+#define MIPGENERATOR_H
+
+#include "Texture.h"
+
+namespace dae
+{
+	// Appends every level below levels[0] (R8G8B8A8, rows tightly packed) down to 1x1, each half the size
+	// of the one above and filtered from it in float, with wrap addressing like the .fx SamplerStates.
+	// MipContent::SRGBColor is filtered in linear light, MipContent::NormalMap renormalized per level.
+	// Separable: the vertical pass runs over whole rows with Float8, the horizontal one with a Float4 per
+	// texel. Row bands are spread over nrOfThreads (0: one per hardware thread), the result does not
+	// depend on the thread count.
+	void GenerateMips(std::vector<uint32_t>& texels, std::vector<TextureLevel>& levels, const MipSettings& settings, uint32_t nrOfThreads = 0);
+
+	namespace Utils
+	{
+		// Box vs Kaiser mip chain of a texture file, single threaded vs all threads
+		bool BenchmarkMipGeneration(const std::string& path, int nrOfRuns = 5);
+	}
+}
+
+#endif // !MIPGENERATOR_H
\ No newline at end of file
@@ -0,0 +1,669 @@
+#include "pch.h"
+#include "ObjLoader.h"
+#include "FileReader.h"
+#include "Utils.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace dae
+{
+	namespace Utils
+	{
+		namespace
+		{
+			struct ObjCounts
+			{
+				size_t positions{};
+				size_t uvs{};
+				size_t normals{};
+				size_t corners{};
+				size_t triangles{};
+			};
+
+			enum class ObjRecord
+			{
+				Unknown,
+				Position,
+				UV,
+				Normal,
+				Face,
+			};
+
+			inline bool IsSpace(char c)
+			{
+				return c == ' ' || c == '\t' || c == '\r';
+			}
+
+			inline const char* SkipSpaces(const char* pCurrent, const char* pEnd)
+			{
+				while (pCurrent < pEnd && IsSpace(*pCurrent)) ++pCurrent;
+				return pCurrent;
+			}
+
+			inline const char* FindLineEnd(const char* pCurrent, const char* pEnd)
+			{
+				const void* pNewLine{ memchr(pCurrent, '\n', static_cast<size_t>(pEnd - pCurrent)) };
+				return pNewLine ? static_cast<const char*>(pNewLine) : pEnd;
+			}
+
+			// classifies the line and moves pCurrent past the keyword
+			inline ObjRecord ReadRecord(const char*& pCurrent, const char* pLineEnd)
+			{
+				pCurrent = SkipSpaces(pCurrent, pLineEnd);
+				if (pLineEnd - pCurrent < 2) return ObjRecord::Unknown;
+
+				if (pCurrent[0] == 'v')
+				{
+					if (IsSpace(pCurrent[1])) { pCurrent += 1; return ObjRecord::Position; }
+					if (pLineEnd - pCurrent > 2 && IsSpace(pCurrent[2]))
+					{
+						if (pCurrent[1] == 't') { pCurrent += 2; return ObjRecord::UV; }
+						if (pCurrent[1] == 'n') { pCurrent += 2; return ObjRecord::Normal; }
+					}
+				}
+				else if (pCurrent[0] == 'f' && IsSpace(pCurrent[1]))
+				{
+					pCurrent += 1;
+					return ObjRecord::Face;
+				}
+				return ObjRecord::Unknown;
+			}
+
+			inline const char* ParseFloat(const char* pCurrent, const char* pLineEnd, float& value)
+			{
+				pCurrent = SkipSpaces(pCurrent, pLineEnd);
+				if (pCurrent < pLineEnd && *pCurrent == '+') ++pCurrent;
+
+				const std::from_chars_result result{ std::from_chars(pCurrent, pLineEnd, value) };
+				if (result.ec != std::errc{}) value = 0.f;
+				return result.ptr;
+			}
+
+			inline const char* ParseIndex(const char* pCurrent, const char* pLineEnd, int64_t& value)
+			{
+				bool isNegative{ false };
+				if (pCurrent < pLineEnd && *pCurrent == '-')
+				{
+					isNegative = true;
+					++pCurrent;
+				}
+
+				value = 0;
+				while (pCurrent < pLineEnd && *pCurrent >= '0' && *pCurrent <= '9')
+				{
+					value = value * 10 + (*pCurrent - '0');
+					++pCurrent;
+				}
+				if (isNegative) value = -value;
+				return pCurrent;
+			}
+
+			// OBJ indices are 1-based, negative ones are relative to the current end of the list
+			inline bool ResolveIndex(int64_t objIndex, size_t count, uint32_t& index)
+			{
+				const int64_t resolved{ objIndex > 0 ? objIndex - 1 : static_cast<int64_t>(count) + objIndex };
+				if (objIndex == 0 || resolved < 0 || resolved >= static_cast<int64_t>(count)) return false;
+
+				index = static_cast<uint32_t>(resolved);
+				return true;
+			}
+
+			inline size_t CountCorners(const char* pCurrent, const char* pLineEnd)
+			{
+				size_t nrOfCorners{};
+				while (true)
+				{
+					pCurrent = SkipSpaces(pCurrent, pLineEnd);
+					if (pCurrent >= pLineEnd || *pCurrent == '#') break;
+
+					++nrOfCorners;
+					while (pCurrent < pLineEnd && !IsSpace(*pCurrent)) ++pCurrent;
+				}
+				return nrOfCorners;
+			}
+
+			ObjCounts CountRecords(const char* pBegin, const char* pEnd)
+			{
+				ObjCounts counts{};
+				for (const char* pLine{ pBegin }; pLine < pEnd;)
+				{
+					const char* pLineEnd{ FindLineEnd(pLine, pEnd) };
+					const char* pCurrent{ pLine };
+
+					switch (ReadRecord(pCurrent, pLineEnd))
+					{
+					case ObjRecord::Position:
+						++counts.positions;
+						break;
+					case ObjRecord::UV:
+						++counts.uvs;
+						break;
+					case ObjRecord::Normal:
+						++counts.normals;
+						break;
+					case ObjRecord::Face:
+					{
+						const size_t nrOfCorners{ CountCorners(pCurrent, pLineEnd) };
+						if (nrOfCorners >= 3)
+						{
+							counts.corners += nrOfCorners;
+							counts.triangles += nrOfCorners - 2;
+						}
+						break;
+					}
+					default:
+						break;
+					}
+
+					pLine = pLineEnd + 1;
+				}
+				return counts;
+			}
+
+			// Open addressing (linear probing) map from a v/vt/vn triplet to its unique vertex.
+			// Sized for the worst case up front, so inserting never rehashes or allocates.
+			class VertexHashMap final
+			{
+			public:
+				static constexpr uint32_t InvalidIndex{ UINT32_MAX };
+
+				explicit VertexHashMap(size_t maxNrOfEntries)
+				{
+					size_t capacity{ 16 };
+					while (capacity < maxNrOfEntries * 2) capacity <<= 1;
+
+					m_Mask = capacity - 1;
+					m_Entries.resize(capacity);
+				}
+
+				// returns the existing vertex index, or stores newVertexIndex and returns InvalidIndex
+				uint32_t FindOrInsert(uint32_t position, uint32_t uv, uint32_t normal, uint32_t newVertexIndex)
+				{
+					size_t slot{ Hash(position, uv, normal) & m_Mask };
+					while (true)
+					{
+						Entry& entry{ m_Entries[slot] };
+						if (entry.vertexIndex == InvalidIndex)
+						{
+							entry = Entry{ position, uv, normal, newVertexIndex };
+							return InvalidIndex;
+						}
+						if (entry.position == position && entry.uv == uv && entry.normal == normal)
+						{
+							return entry.vertexIndex;
+						}
+						slot = (slot + 1) & m_Mask;
+					}
+				}
+
+			private:
+				struct Entry
+				{
+					uint32_t position{ InvalidIndex };
+					uint32_t uv{ InvalidIndex };
+					uint32_t normal{ InvalidIndex };
+					uint32_t vertexIndex{ InvalidIndex };
+				};
+
+				std::vector<Entry> m_Entries;
+				size_t m_Mask;
+
+				static size_t Hash(uint32_t position, uint32_t uv, uint32_t normal)
+				{
+					uint64_t hash{ position * 0x9E3779B97F4A7C15ull };
+					hash ^= (uv + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+					hash ^= (normal + 0x165667B19E3779F9ull) * 0x85EBCA77C2B2AE63ull;
+					return static_cast<size_t>(hash ^ (hash >> 29));
+				}
+			};
+
+			// one newline aligned slice of the file, parsed by one thread
+			struct ObjChunk
+			{
+				const char* pBegin{};
+				const char* pEnd{};
+				ObjCounts counts{};
+				ObjCounts offsets{}; // exclusive prefix sum of the counts of all previous chunks
+				const char* pError{};
+			};
+
+			// the v/vt/vn triplet of one face corner (0-based, InvalidIndex when absent)
+			struct ObjCorner
+			{
+				uint32_t position;
+				uint32_t uv;
+				uint32_t normal;
+			};
+
+			constexpr size_t g_MinChunkSize{ 1024 * 1024 };
+
+			size_t GetNrOfThreads(size_t fileSize, uint32_t maxNrOfThreads)
+			{
+				size_t nrOfThreads{ maxNrOfThreads ? maxNrOfThreads : std::max(std::thread::hardware_concurrency(), 1u) };
+				nrOfThreads = std::min(nrOfThreads, std::max(fileSize / g_MinChunkSize, size_t{ 1 }));
+				return nrOfThreads;
+			}
+
+			// runs function(0 .. nrOfTasks - 1), one thread per task, task 0 on the calling thread
+			template<typename Function>
+			void ParallelFor(size_t nrOfTasks, const Function& function)
+			{
+				std::vector<std::thread> threads;
+				threads.reserve(nrOfTasks > 0 ? nrOfTasks - 1 : 0);
+				for (size_t task{ 1 }; task < nrOfTasks; ++task)
+				{
+					threads.emplace_back(function, task);
+				}
+				if (nrOfTasks > 0) function(size_t{ 0 });
+				for (std::thread& thread : threads) thread.join();
+			}
+
+			std::vector<ObjChunk> SplitIntoChunks(const char* pBegin, const char* pEnd, size_t nrOfChunks)
+			{
+				std::vector<ObjChunk> chunks;
+				chunks.reserve(nrOfChunks);
+
+				const size_t size{ static_cast<size_t>(pEnd - pBegin) };
+				const char* pChunkBegin{ pBegin };
+				for (size_t chunkIndex{ 1 }; chunkIndex <= nrOfChunks && pChunkBegin < pEnd; ++chunkIndex)
+				{
+					// every chunk ends right after a newline, so no line is split
+					const char* pChunkEnd{ pEnd };
+					if (chunkIndex < nrOfChunks)
+					{
+						pChunkEnd = std::max(pBegin + size / nrOfChunks * chunkIndex, pChunkBegin);
+						pChunkEnd = std::min(FindLineEnd(pChunkEnd, pEnd) + 1, pEnd);
+					}
+
+					ObjChunk chunk{};
+					chunk.pBegin = pChunkBegin;
+					chunk.pEnd = pChunkEnd;
+					chunks.push_back(chunk);
+					pChunkBegin = pChunkEnd;
+				}
+				return chunks;
+			}
+
+			// Parses positions, UVs, normals and face corners of one chunk straight into the global
+			// arrays at the chunk offsets. Triangles reference global corner numbers, corners are
+			// turned into (deduplicated) vertices afterwards.
+			void ParseChunk(ObjChunk& chunk, std::vector<Vector3>& positions, std::vector<Vector2>& UVs, std::vector<Vector3>& normals,
+				std::vector<ObjCorner>& corners, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+			{
+				size_t nrOfPositions{ chunk.offsets.positions };
+				size_t nrOfUVs{ chunk.offsets.uvs };
+				size_t nrOfNormals{ chunk.offsets.normals };
+				size_t nrOfCorners{ chunk.offsets.corners };
+				size_t nrOfIndices{ chunk.offsets.triangles * 3 };
+
+				for (const char* pLine{ chunk.pBegin }; pLine < chunk.pEnd;)
+				{
+					const char* pLineEnd{ FindLineEnd(pLine, chunk.pEnd) };
+					const char* pCurrent{ pLine };
+
+					switch (ReadRecord(pCurrent, pLineEnd))
+					{
+					case ObjRecord::Position:
+					{
+						Vector3& position{ positions[nrOfPositions++] };
+						pCurrent = ParseFloat(pCurrent, pLineEnd, position.x);
+						pCurrent = ParseFloat(pCurrent, pLineEnd, position.y);
+						ParseFloat(pCurrent, pLineEnd, position.z);
+						break;
+					}
+					case ObjRecord::UV:
+					{
+						Vector2& uv{ UVs[nrOfUVs++] };
+						pCurrent = ParseFloat(pCurrent, pLineEnd, uv.x);
+						ParseFloat(pCurrent, pLineEnd, uv.y);
+						uv.y = 1.f - uv.y;
+						break;
+					}
+					case ObjRecord::Normal:
+					{
+						Vector3& normal{ normals[nrOfNormals++] };
+						pCurrent = ParseFloat(pCurrent, pLineEnd, normal.x);
+						pCurrent = ParseFloat(pCurrent, pLineEnd, normal.y);
+						ParseFloat(pCurrent, pLineEnd, normal.z);
+						break;
+					}
+					case ObjRecord::Face:
+					{
+						if (CountCorners(pCurrent, pLineEnd) < 3) break;
+
+						uint32_t firstCorner{};
+						uint32_t previousCorner{};
+						uint32_t nrOfFaceCorners{};
+						while (true)
+						{
+							pCurrent = SkipSpaces(pCurrent, pLineEnd);
+							if (pCurrent >= pLineEnd || *pCurrent == '#') break;
+
+							// v, v/vt, v//vn or v/vt/vn
+							// the global counts (chunk offset + own records) make relative indices global too
+							ObjCorner corner{ 0, VertexHashMap::InvalidIndex, VertexHashMap::InvalidIndex };
+
+							int64_t objIndex{};
+							pCurrent = ParseIndex(pCurrent, pLineEnd, objIndex);
+							if (!ResolveIndex(objIndex, nrOfPositions, corner.position))
+							{
+								chunk.pError = "Invalid face index in: ";
+								return;
+							}
+
+							if (pCurrent < pLineEnd && *pCurrent == '/')
+							{
+								++pCurrent;
+								if (pCurrent < pLineEnd && *pCurrent != '/')
+								{
+									// Optional texture coordinate
+									pCurrent = ParseIndex(pCurrent, pLineEnd, objIndex);
+									if (!ResolveIndex(objIndex, nrOfUVs, corner.uv))
+									{
+										chunk.pError = "Invalid texcoord index in: ";
+										return;
+									}
+								}
+
+								if (pCurrent < pLineEnd && *pCurrent == '/')
+								{
+									// Optional vertex normal
+									++pCurrent;
+									pCurrent = ParseIndex(pCurrent, pLineEnd, objIndex);
+									if (!ResolveIndex(objIndex, nrOfNormals, corner.normal))
+									{
+										chunk.pError = "Invalid normal index in: ";
+										return;
+									}
+								}
+							}
+
+							// skip anything else in this corner token
+							while (pCurrent < pLineEnd && !IsSpace(*pCurrent)) ++pCurrent;
+
+							const uint32_t cornerIndex{ static_cast<uint32_t>(nrOfCorners) };
+							corners[nrOfCorners++] = corner;
+
+							// fan triangulation
+							++nrOfFaceCorners;
+							if (nrOfFaceCorners == 1)
+							{
+								firstCorner = cornerIndex;
+							}
+							else if (nrOfFaceCorners >= 3)
+							{
+								indices[nrOfIndices++] = firstCorner;
+								if (flipAxisAndWinding)
+								{
+									indices[nrOfIndices++] = cornerIndex;
+									indices[nrOfIndices++] = previousCorner;
+								}
+								else
+								{
+									indices[nrOfIndices++] = previousCorner;
+									indices[nrOfIndices++] = cornerIndex;
+								}
+							}
+							previousCorner = cornerIndex;
+						}
+						break;
+					}
+					default:
+						break;
+					}
+
+					pLine = pLineEnd + 1;
+				}
+			}
+
+			// unit vector in the tangent plane of the normal, for vertices without a UV gradient
+			Vector3 GetAnyTangent(const Vector3& normal)
+			{
+				const Vector3 tangent{ Vector3::Cross(std::abs(normal.x) < 0.9f ? Vector3::UnitX : Vector3::UnitY, normal) };
+				return tangent.SqrMagnitude() > 0.f ? tangent.Normalized() : Vector3::UnitX;
+			}
+
+			// same tangent + axis flip as ParseOBJ. The tangent of every triangle is computed in parallel, the
+			// sums per vertex are made on one thread in triangle order (as ParseOBJ does), so the result does not
+			// depend on the thread count.
+			void CalculateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool flipAxisAndWinding, size_t nrOfThreads)
+			{
+				const size_t nrOfTriangles{ indices.size() / 3 };
+				nrOfThreads = std::max(std::min(nrOfThreads, nrOfTriangles), size_t{ 1 });
+
+				std::vector<Vector3> triangleTangents(nrOfTriangles);
+
+				//Cheap Tangent Calculations
+				ParallelFor(nrOfThreads, [&](size_t threadIndex)
+					{
+						const size_t firstTriangle{ nrOfTriangles * threadIndex / nrOfThreads };
+						const size_t lastTriangle{ nrOfTriangles * (threadIndex + 1) / nrOfThreads };
+						for (size_t triangleIndex{ firstTriangle }; triangleIndex < lastTriangle; ++triangleIndex)
+						{
+							const size_t i{ triangleIndex * 3 };
+							const uint32_t index0{ indices[i] };
+							const uint32_t index1{ indices[i + 1] };
+							const uint32_t index2{ indices[i + 2] };
+
+							const Vector3& p0{ vertices[index0].position };
+							const Vector3& p1{ vertices[index1].position };
+							const Vector3& p2{ vertices[index2].position };
+							const Vector2& uv0{ vertices[index0].uv };
+							const Vector2& uv1{ vertices[index1].uv };
+							const Vector2& uv2{ vertices[index2].uv };
+
+							const Vector3 edge0{ p1 - p0 };
+							const Vector3 edge1{ p2 - p0 };
+							const Vector2 diffX{ uv1.x - uv0.x, uv2.x - uv0.x };
+							const Vector2 diffY{ uv1.y - uv0.y, uv2.y - uv0.y };
+							const float r{ 1.f / Vector2::Cross(diffX, diffY) };
+
+							// degenerate UVs add nothing (instead of inf / NaN to every vertex of the triangle)
+							triangleTangents[triangleIndex] = std::isfinite(r) ? (edge0 * diffY.y - edge1 * diffY.x) * r : Vector3::Zero;
+						}
+					});
+
+				// fixed summation order per vertex
+				for (size_t triangleIndex{}; triangleIndex < nrOfTriangles; ++triangleIndex)
+				{
+					const Vector3& tangent{ triangleTangents[triangleIndex] };
+					vertices[indices[triangleIndex * 3]].tangent += tangent;
+					vertices[indices[triangleIndex * 3 + 1]].tangent += tangent;
+					vertices[indices[triangleIndex * 3 + 2]].tangent += tangent;
+				}
+
+				//Create the Tangents (reject)
+				ParallelFor(nrOfThreads, [&](size_t threadIndex)
+					{
+						const size_t firstVertex{ vertices.size() * threadIndex / nrOfThreads };
+						const size_t lastVertex{ vertices.size() * (threadIndex + 1) / nrOfThreads };
+						for (size_t vertexIndex{ firstVertex }; vertexIndex < lastVertex; ++vertexIndex)
+						{
+							Vertex& vertex{ vertices[vertexIndex] };
+							// never a zero tangent: it has no octahedral encoding (VertexFormats.h)
+							const Vector3 tangent{ Vector3::Reject(vertex.tangent, vertex.normal) };
+							const float sqrLength{ tangent.SqrMagnitude() };
+							vertex.tangent = sqrLength > 0.f && std::isfinite(sqrLength) ? tangent.Normalized() : GetAnyTangent(vertex.normal);
+
+							if (flipAxisAndWinding)
+							{
+								vertex.position.z *= -1.f;
+								vertex.normal.z *= -1.f;
+								vertex.tangent.z *= -1.f;
+							}
+						}
+					});
+			}
+
+			double GetElapsedMs(std::chrono::steady_clock::time_point start)
+			{
+				return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			}
+		}
+
+		bool LoadOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding, ObjLoadStats* pStats, uint32_t maxNrOfThreads)
+		{
+			const auto startTime{ std::chrono::steady_clock::now() };
+
+			// batched reads (FileReader.h) instead of page faults through a mapping
+			FileData file{};
+			if (!ReadWholeFile(filename, file) || file.size == 0)
+			{
+				std::cout << "File Not Found: " << filename << "\n";
+				return false;
+			}
+
+			const char* pBegin{ file.pData.get() };
+			const char* pEnd{ pBegin + file.size };
+
+			// 1. Split at newline boundaries, one chunk per thread
+			const size_t nrOfThreads{ GetNrOfThreads(file.size, maxNrOfThreads) };
+			std::vector<ObjChunk> chunks{ SplitIntoChunks(pBegin, pEnd, nrOfThreads) };
+
+			// 2. Counting pass per chunk, the prefix sum gives every chunk its place in the global arrays
+			ParallelFor(chunks.size(), [&](size_t chunkIndex)
+				{
+					chunks[chunkIndex].counts = CountRecords(chunks[chunkIndex].pBegin, chunks[chunkIndex].pEnd);
+				});
+
+			ObjCounts counts{};
+			for (ObjChunk& chunk : chunks)
+			{
+				chunk.offsets = counts;
+				counts.positions += chunk.counts.positions;
+				counts.uvs += chunk.counts.uvs;
+				counts.normals += chunk.counts.normals;
+				counts.corners += chunk.counts.corners;
+				counts.triangles += chunk.counts.triangles;
+			}
+
+			std::vector<Vector3> positions(counts.positions);
+			std::vector<Vector2> UVs(counts.uvs);
+			std::vector<Vector3> normals(counts.normals);
+			std::vector<ObjCorner> corners(counts.corners);
+			indices.resize(counts.triangles * 3);
+
+			// 3. Parsing pass per chunk
+			ParallelFor(chunks.size(), [&](size_t chunkIndex)
+				{
+					ParseChunk(chunks[chunkIndex], positions, UVs, normals, corners, indices, flipAxisAndWinding);
+				});
+
+			for (const ObjChunk& chunk : chunks)
+			{
+				if (chunk.pError)
+				{
+					std::cout << chunk.pError << filename << "\n";
+					return false;
+				}
+			}
+
+			// 4. Deduplicate identical v/vt/vn triplets, in file order (same vertex order for any thread count)
+			vertices.resize(counts.corners);
+			VertexHashMap vertexMap{ counts.corners };
+			std::vector<uint32_t> cornerToVertex(counts.corners);
+
+			size_t nrOfVertices{};
+			for (size_t cornerIndex{}; cornerIndex < corners.size(); ++cornerIndex)
+			{
+				const ObjCorner& corner{ corners[cornerIndex] };
+
+				uint32_t vertexIndex{ static_cast<uint32_t>(nrOfVertices) };
+				const uint32_t existingIndex{ vertexMap.FindOrInsert(corner.position, corner.uv, corner.normal, vertexIndex) };
+				if (existingIndex != VertexHashMap::InvalidIndex)
+				{
+					vertexIndex = existingIndex;
+				}
+				else
+				{
+					Vertex& vertex{ vertices[nrOfVertices++] };
+					vertex = Vertex{};
+					vertex.position = positions[corner.position];
+					if (corner.uv != VertexHashMap::InvalidIndex) vertex.uv = UVs[corner.uv];
+					if (corner.normal != VertexHashMap::InvalidIndex) vertex.normal = normals[corner.normal];
+				}
+				cornerToVertex[cornerIndex] = vertexIndex;
+			}
+
+			// only the unique vertices remain (no reallocation, the capacity is kept)
+			vertices.resize(nrOfVertices);
+
+			// triangles referenced corners, now they reference vertices
+			ParallelFor(chunks.size(), [&](size_t chunkIndex)
+				{
+					const size_t firstIndex{ chunks[chunkIndex].offsets.triangles * 3 };
+					const size_t lastIndex{ firstIndex + chunks[chunkIndex].counts.triangles * 3 };
+					for (size_t i{ firstIndex }; i < lastIndex; ++i)
+					{
+						indices[i] = cornerToVertex[indices[i]];
+					}
+				});
+
+			// 5. tangents are accumulated per unique vertex, over all triangles sharing it
+			CalculateTangents(vertices, indices, flipAxisAndWinding, nrOfThreads);
+
+			if (pStats)
+			{
+				pStats->fileSize = file.size;
+				pStats->nrOfPositions = counts.positions;
+				pStats->nrOfUVs = counts.uvs;
+				pStats->nrOfNormals = counts.normals;
+				pStats->nrOfTriangles = counts.triangles;
+				pStats->nrOfCorners = counts.corners;
+				pStats->nrOfVertices = vertices.size();
+				pStats->nrOfIndices = indices.size();
+				pStats->nrOfThreads = chunks.size();
+				pStats->loadTimeMs = GetElapsedMs(startTime);
+			}
+
+			return true;
+		}
+
+		void BenchmarkOBJ(const std::string& filename, int nrOfRuns)
+		{
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+
+			ObjLoadStats stats{};
+			if (!LoadOBJ(filename, vertices, indices, true, &stats)) return;
+
+			const double fileSizeMB{ stats.fileSize / (1024.0 * 1024.0) };
+			std::cout << "OBJ Benchmark: " << filename << " (" << fileSizeMB << " MB, " << nrOfRuns << " runs)\n";
+
+			double bestParseMs{ DBL_MAX };
+			double bestSingleMs{ DBL_MAX };
+			double bestLoadMs{ DBL_MAX };
+			for (int run{}; run < nrOfRuns; ++run)
+			{
+				auto startTime{ std::chrono::steady_clock::now() };
+				ParseOBJ(filename, vertices, indices);
+				bestParseMs = std::min(bestParseMs, GetElapsedMs(startTime));
+
+				startTime = std::chrono::steady_clock::now();
+				LoadOBJ(filename, vertices, indices, true, nullptr, 1);
+				bestSingleMs = std::min(bestSingleMs, GetElapsedMs(startTime));
+
+				startTime = std::chrono::steady_clock::now();
+				LoadOBJ(filename, vertices, indices);
+				bestLoadMs = std::min(bestLoadMs, GetElapsedMs(startTime));
+			}
+
+			std::cout << "  ParseOBJ:             " << bestParseMs << " ms, " << fileSizeMB / (bestParseMs / 1000.0) << " MB/s\n";
+			std::cout << "  LoadOBJ (1 thread):   " << bestSingleMs << " ms, " << fileSizeMB / (bestSingleMs / 1000.0) << " MB/s\n";
+			std::cout << "  LoadOBJ (" << stats.nrOfThreads << " threads): " << bestLoadMs << " ms, " << fileSizeMB / (bestLoadMs / 1000.0) << " MB/s\n";
+			std::cout << "  Speedup:  " << bestParseMs / bestLoadMs << "x vs ParseOBJ, " << bestSingleMs / bestLoadMs << "x vs 1 thread\n";
+		}
+
+		void PrintStats(const std::string& filename, const ObjLoadStats& stats)
+		{
+			std::cout << "Loaded " << filename << ": "
+				<< stats.nrOfTriangles << " triangles, "
+				<< stats.nrOfVertices << " vertices (" << stats.nrOfCorners << " before deduplication), "
+				<< stats.nrOfIndices << " indices in "
+				<< stats.loadTimeMs << " ms on " << stats.nrOfThreads << " thread(s)\n";
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace Utils
+	{
+		struct ObjLoadStats
+		{
+			size_t fileSize{};
+			size_t nrOfPositions{};
+			size_t nrOfUVs{};
+			size_t nrOfNormals{};
+			size_t nrOfTriangles{};
+			size_t nrOfCorners{}; // vertices before deduplication (one per face corner)
+			size_t nrOfVertices{};
+			size_t nrOfIndices{};
+			size_t nrOfThreads{};
+			double loadTimeMs{};
+		};
+
+		// Replacement for ParseOBJ: the whole file is read into memory with a FileReader (large batched
+		// reads, no iostreams) and parsed without reallocations (a counting pass sizes every array up front). Identical v/vt/vn corners share one vertex, polygons are
+		// triangulated as a fan.
+		// Files over 1 MB are split at line boundaries and parsed on up to maxNrOfThreads threads
+		// (0 = one per hardware thread), the result does not depend on the thread count.
+		bool LoadOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true, ObjLoadStats* pStats = nullptr, uint32_t maxNrOfThreads = 0);
+
+		// Prints ParseOBJ vs single / multithreaded LoadOBJ throughput in MB/s
+		void BenchmarkOBJ(const std::string& filename, int nrOfRuns = 5);
+
+		void PrintStats(const std::string& filename, const ObjLoadStats& stats);
+	}
+}
+
+#endif // !OBJLOADER_H
\ No newline at end of file
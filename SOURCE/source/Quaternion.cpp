@@ -0,0 +1,215 @@
+#include "pch.h"
+#include "Quaternion.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "MathHelpers.h"
+#include "VectorN.h"
+
+namespace dae
+{
+	const Quaternion Quaternion::Identity = Quaternion{ 0.f, 0.f, 0.f, 1.f };
+
+	Quaternion::Quaternion(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+
+	float Quaternion::Magnitude() const
+	{
+		return sqrtf(SqrMagnitude());
+	}
+
+	float Quaternion::SqrMagnitude() const
+	{
+		return x * x + y * y + z * z + w * w;
+	}
+
+	float Quaternion::Normalize()
+	{
+		const float m = Magnitude();
+		x /= m;
+		y /= m;
+		z /= m;
+		w /= m;
+
+		return m;
+	}
+
+	Quaternion Quaternion::Normalized() const
+	{
+		const float m = Magnitude();
+		return { x / m, y / m, z / m, w / m };
+	}
+
+	Quaternion Quaternion::Conjugate() const
+	{
+		return { -x, -y, -z, w };
+	}
+
+	Vector3 Quaternion::Rotate(const Vector3& v) const
+	{
+		// v' = v + 2w (u x v) + 2 u x (u x v), u = (x, y, z)
+		const Vector3 u{ x, y, z };
+		const Vector3 t{ Vector3::Cross(u, v) * 2.f };
+		return v + t * w + Vector3::Cross(u, t);
+	}
+
+	Matrix Quaternion::ToMatrix() const
+	{
+		return ToMatrix(Vector3::Zero);
+	}
+
+	Matrix Quaternion::ToMatrix(const Vector3& translation) const
+	{
+		const float xx{ x * x }, yy{ y * y }, zz{ z * z };
+		const float xy{ x * y }, xz{ x * z }, yz{ y * z };
+		const float wx{ w * x }, wy{ w * y }, wz{ w * z };
+
+		// rows are the rotated axes
+		return {
+			{ 1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy), 0.f },
+			{ 2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx), 0.f },
+			{ 2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy), 0.f },
+			{ translation, 1.f }
+		};
+	}
+
+	void Quaternion::ToMatrices(std::span<const Quaternion> rotations, std::span<const Vector3> translations, std::span<Matrix> result)
+	{
+		assert(translations.size() >= rotations.size() && result.size() >= rotations.size());
+
+		static_assert(sizeof(Quaternion) == sizeof(Vector4), "Quaternion is loaded as a Vector4");
+		constexpr int width{ Float8::NrOfLanes };
+		const Float8 one{ Float8::Broadcast(1.f) };
+		const Float8 two{ Float8::Broadcast(2.f) };
+
+		size_t idx{};
+		for (; idx + width <= rotations.size(); idx += width)
+		{
+			const Vector4x8 q{ Vector4x8::Load(reinterpret_cast<const Vector4*>(&rotations[idx]), sizeof(Quaternion)) };
+			const Float8 xx{ q.x * q.x }, yy{ q.y * q.y }, zz{ q.z * q.z };
+			const Float8 xy{ q.x * q.y }, xz{ q.x * q.z }, yz{ q.y * q.z };
+			const Float8 wx{ q.w * q.x }, wy{ q.w * q.y }, wz{ q.w * q.z };
+
+			alignas(32) float elements[9][width];
+			(one - two * (yy + zz)).Store(elements[0]);
+			(two * (xy + wz)).Store(elements[1]);
+			(two * (xz - wy)).Store(elements[2]);
+			(two * (xy - wz)).Store(elements[3]);
+			(one - two * (xx + zz)).Store(elements[4]);
+			(two * (yz + wx)).Store(elements[5]);
+			(two * (xz + wy)).Store(elements[6]);
+			(two * (yz - wx)).Store(elements[7]);
+			(one - two * (xx + yy)).Store(elements[8]);
+
+			for (int lane{}; lane < width; ++lane)
+			{
+				result[idx + lane] = Matrix{
+					Vector4{ elements[0][lane], elements[1][lane], elements[2][lane], 0.f },
+					Vector4{ elements[3][lane], elements[4][lane], elements[5][lane], 0.f },
+					Vector4{ elements[6][lane], elements[7][lane], elements[8][lane], 0.f },
+					Vector4{ translations[idx + lane], 1.f }
+				};
+			}
+		}
+
+		for (; idx < rotations.size(); ++idx)
+		{
+			result[idx] = rotations[idx].ToMatrix(translations[idx]);
+		}
+	}
+
+	float Quaternion::Dot(const Quaternion& q1, const Quaternion& q2)
+	{
+		return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+	}
+
+	Quaternion Quaternion::Slerp(const Quaternion& q1, const Quaternion& q2, float t)
+	{
+		// q and -q are the same rotation, take the short way around
+		float cosAngle{ Dot(q1, q2) };
+		Quaternion end{ q2 };
+		if (cosAngle < 0.f)
+		{
+			cosAngle = -cosAngle;
+			end = { -q2.x, -q2.y, -q2.z, -q2.w };
+		}
+
+		// (almost) the same rotation: sin(angle) -> 0, lerp is accurate enough
+		if (cosAngle > 0.9995f) return Nlerp(q1, end, t);
+
+		const float angle{ acosf(cosAngle) };
+		const float divSinAngle{ 1.f / sinf(angle) };
+		const float weight1{ sinf((1.f - t) * angle) * divSinAngle };
+		const float weight2{ sinf(t * angle) * divSinAngle };
+
+		return {
+			q1.x * weight1 + end.x * weight2,
+			q1.y * weight1 + end.y * weight2,
+			q1.z * weight1 + end.z * weight2,
+			q1.w * weight1 + end.w * weight2
+		};
+	}
+
+	Quaternion Quaternion::Nlerp(const Quaternion& q1, const Quaternion& q2, float t)
+	{
+		const float sign{ Dot(q1, q2) < 0.f ? -1.f : 1.f };
+		return Quaternion{
+			Lerpf(q1.x, q2.x * sign, t),
+			Lerpf(q1.y, q2.y * sign, t),
+			Lerpf(q1.z, q2.z * sign, t),
+			Lerpf(q1.w, q2.w * sign, t)
+		}.Normalized();
+	}
+
+	Quaternion Quaternion::CreateFromAxisAngle(const Vector3& axis, float angle)
+	{
+		const Vector3 normalizedAxis{ axis.Normalized() };
+		const float sinHalfAngle{ sinf(angle * 0.5f) };
+		return { normalizedAxis.x * sinHalfAngle, normalizedAxis.y * sinHalfAngle, normalizedAxis.z * sinHalfAngle, cosf(angle * 0.5f) };
+	}
+
+	Quaternion Quaternion::CreateRotationX(float pitch)
+	{
+		// Matrix::CreateRotationX turns the other way around X than Y and Z do around their axes
+		return { -sinf(pitch * 0.5f), 0.f, 0.f, cosf(pitch * 0.5f) };
+	}
+
+	Quaternion Quaternion::CreateRotationY(float yaw)
+	{
+		return { 0.f, sinf(yaw * 0.5f), 0.f, cosf(yaw * 0.5f) };
+	}
+
+	Quaternion Quaternion::CreateRotationZ(float roll)
+	{
+		return { 0.f, 0.f, sinf(roll * 0.5f), cosf(roll * 0.5f) };
+	}
+
+	Quaternion Quaternion::CreateRotation(float pitch, float yaw, float roll)
+	{
+		return CreateRotation({ pitch, yaw, roll });
+	}
+
+	Quaternion Quaternion::CreateRotation(const Vector3& r)
+	{
+		return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
+	}
+
+#pragma region Operator Overloads
+	Quaternion Quaternion::operator*(const Quaternion& q) const
+	{
+		// Hamilton product q * this: rotate by this first, then by q
+		return {
+			q.w * x + q.x * w + q.y * z - q.z * y,
+			q.w * y - q.x * z + q.y * w + q.z * x,
+			q.w * z + q.x * y - q.y * x + q.z * w,
+			q.w * w - q.x * x - q.y * y - q.z * z
+		};
+	}
+
+	Quaternion& Quaternion::operator*=(const Quaternion& q)
+	{
+		*this = *this * q;
+		return *this;
+	}
+#pragma endregion
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "Vector3.h"
+#include "Matrix.h"
+
+namespace dae
+{
+	// Unit quaternion rotation, same conventions as Matrix (row vectors, LH):
+	// (a * b) applies a first, then b, so (a * b).ToMatrix() == a.ToMatrix() * b.ToMatrix()
+	struct Quaternion
+	{
+		float x{};
+		float y{};
+		float z{};
+		float w{ 1.f };
+
+		Quaternion() = default;
+		Quaternion(float _x, float _y, float _z, float _w);
+
+		float Magnitude() const;
+		float SqrMagnitude() const;
+		float Normalize();
+		Quaternion Normalized() const;
+		// inverse of a unit quaternion
+		Quaternion Conjugate() const;
+
+		Vector3 Rotate(const Vector3& v) const;
+
+		Matrix ToMatrix() const;
+		// rotation followed by a translation (world matrix)
+		Matrix ToMatrix(const Vector3& translation) const;
+
+		// Batch: result[i] = rotations[i].ToMatrix(translations[i]) (AVX2, 8 instances per iteration)
+		static void ToMatrices(std::span<const Quaternion> rotations, std::span<const Vector3> translations, std::span<Matrix> result);
+
+		static float Dot(const Quaternion& q1, const Quaternion& q2);
+		// shortest path, t in [0, 1]
+		static Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t);
+		// normalized lerp, cheaper than Slerp but not constant speed
+		static Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+		static Quaternion CreateFromAxisAngle(const Vector3& axis, float angle);
+		// same angles and order as Matrix::CreateRotationX / Y / Z / CreateRotation
+		static Quaternion CreateRotationX(float pitch);
+		static Quaternion CreateRotationY(float yaw);
+		static Quaternion CreateRotationZ(float roll);
+		static Quaternion CreateRotation(float pitch, float yaw, float roll);
+		static Quaternion CreateRotation(const Vector3& r);
+
+		Quaternion operator*(const Quaternion& q) const;
+		Quaternion& operator*=(const Quaternion& q);
+
+		static const Quaternion Identity;
+	};
+}
+
+#endif // !QUATERNION_H
\ No newline at end of file
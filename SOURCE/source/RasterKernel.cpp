@@ -0,0 +1,254 @@
+#include "pch.h"
+#include "RasterKernel.h"
+
+#include <bit>
+#include <chrono>
+#include <random>
+
+#include <immintrin.h>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr int g_LastPixel{ EdgeTriangle::BlockSize - 1 };
+
+		// top-left fill rule: pixels exactly on an edge only belong to the triangle on a top or left edge
+		inline bool IsTopLeftEdge(int64_t deltaX, int64_t deltaY)
+		{
+			const bool isTopEdge{ deltaY == 0 && deltaX > 0 };
+			const bool isLeftEdge{ deltaY < 0 };
+			return isTopEdge || isLeftEdge;
+		}
+
+		// smallest and largest edge value over the pixel centers of a block (the function is linear)
+		inline void GetBlockRange(const EdgeTriangle& triangle, int edge, int blockX, int blockY, int64_t& minValue, int64_t& maxValue)
+		{
+			const int64_t corner{ triangle.Evaluate(edge, blockX, blockY) };
+			const int64_t spanX{ static_cast<int64_t>(triangle.stepX[edge]) * g_LastPixel };
+			const int64_t spanY{ static_cast<int64_t>(triangle.stepY[edge]) * g_LastPixel };
+			minValue = corner + std::min<int64_t>(spanX, 0) + std::min<int64_t>(spanY, 0);
+			maxValue = corner + std::max<int64_t>(spanX, 0) + std::max<int64_t>(spanY, 0);
+		}
+	}
+
+	int64_t EdgeTriangle::Setup(const Vector2 screen[3])
+	{
+		int64_t fixedX[3];
+		int64_t fixedY[3];
+		for (int idx{}; idx < 3; ++idx)
+		{
+			fixedX[idx] = static_cast<int64_t>(std::lround(screen[idx].x * SubPixelSteps));
+			fixedY[idx] = static_cast<int64_t>(std::lround(screen[idx].y * SubPixelSteps));
+		}
+
+		constexpr int64_t halfPixel{ SubPixelSteps / 2 };
+		for (int edge{}; edge < 3; ++edge)
+		{
+			// edge 0: v1 -> v2, edge 1: v2 -> v0, edge 2: v0 -> v1
+			const int a{ (edge + 1) % 3 };
+			const int b{ (edge + 2) % 3 };
+			const int64_t deltaX{ fixedX[b] - fixedX[a] };
+			const int64_t deltaY{ fixedY[b] - fixedY[a] };
+
+			// E(p) = deltaX * (p.y - a.y) - deltaY * (p.x - a.x), at the pixel center p = (x, y) * 16 + 8
+			const int64_t valueAtOrigin{ deltaX * (halfPixel - fixedY[a]) - deltaY * (halfPixel - fixedX[a]) };
+			stepX[edge] = static_cast<int32_t>(-deltaY * SubPixelSteps);
+			stepY[edge] = static_cast<int32_t>(deltaX * SubPixelSteps);
+			// E > 0, or E == 0 on a top-left edge  <=>  E + bias >= 0
+			bias[edge] = IsTopLeftEdge(deltaX, deltaY) ? 0 : 1;
+			offset[edge] = valueAtOrigin - bias[edge];
+		}
+
+		return (fixedX[1] - fixedX[0]) * (fixedY[2] - fixedY[0]) - (fixedY[1] - fixedY[0]) * (fixedX[2] - fixedX[0]);
+	}
+
+	BlockCoverage ClassifyBlock(const EdgeTriangle& triangle, int blockX, int blockY)
+	{
+		bool isFull{ true };
+		for (int edge{}; edge < 3; ++edge)
+		{
+			int64_t minValue;
+			int64_t maxValue;
+			GetBlockRange(triangle, edge, blockX, blockY, minValue, maxValue);
+			if (maxValue < 0) return BlockCoverage::Empty;
+			if (minValue < 0) isFull = false;
+		}
+		return isFull ? BlockCoverage::Full : BlockCoverage::Partial;
+	}
+
+	uint64_t RasterizeBlock(const EdgeTriangle& triangle, int blockX, int blockY)
+	{
+		// trivial reject / accept per edge, only partial edges are evaluated per pixel
+#if defined(__AVX2__)
+		int partialEdges[3];
+#endif
+		int nrOfPartialEdges{};
+		for (int edge{}; edge < 3; ++edge)
+		{
+			int64_t minValue;
+			int64_t maxValue;
+			GetBlockRange(triangle, edge, blockX, blockY, minValue, maxValue);
+			if (maxValue < 0) return 0;
+			if (minValue >= 0) continue;
+#if defined(__AVX2__)
+			partialEdges[nrOfPartialEdges] = edge;
+#endif
+			++nrOfPartialEdges;
+		}
+		if (nrOfPartialEdges == 0) return ~uint64_t{};
+
+#if defined(__AVX2__)
+		// |value| <= |stepX| * 7 + |stepY| * 7 inside a block an edge crosses: fits 32 bits
+		__m256i rows[3];
+		__m256i stepsY[3];
+		const __m256i lanes{ _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) };
+		for (int idx{}; idx < nrOfPartialEdges; ++idx)
+		{
+			const int edge{ partialEdges[idx] };
+			const int32_t corner{ static_cast<int32_t>(triangle.Evaluate(edge, blockX, blockY)) };
+			rows[idx] = _mm256_add_epi32(_mm256_set1_epi32(corner), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(triangle.stepX[edge])));
+			stepsY[idx] = _mm256_set1_epi32(triangle.stepY[edge]);
+		}
+
+		uint64_t coverage{};
+		for (int row{}; row < EdgeTriangle::BlockSize; ++row)
+		{
+			// sign bit set = outside one of the edges
+			__m256i outside{ rows[0] };
+			for (int idx{ 1 }; idx < nrOfPartialEdges; ++idx) outside = _mm256_or_si256(outside, rows[idx]);
+			const uint32_t outsideBits{ static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) };
+			coverage |= static_cast<uint64_t>(~outsideBits & 0xFF) << (row * EdgeTriangle::BlockSize);
+
+			for (int idx{}; idx < nrOfPartialEdges; ++idx) rows[idx] = _mm256_add_epi32(rows[idx], stepsY[idx]);
+		}
+		return coverage;
+#else
+		return RasterizeBlockReference(triangle, blockX, blockY);
+#endif
+	}
+
+	uint64_t RasterizeBlockReference(const EdgeTriangle& triangle, int blockX, int blockY)
+	{
+		uint64_t coverage{};
+		for (int row{}; row < EdgeTriangle::BlockSize; ++row)
+		{
+			for (int column{}; column < EdgeTriangle::BlockSize; ++column)
+			{
+				bool isInside{ true };
+				for (int edge{}; edge < 3; ++edge)
+				{
+					if (triangle.Evaluate(edge, blockX + column, blockY + row) < 0) isInside = false;
+				}
+				if (isInside) coverage |= uint64_t{ 1 } << (row * EdgeTriangle::BlockSize + column);
+			}
+		}
+		return coverage;
+	}
+
+	namespace Utils
+	{
+		void BenchmarkRasterKernel(size_t nrOfTriangles, int nrOfRuns)
+		{
+			constexpr int width{ 640 };
+			constexpr int height{ 480 };
+			constexpr int blockSize{ EdgeTriangle::BlockSize };
+
+			// mix of small (mesh) and large (close up) triangles, partly off screen
+			std::mt19937 generator{ 42 };
+			std::uniform_real_distribution<float> centerDistribution{ -32.f, width + 32.f };
+			std::uniform_real_distribution<float> sizeDistribution{ 0.f, 1.f };
+			std::uniform_real_distribution<float> offsetDistribution{ -1.f, 1.f };
+
+			struct BenchmarkTriangle
+			{
+				EdgeTriangle edges;
+				int firstBlockX, firstBlockY, lastBlockX, lastBlockY;
+			};
+			std::vector<BenchmarkTriangle> triangles;
+			triangles.reserve(nrOfTriangles);
+			while (triangles.size() < nrOfTriangles)
+			{
+				const float size{ 2.f + 200.f * std::pow(sizeDistribution(generator), 4.f) };
+				const Vector2 center{ centerDistribution(generator), centerDistribution(generator) * height / width };
+				Vector2 screen[3];
+				for (Vector2& vertex : screen) vertex = center + Vector2{ offsetDistribution(generator), offsetDistribution(generator) } * size;
+
+				BenchmarkTriangle triangle{};
+				int64_t area{ triangle.edges.Setup(screen) };
+				if (area < 0)
+				{
+					std::swap(screen[1], screen[2]);
+					area = triangle.edges.Setup(screen);
+				}
+				if (area <= 0) continue;
+
+				const float minX{ std::max(0.f, std::min({ screen[0].x, screen[1].x, screen[2].x })) };
+				const float minY{ std::max(0.f, std::min({ screen[0].y, screen[1].y, screen[2].y })) };
+				const float maxX{ std::min(width - 1.f, std::max({ screen[0].x, screen[1].x, screen[2].x })) };
+				const float maxY{ std::min(height - 1.f, std::max({ screen[0].y, screen[1].y, screen[2].y })) };
+				if (minX > maxX || minY > maxY) continue;
+
+				triangle.firstBlockX = static_cast<int>(minX) / blockSize * blockSize;
+				triangle.firstBlockY = static_cast<int>(minY) / blockSize * blockSize;
+				triangle.lastBlockX = static_cast<int>(maxX) / blockSize * blockSize;
+				triangle.lastBlockY = static_cast<int>(maxY) / blockSize * blockSize;
+				triangles.push_back(triangle);
+			}
+
+			// both kernels over every block of every bounding box
+			const auto runKernel = [&](uint64_t(*pKernel)(const EdgeTriangle&, int, int), std::vector<uint64_t>& masks, uint64_t& nrOfPixels)
+				{
+					masks.clear();
+					nrOfPixels = 0;
+					double bestMs{ DBL_MAX };
+					for (int run{}; run < nrOfRuns; ++run)
+					{
+						masks.clear();
+						nrOfPixels = 0;
+						const auto startTime{ std::chrono::steady_clock::now() };
+						for (const BenchmarkTriangle& triangle : triangles)
+						{
+							for (int blockY{ triangle.firstBlockY }; blockY <= triangle.lastBlockY; blockY += blockSize)
+							{
+								for (int blockX{ triangle.firstBlockX }; blockX <= triangle.lastBlockX; blockX += blockSize)
+								{
+									const uint64_t mask{ pKernel(triangle.edges, blockX, blockY) };
+									nrOfPixels += std::popcount(mask);
+									masks.push_back(mask);
+								}
+							}
+						}
+						bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+					}
+					return bestMs;
+				};
+
+			std::vector<uint64_t> referenceMasks;
+			std::vector<uint64_t> masks;
+			uint64_t nrOfReferencePixels{};
+			uint64_t nrOfPixels{};
+			const double referenceMs{ runKernel(&RasterizeBlockReference, referenceMasks, nrOfReferencePixels) };
+			const double kernelMs{ runKernel(&RasterizeBlock, masks, nrOfPixels) };
+
+			size_t nrOfDifferentBlocks{};
+			for (size_t idx{}; idx < masks.size(); ++idx)
+			{
+				if (masks[idx] != referenceMasks[idx]) ++nrOfDifferentBlocks;
+			}
+
+#if defined(__AVX2__)
+			const char* pInstructionSet{ "AVX2" };
+#else
+			const char* pInstructionSet{ "scalar" };
+#endif
+			const double nrOfBlocks{ static_cast<double>(masks.size()) };
+			std::cout << "Raster Kernel Benchmark: " << triangles.size() << " triangles, " << masks.size() << " 8x8 blocks, "
+				<< nrOfPixels << " covered pixels, " << pInstructionSet << "\n";
+			std::cout << "  Reference (scalar): " << referenceMs << " ms, " << nrOfBlocks / (referenceMs * 1000.0) << " M blocks/s\n";
+			std::cout << "  RasterizeBlock:     " << kernelMs << " ms, " << nrOfBlocks / (kernelMs * 1000.0) << " M blocks/s ("
+				<< referenceMs / kernelMs << "x)\n";
+			std::cout << "  Different blocks: " << nrOfDifferentBlocks << ", covered pixels " << nrOfPixels << " vs " << nrOfReferencePixels << "\n";
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef RASTERKERNEL_H
+#define RASTERKERNEL_H
+
+namespace dae
+{
+	struct Vector2;
+
+	// Half-space setup of a clockwise screen space triangle (y down, front facing in D3D).
+	// Vertices are snapped to 1/16 pixel. Edge i is the one opposite vertex i, its value at a pixel
+	// center is >= 0 inside the triangle, with the top-left fill rule folded into the offset.
+	struct EdgeTriangle
+	{
+		static constexpr int SubPixelBits{ 4 };
+		static constexpr int SubPixelSteps{ 1 << SubPixelBits };
+		static constexpr int BlockSize{ 8 };
+		// |x| and |y| in pixels, larger coordinates would overflow the 32-bit block evaluation
+		static constexpr float MaxCoordinate{ 16384.f };
+
+		int32_t stepX[3];  // edge value change one pixel to the right
+		int32_t stepY[3];  // edge value change one pixel down
+		int64_t offset[3]; // edge value at the center of pixel (0, 0)
+		int32_t bias[3];   // fill rule, 1 on edges that are not top-left (already in offset)
+
+		// returns twice the signed area in fixed point units, the edges are only valid when it is > 0
+		int64_t Setup(const Vector2 screen[3]);
+
+		int64_t Evaluate(int edge, int x, int y) const
+		{
+			return offset[edge] + static_cast<int64_t>(stepX[edge]) * x + static_cast<int64_t>(stepY[edge]) * y;
+		}
+
+		// without the fill rule bias, for barycentric weights
+		int64_t EvaluateUnbiased(int edge, int x, int y) const
+		{
+			return Evaluate(edge, x, y) + bias[edge];
+		}
+	};
+
+	enum class BlockCoverage
+	{
+		Empty = 0,
+		Partial,
+		Full,
+	};
+
+	// Trivial reject / accept of the 8x8 block with top-left pixel (blockX, blockY), from its corners
+	BlockCoverage ClassifyBlock(const EdgeTriangle& triangle, int blockX, int blockY);
+
+	// Bit (row * 8 + column) set for every covered pixel of the 8x8 block.
+	// AVX2 (when built with /arch:AVX2): 8 pixels per edge at once, stepped down row by row.
+	// Edges that trivially accept the block are skipped, the others fit 32 bits inside a block.
+	uint64_t RasterizeBlock(const EdgeTriangle& triangle, int blockX, int blockY);
+	// Scalar 64-bit evaluation of every pixel, for validation and builds without AVX2 (the MSVC project always enables it)
+	uint64_t RasterizeBlockReference(const EdgeTriangle& triangle, int blockX, int blockY);
+
+	namespace Utils
+	{
+		// Random triangles: RasterizeBlock vs RasterizeBlockReference masks and blocks / second
+		void BenchmarkRasterKernel(size_t nrOfTriangles = 100000, int nrOfRuns = 5);
+	}
+}
+
+#endif // !RASTERKERNEL_H
\ No newline at end of file
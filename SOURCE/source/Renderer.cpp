@@ -3,58 +3,114 @@
 #include "DataTypes.h"
 #include "Camera.h"
 #include "Texture.h"
-#include "Utils.h"
+#include "MeshData.h"
+#ifdef DAE_HAS_DIRECTX
 #include "VehicleEffect.h"
 #include "FireEffect.h"
+#endif
 #include "Mesh.h"
+#include "SoftwareRasterizer.h"
+#include "MaterialPacker.h"
+#include "AssetLoader.h"
+#include "ResourceCache.h"
+
+#include <mutex>
 
 namespace dae 
 {
+	namespace
+	{
+		// resource creation of finished loads per frame, a frame creates at least one
+		constexpr double g_AssetCreateBudgetMs{ 4.0 };
+
+		// the packed maps are built from the separate ones once, by the worker that decodes the first of them
+		struct PackedMaterialBuild
+		{
+			std::once_flag flag;
+			bool isBuilt{ false };
+		};
+	}
+
 	Renderer::Renderer(SDL_Window* pWindow, int width, int height) 
 		: m_pWindow{ pWindow }
 		, m_Width{ width }
 		, m_Height{ height }
 		, m_IsInitialized{ false }
 		, m_CurrentFileringMode{ FilteringMode::Point }
-		, m_pVehicleMesh{ nullptr }
+		, m_RasterizerMode{ RasterizerMode::Hardware }
+		, m_pDevice{ nullptr }
+#ifdef DAE_HAS_DIRECTX
+		, m_pDeviceContext{ nullptr }
+		, m_pSwapChain{ nullptr }
+		, m_pDepthStencilBuffer{ nullptr }
+		, m_pDepthStencilView{ nullptr }
+		, m_pRenderTargetBuffer{ nullptr }
+		, m_pRenderTargetView{ nullptr }
+#endif
+		, m_pSoftwareRasterizer{ nullptr }
+		, m_pBackBuffer{ nullptr }
 		, m_pCamera{ nullptr }
-		, m_pVechicleDiffusedMap{ nullptr }
+		, m_UsePackedMaterial{ false }
+		, m_TextureBudget{ 0 }
 		, m_RotateAngle{ 0.f }
 		, m_MeshRotating{ true }
 		, m_ShowFireFX{ true }
+		, m_pAssetLoader{ nullptr }
+		, m_pResourceCache{ nullptr }
 		, m_MeshRotationSpeed{ static_cast<float>(M_PI) / 4.f } // 45/sec
+		, m_IsWorldViewProjectionDirty{ true }
 	{
 		// Camera
 		m_pCamera = new Camera{ {0.f, 0.f, -50.f}, 45.f, width / static_cast<float>(height), 0.1f, 1000.f };
 
+		// Software Rasterizer (always available, also without window / GPU)
+		m_pSoftwareRasterizer = new SoftwareRasterizer{ width, height };
+		m_pBackBuffer = SDL_CreateRGBSurfaceWithFormatFrom(m_pSoftwareRasterizer->GetColorBuffer(), width, height, 32, width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_ARGB8888);
+
 		//Initialize DirectX
-		if (InitializeDirectX() == S_OK)
+#ifdef DAE_HAS_DIRECTX
+		if (m_pWindow && InitializeDirectX() == S_OK)
 		{
 			m_IsInitialized = true;
 			std::cout << "DirectX is initialized and ready!\n";
 		}
 		else
 		{
-			std::cout << "DirectX initialization failed!\n";
+			m_RasterizerMode = RasterizerMode::Software;
+			std::cout << "DirectX initialization failed! Using the software rasterizer\n";
 		}
+#else
+		m_RasterizerMode = RasterizerMode::Software;
+		std::cout << "Built without DirectX, using the software rasterizer\n";
+#endif
 
 		InitMesh();
 	}
 
 	Renderer::~Renderer()
 	{
-		if (m_pVehicleMesh) delete m_pVehicleMesh;
-		if (m_pFireMesh) delete m_pFireMesh;
+		// first, no more loads finishing into the members below
+		if (m_pAssetLoader) delete m_pAssetLoader;
 
 		if (m_pCamera) delete m_pCamera;
 
-		if (m_pVechicleDiffusedMap) delete m_pVechicleDiffusedMap;
-		if (m_pFireDiffusedMap) delete m_pFireDiffusedMap;
-		if (m_pNormalMap) delete m_pNormalMap;
-		if (m_pSpecularMap) delete m_pSpecularMap;
-		if (m_pGlossinessMap) delete m_pGlossinessMap;
+		// the handles, then the cache: every mesh and texture is released before the device
+		m_pVehicleMesh.reset();
+		m_pFireMesh.reset();
+		m_CPUAccessMaps.clear();
+		for (std::shared_ptr<Texture>* pMap : { &m_pVechicleDiffusedMap, &m_pFireDiffusedMap, &m_pNormalMap, &m_pSpecularMap, &m_pGlossinessMap, &m_pDiffuseGlossMap, &m_pNormalSpecularMap,
+			&m_pPlaceholderMap, &m_pPlaceholderNormalMap })
+		{
+			pMap->reset();
+		}
+		if (m_pResourceCache) delete m_pResourceCache;
+
+		if (m_pBackBuffer) SDL_FreeSurface(m_pBackBuffer);
+		if (m_pSoftwareRasterizer) delete m_pSoftwareRasterizer;
 
+#ifdef DAE_HAS_DIRECTX
 		ReleaseDirectXResources();
+#endif
 	}
 
 	void Renderer::ToggleFilteringMode()
@@ -80,6 +136,8 @@ namespace dae
 			break;
 		}
 		std::cout << "\n";
+
+		UpdateCPUAccess();
 	}
 
 	void Renderer::ToggleRotating()
@@ -92,36 +150,215 @@ namespace dae
 
 	}
 
+	void Renderer::TogglePackedMaterial()
+	{
+		std::cout << "Material: ";
+
+		if (m_pDiffuseGlossMap == m_pPlaceholderMap || m_pNormalSpecularMap == m_pPlaceholderNormalMap)
+		{
+			std::cout << "SEPARATE (packed maps not loaded)\n";
+			return;
+		}
+
+		m_UsePackedMaterial = !m_UsePackedMaterial;
+		std::cout << (m_UsePackedMaterial ? "PACKED (2 fetches)" : "SEPARATE (4 fetches)") << "\n";
+	}
+
 	void Renderer::ToggleFireFX()
 	{
 		m_ShowFireFX = !m_ShowFireFX;
 	}
 
+	void Renderer::ToggleRasterizerMode()
+	{
+		std::cout << "RasterizerMode: ";
+
+		if (!m_IsInitialized)
+		{
+			std::cout << "SOFTWARE (DirectX not available)\n";
+			return;
+		}
+
+		switch (m_RasterizerMode)
+		{
+		case dae::RasterizerMode::Hardware:
+			m_RasterizerMode = RasterizerMode::Software;
+			std::cout << "SOFTWARE";
+			break;
+		case dae::RasterizerMode::Software:
+			m_RasterizerMode = RasterizerMode::Hardware;
+			std::cout << "HARDWARE";
+			break;
+		default:
+			std::cout << "UNKNOWN!";
+			break;
+		}
+		std::cout << "\n";
+
+		UpdateCPUAccess();
+	}
+
+	void Renderer::ToggleSoftwareShading()
+	{
+		std::cout << "SoftwareShading: ";
+
+		switch (m_pSoftwareRasterizer->GetShading())
+		{
+		case dae::SoftwareShading::Forward:
+			m_pSoftwareRasterizer->SetShading(SoftwareShading::VisibilityBuffer);
+			std::cout << "VISIBILITY BUFFER";
+			break;
+		case dae::SoftwareShading::VisibilityBuffer:
+			m_pSoftwareRasterizer->SetShading(SoftwareShading::Forward);
+			std::cout << "FORWARD";
+			break;
+		default:
+			std::cout << "UNKNOWN!";
+			break;
+		}
+		std::cout << "\n";
+
+		UpdateCPUAccess();
+	}
+
 	void Renderer::Update(const Timer* const pTimer)
 	{
+		m_pAssetLoader->ProcessCompletions(g_AssetCreateBudgetMs);
+		FitTextureBudget();
+
 		m_pCamera->Update(pTimer);
 
 		if (m_MeshRotating)
 		{
 			m_RotateAngle += pTimer->GetElapsed() * m_MeshRotationSpeed;
-			m_RotationMatrix = Matrix::CreateRotation(0.f, m_RotateAngle, 0.f);
-			m_WorldMatrix = m_RotationMatrix * m_TranslationMatrix;
+			m_Rotation = Quaternion::CreateRotationY(m_RotateAngle);
+			m_WorldMatrix = m_Rotation.ToMatrix(m_Translation);
+			m_IsWorldViewProjectionDirty = true;
 		}
 
-		// World View Projection Matrix
-		m_WorldViewProjectionMatrix = m_WorldMatrix * m_pCamera->GetViewMatrix() * m_pCamera->GetProjectionMatrix();
-		m_pVehicleMesh->GetEffect()->GetWorldViewProjectionMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldViewProjectionMatrix));
-		m_pFireMesh->GetEffect()->GetWorldViewProjectionMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldViewProjectionMatrix));
+		// World View Projection Matrix (only when the world or the camera moved)
+		if (!m_IsWorldViewProjectionDirty && !m_pCamera->HasChanged()) return;
+		m_WorldViewProjectionMatrix = m_WorldMatrix * m_pCamera->GetViewProjectionMatrix();
+		m_IsWorldViewProjectionDirty = false;
+
+#ifdef DAE_HAS_DIRECTX
+		// Effect variables only exist when DirectX is up
+		if (!m_IsInitialized) return;
+
+		if (m_pVehicleMesh)
+		{
+			m_pVehicleMesh->GetEffect()->GetWorldViewProjectionMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldViewProjectionMatrix));
 
-		// Camera Pos
-		Vector3 cameraPos{ m_pCamera->GetOrigin() };
-		m_pVehicleMesh->GetEffect()->GetCameraPos()->SetFloatVector(reinterpret_cast<float*>(&cameraPos));
+			// Camera Pos
+			Vector3 cameraPos{ m_pCamera->GetOrigin() };
+			m_pVehicleMesh->GetEffect()->GetCameraPos()->SetFloatVector(reinterpret_cast<float*>(&cameraPos));
 
-		// World Matrix
-		m_pVehicleMesh->GetEffect()->GetWorldMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldMatrix));
+			// World Matrix
+			m_pVehicleMesh->GetEffect()->GetWorldMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldMatrix));
+		}
+		if (m_pFireMesh) m_pFireMesh->GetEffect()->GetWorldViewProjectionMatrix()->SetMatrix(reinterpret_cast<float*>(&m_WorldViewProjectionMatrix));
+#endif
 	}
 
 	void Renderer::Render() const
+	{
+		switch (m_RasterizerMode)
+		{
+#ifdef DAE_HAS_DIRECTX
+		case dae::RasterizerMode::Hardware:
+			RenderDirectX();
+			break;
+#endif
+		case dae::RasterizerMode::Software:
+			RenderSoftware();
+			break;
+		default:
+			break;
+		}
+	}
+
+	uint32_t Renderer::GetNrOfLoadingAssets() const
+	{
+		return m_pAssetLoader->GetNrOfPending();
+	}
+
+	void Renderer::WaitForAssets()
+	{
+		m_pAssetLoader->WaitAll();
+	}
+
+	void Renderer::PrintResourceStats() const
+	{
+		m_pResourceCache->PrintStats();
+
+		constexpr double megaByte{ 1024.0 * 1024.0 };
+		const TextureMemoryStats stats{ Texture::GetMemoryStats() };
+		std::cout << "Texture memory: " << stats.nrOfTextures << " textures, " << stats.cpuBytes / megaByte << " MB CPU (" << stats.nrOfCPUCopies << " copies), "
+			<< stats.gpuBytes / megaByte << " MB GPU, " << stats.nrOfDroppedLevels << " mip levels dropped";
+		if (m_TextureBudget > 0) std::cout << ", budget " << m_TextureBudget / megaByte << " MB";
+		std::cout << "\n";
+	}
+
+	void Renderer::SetTextureBudget(size_t budget)
+	{
+		m_TextureBudget = budget;
+		FitTextureBudget();
+	}
+
+	bool Renderer::SaveBufferToImage(const std::string& path) const
+	{
+		if (m_RasterizerMode != RasterizerMode::Software)
+		{
+			std::cout << "SaveBufferToImage is only supported by the software rasterizer\n";
+			return false;
+		}
+
+		return SDL_SaveBMP(m_pBackBuffer, path.c_str()) == 0;
+	}
+
+	void Renderer::SetSoftwareThreadCount(uint32_t nrOfThreads)
+	{
+		m_pSoftwareRasterizer->SetNrOfThreads(nrOfThreads);
+	}
+
+	void Renderer::SetSoftwareGuardBand(float guardBand)
+	{
+		m_pSoftwareRasterizer->SetGuardBand(guardBand);
+	}
+
+	void Renderer::PrintSoftwareStats() const
+	{
+		m_pSoftwareRasterizer->PrintStats();
+	}
+
+	bool Renderer::ValidateSoftware() const
+	{
+		RenderSoftware();
+		const uint32_t* pColorBuffer{ m_pSoftwareRasterizer->GetColorBuffer() };
+		const std::vector<uint32_t> image{ pColorBuffer, pColorBuffer + static_cast<size_t>(m_Width) * m_Height };
+
+		// single threaded, forward shaded reference
+		const uint32_t nrOfThreads{ m_pSoftwareRasterizer->GetNrOfThreads() };
+		const SoftwareShading shading{ m_pSoftwareRasterizer->GetShading() };
+		m_pSoftwareRasterizer->SetNrOfThreads(1);
+		m_pSoftwareRasterizer->SetShading(SoftwareShading::Forward);
+		RenderSoftware();
+		m_pSoftwareRasterizer->SetNrOfThreads(nrOfThreads);
+		m_pSoftwareRasterizer->SetShading(shading);
+
+		size_t nrOfDifferentPixels{};
+		for (size_t idx{}; idx < image.size(); ++idx)
+		{
+			if (image[idx] != pColorBuffer[idx]) ++nrOfDifferentPixels;
+		}
+
+		std::cout << "Software validation (" << nrOfThreads << " threads" << (shading == SoftwareShading::VisibilityBuffer ? ", visibility buffer" : "")
+			<< " vs 1, forward): " << nrOfDifferentPixels << " different pixels\n";
+		return nrOfDifferentPixels == 0;
+	}
+
+#ifdef DAE_HAS_DIRECTX
+	void Renderer::RenderDirectX() const
 	{
 		// check if initialization worked
 		if (!m_IsInitialized) return;
@@ -132,9 +369,10 @@ namespace dae
 		m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.f, 0);
 
 		//2. SET PIPELINE + INVOKE DRAW CALLS (= RENDER)
-		m_pVehicleMesh->Render(m_pDeviceContext, static_cast<uint32_t>(m_CurrentFileringMode));
+		const uint32_t vehiclePassIdx{ static_cast<uint32_t>(m_CurrentFileringMode) + (m_UsePackedMaterial ? VehicleEffect::PackedPassOffset : 0) };
+		if (m_pVehicleMesh) m_pVehicleMesh->Render(m_pDeviceContext, vehiclePassIdx);
 
-		if (m_ShowFireFX)
+		if (m_ShowFireFX && m_pFireMesh && m_pFireDiffusedMap != m_pPlaceholderMap)
 		{
 			m_pFireMesh->Render(m_pDeviceContext, static_cast<uint32_t>(m_CurrentFileringMode));
 		}
@@ -142,7 +380,47 @@ namespace dae
 		//3. PRESENT BACKBUFFER (SWAP)
 		m_pSwapChain->Present(0, 0);
 	}
+#endif
 
+	void Renderer::RenderSoftware() const
+	{
+		//1. CLEAR COLOR & DEPTH BUFFER
+		constexpr ColorRGB backGroundColor{ 0.39f, 0.59f, 0.93f };
+		m_pSoftwareRasterizer->Clear(backGroundColor);
+		m_pSoftwareRasterizer->SetCameraPosition(m_pCamera->GetOrigin());
+
+		//2. BIN MESHES INTO TILES, RASTERIZE ON ALL CORES (same vertex buffers as the DirectX path)
+		SoftwareMaterial vehicleMaterial{};
+		vehicleMaterial.shader = SoftwareShader::Vehicle;
+		vehicleMaterial.pDiffuseMap = m_pVechicleDiffusedMap.get();
+		vehicleMaterial.pNormalMap = m_pNormalMap.get();
+		vehicleMaterial.pSpecularMap = m_pSpecularMap.get();
+		vehicleMaterial.pGlossinessMap = m_pGlossinessMap.get();
+		if (m_UsePackedMaterial)
+		{
+			vehicleMaterial.pDiffuseGlossMap = m_pDiffuseGlossMap.get();
+			vehicleMaterial.pNormalSpecularMap = m_pNormalSpecularMap.get();
+		}
+		if (m_pVehicleMesh) m_pSoftwareRasterizer->Draw(m_pVehicleMesh->GetVertices(), m_pVehicleMesh->GetIndices(), m_WorldMatrix, m_WorldViewProjectionMatrix, vehicleMaterial, m_CurrentFileringMode);
+
+		if (m_ShowFireFX && m_pFireMesh && m_pFireDiffusedMap != m_pPlaceholderMap)
+		{
+			SoftwareMaterial fireMaterial{};
+			fireMaterial.shader = SoftwareShader::Fire;
+			fireMaterial.pDiffuseMap = m_pFireDiffusedMap.get();
+			m_pSoftwareRasterizer->Draw(m_pFireMesh->GetVertices(), m_pFireMesh->GetIndices(), m_WorldMatrix, m_WorldViewProjectionMatrix, fireMaterial, m_CurrentFileringMode);
+		}
+		m_pSoftwareRasterizer->Flush();
+
+		//3. PRESENT BACKBUFFER (headless: stays in memory)
+		if (m_pWindow)
+		{
+			SDL_BlitSurface(m_pBackBuffer, nullptr, SDL_GetWindowSurface(m_pWindow), nullptr);
+			SDL_UpdateWindowSurface(m_pWindow);
+		}
+	}
+
+#ifdef DAE_HAS_DIRECTX
 	HRESULT Renderer::InitializeDirectX()
 	{
 		// 1. Create Device & DeviceContext
@@ -257,50 +535,190 @@ namespace dae
 		if(m_pRenderTargetBuffer) m_pRenderTargetBuffer->Release();
 		if(m_pRenderTargetView) m_pRenderTargetView->Release();
 	}
+#endif
 
 	void Renderer::InitMesh()
 	{
-		m_TranslationMatrix = Matrix::CreateTranslation(0.f, 0.f, 0.f);
-		m_RotationMatrix = Matrix::CreateRotation(0.f, 0.f, 0.f);
-		m_WorldMatrix = m_RotationMatrix * m_TranslationMatrix;
-
-		//// VEHICLE ////
-		// mesh vertices / indices vechicle
-		std::vector<Vertex> vehileVertices;
-		std::vector<uint32_t> vehicleIndices;
-		if (!dae::Utils::ParseOBJ("Resources/vehicle.obj", vehileVertices, vehicleIndices))
-		{
-			assert(false);
-		}
+		// without DirectX, meshes and textures only keep their CPU data
+		ID3D11Device* pDevice{ m_IsInitialized ? m_pDevice : nullptr };
 
-		m_pVehicleMesh = new Mesh<VehicleEffect>{ m_pDevice, vehileVertices, vehicleIndices, L"Resources/Vehicle.fx" };
+		m_Translation = Vector3::Zero;
+		m_Rotation = Quaternion::Identity;
+		m_WorldMatrix = m_Rotation.ToMatrix(m_Translation);
 
-		// load in maps / textures
-		m_pVechicleDiffusedMap = Texture::LoadFromFile(m_pDevice, "Resources/vehicle_diffuse.png");
-		m_pVehicleMesh->GetEffect()->SetDiffusemap(m_pVechicleDiffusedMap);
+		// block compressed textures (cached next to the images), fast encoding while iterating
+#if defined(DEBUG) || defined(_DEBUG)
+		constexpr CompressionQuality textureQuality{ CompressionQuality::Fast };
+#else
+		constexpr CompressionQuality textureQuality{ CompressionQuality::Quality };
+#endif
 
-		m_pNormalMap = Texture::LoadFromFile(m_pDevice, "Resources/vehicle_normal.png");
-		m_pVehicleMesh->GetEffect()->SetNormalMap(m_pNormalMap);
+		// every map starts as a placeholder, the first frame does not wait for any file
+		m_pPlaceholderMap = std::shared_ptr<Texture>{ Texture::CreateSolid(pDevice, 0x00808080) };
+		m_pPlaceholderNormalMap = std::shared_ptr<Texture>{ Texture::CreateSolid(pDevice, 0x00FF8080) };
+		m_pVechicleDiffusedMap = m_pPlaceholderMap;
+		m_pNormalMap = m_pPlaceholderNormalMap;
+		m_pSpecularMap = m_pPlaceholderMap;
+		m_pGlossinessMap = m_pPlaceholderMap;
+		m_pDiffuseGlossMap = m_pPlaceholderMap;
+		m_pNormalSpecularMap = m_pPlaceholderNormalMap;
+		m_pFireDiffusedMap = m_pPlaceholderMap;
+
+		// Decoding (OBJ / mesh cache, tangents, PNG, mips, block compression, texture cache) on the workers,
+		// the effects, buffers and textures are created in Update. Meshes first, they are drawn as soon as they exist.
+		m_pAssetLoader = new AssetLoader{};
+		// Everything goes through the cache: a mesh / map that is cached already (same file and settings) is not loaded
+		// again, and a decoded one with the same content as a cached one shares it (nothing is created or uploaded).
+		// create hands that match to onReady through pContentMatch.
+		m_pResourceCache = new ResourceCache{};
+
+		const auto loadMesh{ [this, pDevice]<typename EffectClass>(std::shared_ptr<Mesh<EffectClass>>& pMesh, const std::string& objPath, const std::wstring& effectPath)
+			{
+				const std::string key{ Mesh<EffectClass>::GetCacheKey(objPath, effectPath) };
+				pMesh = m_pResourceCache->Find<Mesh<EffectClass>>(key);
+				if (pMesh)
+				{
+					BindMaps();
+					return;
+				}
+
+				// one thread per load, the asset workers already use every core
+				const std::shared_ptr<std::shared_ptr<Mesh<EffectClass>>> pContentMatch{ std::make_shared<std::shared_ptr<Mesh<EffectClass>>>() };
+				m_pAssetLoader->Load<MeshData, Mesh<EffectClass>>(objPath,
+					[objPath]() { return MeshData::LoadFromFile(objPath, true, 1); },
+					[this, pDevice, effectPath, key, pContentMatch](std::unique_ptr<MeshData> pMeshData)
+					{
+						*pContentMatch = m_pResourceCache->FindContent<Mesh<EffectClass>>(key, Mesh<EffectClass>::HashContent(*pMeshData, effectPath));
+						return *pContentMatch ? pContentMatch->get() : new Mesh<EffectClass>{ pDevice, std::move(pMeshData), effectPath };
+					},
+					[this, &pMesh, key, pContentMatch](Mesh<EffectClass>* pLoadedMesh)
+					{
+						pMesh = *pContentMatch ? std::move(*pContentMatch) : m_pResourceCache->Insert(key, std::shared_ptr<Mesh<EffectClass>>{ pLoadedMesh });
+						BindMaps();
+						m_IsWorldViewProjectionDirty = true;
+					});
+			} };
+
+		// prepare runs on the worker before decoding, the map keeps its placeholder when it fails
+		const auto loadMap{ [this, pDevice](std::shared_ptr<Texture>& pMap, const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression, std::function<bool()> prepare)
+			{
+				const std::string key{ Texture::GetCacheKey(path, mipSettings, compression) };
+				if (std::shared_ptr<Texture> pCachedMap{ m_pResourceCache->Find<Texture>(key) })
+				{
+					pMap = std::move(pCachedMap);
+					BindMaps();
+					UpdateCPUAccess();
+					return;
+				}
+
+				const std::shared_ptr<std::shared_ptr<Texture>> pContentMatch{ std::make_shared<std::shared_ptr<Texture>>() };
+				m_pAssetLoader->Load<TextureData, Texture>(path,
+					[path, mipSettings, compression, prepare]() { return !prepare || prepare() ? Texture::Decode(path, mipSettings, compression, 1) : nullptr; },
+					[this, pDevice, key, pContentMatch](std::unique_ptr<TextureData> pData)
+					{
+						*pContentMatch = m_pResourceCache->FindContent<Texture>(key, pData->contentHash);
+						return *pContentMatch ? pContentMatch->get() : Texture::Create(pDevice, std::move(pData));
+					},
+					[this, &pMap, key, pContentMatch](Texture* pTexture)
+					{
+						pMap = *pContentMatch ? std::move(*pContentMatch) : m_pResourceCache->Insert(key, std::shared_ptr<Texture>{ pTexture });
+						BindMaps();
+						UpdateCPUAccess();
+					});
+			} };
+
+		//// MESHES //// (binary mesh cache after the first run)
+		loadMesh(m_pVehicleMesh, "Resources/vehicle.obj", L"Resources/Vehicle.fx");
+		loadMesh(m_pFireMesh, "Resources/fireFX.obj", L"Resources/Fire.fx");
+
+		//// VEHICLE MAPS ////
+		const MaterialPaths vehicleMaterial{ GetVehicleMaterialPaths() };
+		loadMap(m_pVechicleDiffusedMap, vehicleMaterial.diffuse, MipSettings{ MipFilter::Kaiser, MipContent::SRGBColor }, CompressionSettings{ BlockFormat::BC1, textureQuality }, nullptr);
+		loadMap(m_pNormalMap, vehicleMaterial.normal, MipSettings{ MipFilter::Kaiser, MipContent::NormalMap }, CompressionSettings{ BlockFormat::BC5, textureQuality }, nullptr);
+		loadMap(m_pSpecularMap, vehicleMaterial.specular, MipSettings{ MipFilter::Kaiser, MipContent::Color }, CompressionSettings{ BlockFormat::BC1, textureQuality }, nullptr);
+		loadMap(m_pGlossinessMap, vehicleMaterial.glossiness, MipSettings{ MipFilter::Kaiser, MipContent::Color }, CompressionSettings{ BlockFormat::BC4, textureQuality }, nullptr);
+
+		//// FIRE MAP ////
+		loadMap(m_pFireDiffusedMap, "Resources/fireFX_diffuse.png", MipSettings{ MipFilter::Kaiser, MipContent::SRGBColor }, CompressionSettings{ BlockFormat::BC3, textureQuality }, nullptr);
+
+		// channel packed variant of the same maps (built from them when missing or out of date)
+		const std::shared_ptr<PackedMaterialBuild> pPackedBuild{ std::make_shared<PackedMaterialBuild>() };
+		const auto buildPackedMaterial{ [pPackedBuild, vehicleMaterial]()
+			{
+				std::call_once(pPackedBuild->flag, [&]() { pPackedBuild->isBuilt = BuildPackedMaterial(vehicleMaterial); });
+				return pPackedBuild->isBuilt;
+			} };
+		loadMap(m_pDiffuseGlossMap, vehicleMaterial.diffuseGloss, MipSettings{ MipFilter::Kaiser, MipContent::SRGBColor }, CompressionSettings{ BlockFormat::BC3, textureQuality }, buildPackedMaterial);
+		loadMap(m_pNormalSpecularMap, vehicleMaterial.normalSpecular, MipSettings{ MipFilter::Kaiser, MipContent::NormalMap }, CompressionSettings{ BlockFormat::BC3, textureQuality }, buildPackedMaterial);
+	}
 
-		m_pSpecularMap = Texture::LoadFromFile(m_pDevice, "Resources/vehicle_specular.png");
-		m_pVehicleMesh->GetEffect()->SetSpecualarMap(m_pSpecularMap);
+	void Renderer::BindMaps() const
+	{
+#ifdef DAE_HAS_DIRECTX
+		// effects only exist when DirectX is up
+		if (!m_IsInitialized) return;
 
-		m_pGlossinessMap = Texture::LoadFromFile(m_pDevice, "Resources/vehicle_gloss.png");
-		m_pVehicleMesh->GetEffect()->SetGlossinessMap(m_pGlossinessMap);
+		if (m_pVehicleMesh)
+		{
+			m_pVehicleMesh->GetEffect()->SetDiffusemap(m_pVechicleDiffusedMap.get());
+			m_pVehicleMesh->GetEffect()->SetNormalMap(m_pNormalMap.get());
+			m_pVehicleMesh->GetEffect()->SetSpecualarMap(m_pSpecularMap.get());
+			m_pVehicleMesh->GetEffect()->SetGlossinessMap(m_pGlossinessMap.get());
+			m_pVehicleMesh->GetEffect()->SetDiffuseGlossMap(m_pDiffuseGlossMap.get());
+			m_pVehicleMesh->GetEffect()->SetNormalSpecularMap(m_pNormalSpecularMap.get());
+		}
 
-		//// FIRE ////
-		// mesh vertices / indices vechicle
-		std::vector<Vertex> fireVertices;
-		std::vector<uint32_t> fireIndices;
-		if (!dae::Utils::ParseOBJ("Resources/fireFX.obj", fireVertices, fireIndices))
+		if (m_pFireMesh)
 		{
-			assert(false);
+			m_pFireMesh->GetEffect()->SetDiffusemap(m_pFireDiffusedMap.get());
 		}
+#endif
+	}
+
+	std::vector<std::shared_ptr<Texture>> Renderer::GetMaps() const
+	{
+		std::vector<std::shared_ptr<Texture>> maps{ m_pVechicleDiffusedMap, m_pNormalMap, m_pSpecularMap, m_pGlossinessMap, m_pDiffuseGlossMap, m_pNormalSpecularMap,
+			m_pFireDiffusedMap, m_pPlaceholderMap, m_pPlaceholderNormalMap };
+		std::sort(maps.begin(), maps.end());
+		maps.erase(std::unique(maps.begin(), maps.end()), maps.end());
+		return maps;
+	}
+
+	void Renderer::UpdateCPUAccess()
+	{
+		// the software rasterizer samples the CPU copies, the GPU does not need them (they are read back when acquired)
+		std::vector<std::shared_ptr<Texture>> maps{};
+		if (m_RasterizerMode == RasterizerMode::Software) maps = GetMaps();
+
+		for (const std::shared_ptr<Texture>& pMap : maps)
+		{
+			if (!std::binary_search(m_CPUAccessMaps.begin(), m_CPUAccessMaps.end(), pMap)) pMap->AcquireCPUAccess();
+		}
+		for (const std::shared_ptr<Texture>& pMap : m_CPUAccessMaps)
+		{
+			if (!std::binary_search(maps.begin(), maps.end(), pMap)) pMap->ReleaseCPUAccess();
+		}
+		m_CPUAccessMaps = std::move(maps);
+	}
+
+	void Renderer::FitTextureBudget()
+	{
+		if (m_TextureBudget == 0) return;
+
+		const TextureMemoryStats stats{ Texture::GetMemoryStats() };
+		if (stats.cpuBytes + stats.gpuBytes <= m_TextureBudget) return;
+
+		std::vector<Texture*> maps{};
+		for (const std::shared_ptr<Texture>& pMap : GetMaps()) maps.push_back(pMap.get());
+		const uint32_t nrOfDroppedLevels{ Texture::FitBudget(maps, m_TextureBudget) };
+		if (nrOfDroppedLevels == 0) return;
 
-		m_pFireMesh = new Mesh<FireEffect>{ m_pDevice, fireVertices, fireIndices, L"Resources/Fire.fx" };
+		// smaller resources, new SRVs
+		BindMaps();
 
-		// load in maps / textures
-		m_pFireDiffusedMap = Texture::LoadFromFile(m_pDevice, "Resources/fireFX_diffuse.png");
-		m_pFireMesh->GetEffect()->SetDiffusemap(m_pFireDiffusedMap);
+		constexpr double megaByte{ 1024.0 * 1024.0 };
+		const TextureMemoryStats fittedStats{ Texture::GetMemoryStats() };
+		std::cout << "Texture budget: dropped " << nrOfDroppedLevels << " mip levels, " << (fittedStats.cpuBytes + fittedStats.gpuBytes) / megaByte
+			<< " MB of " << m_TextureBudget / megaByte << " MB used\n";
 	}
 }
\ No newline at end of file
@@ -10,16 +10,21 @@ namespace dae
 	class Texture;
 	class VehicleEffect;
 	class FireEffect;
+	class SoftwareRasterizer;
+	class AssetLoader;
+	class ResourceCache;
 
 	template<typename EffectClass>
 	class Mesh;
 
 	enum class FilteringMode;
+	enum class RasterizerMode;
 
 	class Renderer final
 	{
 	public:
 
+		// pWindow can be nullptr for headless rendering (software rasterizer only)
 		explicit Renderer(SDL_Window* pWindow, int width, int height);
 		~Renderer();
 
@@ -31,11 +36,36 @@ namespace dae
 		void ToggleFilteringMode();
 		void ToggleRotating();
 		void ToggleNormalMap();
+		// channel packed vehicle material (2 fetches) vs the 4 separate maps
+		void TogglePackedMaterial();
 		void ToggleFireFX();
+		void ToggleRasterizerMode();
+		void ToggleSoftwareShading();
 
 		void Update(const Timer* const pTimer);
 		void Render() const;
 
+		// Meshes and textures load on worker threads (AssetLoader.h), Update creates the ones that finished.
+		// Until then textures are placeholders and meshes are not drawn.
+		uint32_t GetNrOfLoadingAssets() const;
+		// blocks until every asset is created (headless renders, the saved frame has to be complete)
+		void WaitForAssets();
+		// meshes and textures are shared through a ResourceCache (same file + settings or same content: loaded once),
+		// texture memory (Texture::GetMemoryStats) after it
+		void PrintResourceStats() const;
+		// bytes of CPU + GPU texture memory, 0 = no budget. Over budget the maps give up their top mip levels,
+		// the largest map first (Texture::FitBudget).
+		void SetTextureBudget(size_t budget);
+
+		bool SaveBufferToImage(const std::string& path) const;
+
+		// Software rasterizer: worker threads (0 = one per hardware thread) and per-tile statistics
+		void SetSoftwareThreadCount(uint32_t nrOfThreads);
+		void SetSoftwareGuardBand(float guardBand);
+		void PrintSoftwareStats() const;
+		// renders the current frame again on a single thread with forward shading, prints the pixels that differ
+		bool ValidateSoftware() const;
+
 	private:
 
 		SDL_Window* m_pWindow;
@@ -44,41 +74,74 @@ namespace dae
 		bool m_IsInitialized;
 
 		FilteringMode m_CurrentFileringMode;
+		RasterizerMode m_RasterizerMode;
 
-		// DIRECTX INIT// 
+		// DIRECTX INIT// (m_pDevice stays nullptr without DirectX)
+		ID3D11Device* m_pDevice;
+#ifdef DAE_HAS_DIRECTX
 		HRESULT InitializeDirectX();
 		void ReleaseDirectXResources();
-		ID3D11Device* m_pDevice;
 		ID3D11DeviceContext* m_pDeviceContext;
 		IDXGISwapChain* m_pSwapChain;
 		ID3D11Texture2D* m_pDepthStencilBuffer;
 		ID3D11DepthStencilView* m_pDepthStencilView;
 		ID3D11Resource* m_pRenderTargetBuffer;
 		ID3D11RenderTargetView* m_pRenderTargetView;
+		void RenderDirectX() const;
+#endif
+		////////
+
+		// SOFTWARE //
+		void RenderSoftware() const;
+		SoftwareRasterizer* m_pSoftwareRasterizer;
+		SDL_Surface* m_pBackBuffer;
 		////////
 
 		bool m_ShowFireFX;
 
-		Mesh<VehicleEffect>* m_pVehicleMesh;
-		Mesh<FireEffect>* m_pFireMesh;
+		AssetLoader* m_pAssetLoader;
+		ResourceCache* m_pResourceCache;
+		// shown while the real maps load: mid gray / flat normal, alpha 0 (no specular).
+		// The fire is opaque with it (its blend state is off), so it is only drawn once its own map is in
+		std::shared_ptr<Texture> m_pPlaceholderMap;
+		std::shared_ptr<Texture> m_pPlaceholderNormalMap;
+
+		// handles into m_pResourceCache
+		std::shared_ptr<Mesh<VehicleEffect>> m_pVehicleMesh;
+		std::shared_ptr<Mesh<FireEffect>> m_pFireMesh;
 		Camera* m_pCamera;
 
-		Texture* m_pVechicleDiffusedMap;
-		Texture* m_pNormalMap;
-		Texture* m_pSpecularMap;
-		Texture* m_pGlossinessMap;
+		std::shared_ptr<Texture> m_pVechicleDiffusedMap;
+		std::shared_ptr<Texture> m_pNormalMap;
+		std::shared_ptr<Texture> m_pSpecularMap;
+		std::shared_ptr<Texture> m_pGlossinessMap;
+		std::shared_ptr<Texture> m_pDiffuseGlossMap;
+		std::shared_ptr<Texture> m_pNormalSpecularMap;
+		bool m_UsePackedMaterial;
+
+		std::shared_ptr<Texture> m_pFireDiffusedMap;
 
-		Texture* m_pFireDiffusedMap;
+		// maps holding CPU access for the software rasterizer (sorted), none while the GPU renders
+		std::vector<std::shared_ptr<Texture>> m_CPUAccessMaps;
+		size_t m_TextureBudget;
 
 		bool m_MeshRotating;
 		float m_RotateAngle;
 		const float m_MeshRotationSpeed;
-		Matrix m_TranslationMatrix;
-		Matrix m_RotationMatrix;
+		Vector3 m_Translation;
+		Quaternion m_Rotation;
 		Matrix m_WorldMatrix;
 		Matrix m_WorldViewProjectionMatrix;
+		bool m_IsWorldViewProjectionDirty;
 
 		void InitMesh();
+		// (re)binds the current maps to the effects, after a mesh or a map finished loading
+		void BindMaps() const;
+		// every map and placeholder once, sorted
+		std::vector<std::shared_ptr<Texture>> GetMaps() const;
+		// after a map finished loading and when the rasterizer mode changes
+		void UpdateCPUAccess();
+		void FitTextureBudget();
 	};
 }
 
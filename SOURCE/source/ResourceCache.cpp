@@ -0,0 +1,242 @@
+#include "pch.h"
+#include "ResourceCache.h"
+
+#include <cstring>
+
+namespace dae
+{
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t seed)
+	{
+		// multiply / xor-shift per 8 bytes, the tail zero padded
+		constexpr uint64_t multiplier{ 0x9E3779B97F4A7C15 };
+		const char* pBytes{ static_cast<const char*>(pData) };
+		uint64_t hash{ seed ^ (size * multiplier) };
+
+		size_t offset{};
+		for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+		{
+			uint64_t word{};
+			std::memcpy(&word, pBytes + offset, sizeof(uint64_t));
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 29;
+		}
+
+		uint64_t tail{};
+		if (offset < size) std::memcpy(&tail, pBytes + offset, size - offset);
+		hash = (hash ^ tail) * multiplier;
+		return hash ^ (hash >> 32);
+	}
+
+	ContentHash HashBytes(const void* pData, size_t size, const ContentHash& seed)
+	{
+		// the check hash starts from another seed, a collision of one hash is not a collision of the other
+		constexpr uint64_t checkSeed{ 0xC2B2AE3D27D4EB4F };
+		return ContentHash{ HashBytes(pData, size, seed.hash), HashBytes(pData, size, seed.checkHash ^ checkSeed), seed.size + size };
+	}
+
+	ResourceCache::ResourceCache(size_t budget)
+		: m_Budget{ budget }
+		, m_NextResourceId{ 0 }
+		, m_NrOfHits{ 0 }
+		, m_NrOfContentHits{ 0 }
+		, m_NrOfMisses{ 0 }
+		, m_NrOfEvictions{ 0 }
+		, m_NrOfEvictedBytes{ 0 }
+	{
+	}
+
+	// resources that still have handles outlive the cache
+	ResourceCache::~ResourceCache() = default;
+
+	void ResourceCache::SetBudget(size_t budget)
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Budget = budget;
+		TrimLocked();
+	}
+
+	void ResourceCache::Trim()
+	{
+		const std::lock_guard lock{ m_Mutex };
+		TrimLocked();
+	}
+
+	ResourceCacheStats ResourceCache::GetStats() const
+	{
+		const std::lock_guard lock{ m_Mutex };
+
+		ResourceCacheStats stats{};
+		stats.nrOfResources = m_Resources.size();
+		for (const auto& [id, resource] : m_Resources)
+		{
+			const size_t size{ resource.getMemorySize(resource.pResource.get()) };
+			stats.nrOfBytes += size;
+
+			// the cache holds one reference itself
+			if (resource.pResource.use_count() == 1) continue;
+			++stats.nrOfReferenced;
+			stats.nrOfReferencedBytes += size;
+		}
+		stats.budget = m_Budget;
+		stats.nrOfHits = m_NrOfHits;
+		stats.nrOfContentHits = m_NrOfContentHits;
+		stats.nrOfMisses = m_NrOfMisses;
+		stats.nrOfEvictions = m_NrOfEvictions;
+		stats.nrOfEvictedBytes = m_NrOfEvictedBytes;
+		return stats;
+	}
+
+	void ResourceCache::PrintStats() const
+	{
+		const ResourceCacheStats stats{ GetStats() };
+		constexpr double megaByte{ 1024.0 * 1024.0 };
+
+		std::stringstream ss;
+		ss << "Resource cache: " << stats.nrOfResources << " resources (" << stats.nrOfReferenced << " in use), "
+			<< stats.nrOfBytes / megaByte << " MB of " << stats.budget / megaByte << " MB (" << stats.nrOfReferencedBytes / megaByte << " MB in use), "
+			<< stats.nrOfHits << " hits, " << stats.nrOfContentHits << " content hits, " << stats.nrOfMisses << " misses, "
+			<< stats.nrOfEvictions << " evictions (" << stats.nrOfEvictedBytes / megaByte << " MB)\n";
+
+		const std::lock_guard lock{ m_Mutex };
+
+		// LRU order, the resources at the end are evicted first once nothing holds them
+		std::vector<const Resource*> resources{};
+		resources.reserve(m_Resources.size());
+		for (const auto& [id, resource] : m_Resources) resources.push_back(&resource);
+		std::sort(resources.begin(), resources.end(), [](const Resource* pA, const Resource* pB) { return pA->lastUseTime > pB->lastUseTime; });
+
+		const Clock::time_point now{ Clock::now() };
+		for (const Resource* pResource : resources)
+		{
+			ss << "  " << pResource->keys[0];
+			if (pResource->keys.size() > 1) ss << " (+" << pResource->keys.size() - 1 << " more keys)";
+			ss << ": " << pResource->pResource.use_count() - 1 << " handles, " << pResource->getMemorySize(pResource->pResource.get()) / 1024 << " KB, "
+				<< pResource->nrOfHits << " hits, used " << std::chrono::duration<double>(now - pResource->lastUseTime).count() << " s ago\n";
+		}
+		std::cout << ss.str();
+	}
+
+	std::string ResourceCache::GetCanonicalPath(const std::filesystem::path& path)
+	{
+		std::error_code errorCode{};
+		const std::filesystem::path canonicalPath{ std::filesystem::weakly_canonical(path, errorCode) };
+		return (errorCode ? std::filesystem::absolute(path, errorCode).lexically_normal() : canonicalPath).generic_string();
+	}
+
+	std::shared_ptr<void> ResourceCache::FindResource(const std::string& key, std::type_index type)
+	{
+		const std::lock_guard lock{ m_Mutex };
+
+		const auto keyIt{ m_Keys.find(key) };
+		if (keyIt == m_Keys.end())
+		{
+			++m_NrOfMisses;
+			return nullptr;
+		}
+
+		Resource& resource{ m_Resources.at(keyIt->second) };
+		assert(resource.type == type && "ResourceCache: key cached with another resource type");
+		if (resource.type != type) return nullptr;
+
+		++m_NrOfHits;
+		++resource.nrOfHits;
+		resource.lastUseTime = Clock::now();
+		return resource.pResource;
+	}
+
+	std::shared_ptr<void> ResourceCache::FindResourceContent(const std::string& key, std::type_index type, const ContentHash& contentHash)
+	{
+		const std::lock_guard lock{ m_Mutex };
+
+		// key inserted by another thread since the miss: Insert returns that one
+		if (m_Keys.contains(key)) return nullptr;
+		return FindContentLocked(key, type, contentHash);
+	}
+
+	std::shared_ptr<void> ResourceCache::InsertResource(const std::string& key, std::type_index type, std::shared_ptr<void> pResource,
+		ContentHash(*getContentHash)(const void*), size_t(*getMemorySize)(const void*))
+	{
+		const std::lock_guard lock{ m_Mutex };
+
+		// the same key loaded twice before either was inserted: the first one wins
+		const auto keyIt{ m_Keys.find(key) };
+		if (keyIt != m_Keys.end())
+		{
+			Resource& resource{ m_Resources.at(keyIt->second) };
+			if (resource.type != type) return nullptr;
+
+			++m_NrOfHits;
+			++resource.nrOfHits;
+			resource.lastUseTime = Clock::now();
+			return resource.pResource;
+		}
+
+		// created anyway (the content was not cached yet when it was decoded, or the caller did not look)
+		const ContentHash contentHash{ getContentHash(pResource.get()) };
+		if (std::shared_ptr<void> pCached{ FindContentLocked(key, type, contentHash) }) return pCached;
+
+		const uint64_t id{ m_NextResourceId++ };
+		m_Resources.emplace(id, Resource{ pResource, type, contentHash, getContentHash, getMemorySize, { key }, 0, Clock::now() });
+		m_Keys.emplace(key, id);
+		if (contentHash.size > 0) m_Contents.emplace(contentHash.hash, id);
+
+		TrimLocked();
+		return pResource;
+	}
+
+	std::shared_ptr<void> ResourceCache::FindContentLocked(const std::string& key, std::type_index type, const ContentHash& contentHash)
+	{
+		if (contentHash.size == 0) return nullptr;
+
+		const auto [first, last] { m_Contents.equal_range(contentHash.hash) };
+		for (auto contentIt{ first }; contentIt != last; ++contentIt)
+		{
+			// the whole hash, as the resource is now (it can have changed since it was inserted)
+			Resource& resource{ m_Resources.at(contentIt->second) };
+			if (resource.type != type || resource.getContentHash(resource.pResource.get()) != contentHash) continue;
+
+			++m_NrOfContentHits;
+			resource.keys.push_back(key);
+			resource.lastUseTime = Clock::now();
+			m_Keys.emplace(key, contentIt->second);
+			return resource.pResource;
+		}
+		return nullptr;
+	}
+
+	void ResourceCache::TrimLocked()
+	{
+		size_t nrOfBytes{};
+		std::vector<std::pair<Clock::time_point, uint64_t>> unused{};
+		for (const auto& [id, resource] : m_Resources)
+		{
+			nrOfBytes += resource.getMemorySize(resource.pResource.get());
+			if (resource.pResource.use_count() == 1) unused.emplace_back(resource.lastUseTime, id);
+		}
+		if (nrOfBytes <= m_Budget) return;
+
+		std::sort(unused.begin(), unused.end());
+		for (const auto& [lastUseTime, id] : unused)
+		{
+			if (nrOfBytes <= m_Budget) break;
+
+			const auto resourceIt{ m_Resources.find(id) };
+			const Resource& resource{ resourceIt->second };
+			const size_t size{ resource.getMemorySize(resource.pResource.get()) };
+
+			for (const std::string& key : resource.keys) m_Keys.erase(key);
+			const auto [first, last] { m_Contents.equal_range(resource.contentHash.hash) };
+			for (auto contentIt{ first }; contentIt != last; ++contentIt)
+			{
+				if (contentIt->second != id) continue;
+				m_Contents.erase(contentIt);
+				break;
+			}
+			m_Resources.erase(resourceIt);
+
+			nrOfBytes -= size;
+			++m_NrOfEvictions;
+			m_NrOfEvictedBytes += size;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef RESOURCECACHE_H
+#define RESOURCECACHE_H
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
+namespace dae
+{
+	// 64 bit hash of the bytes (not cryptographic)
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = 0);
+
+	// Identifies decoded textures and meshes: two HashBytes with different seeds and the number of bytes hashed,
+	// content is only shared when all three match. Empty (size 0) is no content, it never matches.
+	struct ContentHash
+	{
+		uint64_t hash;
+		uint64_t checkHash;
+		uint64_t size;
+
+		bool operator==(const ContentHash&) const = default;
+	};
+	// chains like HashBytes: hash the parts one after the other, each with the result of the previous as seed
+	ContentHash HashBytes(const void* pData, size_t size, const ContentHash& seed);
+
+	struct ResourceCacheStats
+	{
+		size_t nrOfResources;
+		size_t nrOfReferenced;      // still held by a handle outside the cache
+		size_t nrOfBytes;
+		size_t nrOfReferencedBytes;
+		size_t budget;
+		uint64_t nrOfHits;          // key found, nothing loaded
+		uint64_t nrOfContentHits;   // decoded under a new key, same content as a cached resource (nothing created)
+		uint64_t nrOfMisses;
+		uint64_t nrOfEvictions;
+		size_t nrOfEvictedBytes;
+	};
+
+	// Textures and meshes shared by everything that uses them. A resource is found by key (canonical path + load settings)
+	// before it is loaded, and by content hash once it is decoded, before the resource is created: the same image under
+	// another path (a copy) is decoded twice but created and uploaded once. Handles are std::shared_ptr. A resource that
+	// no handle holds any more stays cached and is evicted, least recently used first, once the cache is over its memory
+	// budget; resources that are held are never evicted.
+	// ResourceType needs ContentHash GetContentHash() const and size_t GetMemorySize() const. Both can change while
+	// cached (a texture that drops mip levels no longer has the content it was decoded with). Thread safe.
+	class ResourceCache final
+	{
+	public:
+		explicit ResourceCache(size_t budget = size_t{ 256 } << 20);
+		~ResourceCache();
+
+		ResourceCache(const ResourceCache&) = delete;
+		ResourceCache(ResourceCache&&) noexcept = delete;
+		ResourceCache& operator=(const ResourceCache&) = delete;
+		ResourceCache& operator=(ResourceCache&&) noexcept = delete;
+
+		// nullptr when key is not cached (a miss), otherwise the resource is now the most recently used
+		template<typename ResourceType>
+		std::shared_ptr<ResourceType> Find(const std::string& key);
+		// After a miss on key and decoding: the cached resource with this content (key becomes one more name for it),
+		// nullptr when the resource still has to be created
+		template<typename ResourceType>
+		std::shared_ptr<ResourceType> FindContent(const std::string& key, const ContentHash& contentHash);
+		// Adds a freshly loaded resource under key and returns the handle to use: pResource, or the cached resource
+		// with the same content (key becomes one more name for it). Evicts when over budget. nullptr stays nullptr.
+		template<typename ResourceType>
+		std::shared_ptr<ResourceType> Insert(const std::string& key, std::shared_ptr<ResourceType> pResource);
+
+		void SetBudget(size_t budget);
+		// evicts resources without handles, least recently used first, until the cache fits its budget
+		void Trim();
+
+		ResourceCacheStats GetStats() const;
+		// the totals, then every resource from most to least recently used
+		void PrintStats() const;
+
+		// absolute and normalized, symlinks resolved as far as the path exists
+		static std::string GetCanonicalPath(const std::filesystem::path& path);
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Resource
+		{
+			std::shared_ptr<void> pResource;
+			std::type_index type;
+			ContentHash contentHash;             // when inserted, the key in m_Contents
+			ContentHash(*getContentHash)(const void*);
+			size_t(*getMemorySize)(const void*); // sizes can change while cached
+			std::vector<std::string> keys;
+			uint64_t nrOfHits;
+			Clock::time_point lastUseTime;
+		};
+
+		mutable std::mutex m_Mutex;
+		size_t m_Budget;
+		uint64_t m_NextResourceId;
+		std::unordered_map<uint64_t, Resource> m_Resources;
+		std::unordered_map<std::string, uint64_t> m_Keys;
+		std::unordered_multimap<uint64_t, uint64_t> m_Contents; // ContentHash::hash -> resource id
+
+		uint64_t m_NrOfHits;
+		uint64_t m_NrOfContentHits;
+		uint64_t m_NrOfMisses;
+		uint64_t m_NrOfEvictions;
+		size_t m_NrOfEvictedBytes;
+
+		std::shared_ptr<void> FindResource(const std::string& key, std::type_index type);
+		std::shared_ptr<void> FindResourceContent(const std::string& key, std::type_index type, const ContentHash& contentHash);
+		std::shared_ptr<void> InsertResource(const std::string& key, std::type_index type, std::shared_ptr<void> pResource,
+			ContentHash(*getContentHash)(const void*), size_t(*getMemorySize)(const void*));
+		// m_Mutex is locked
+		std::shared_ptr<void> FindContentLocked(const std::string& key, std::type_index type, const ContentHash& contentHash);
+		void TrimLocked();
+	};
+
+	template<typename ResourceType>
+	std::shared_ptr<ResourceType> ResourceCache::Find(const std::string& key)
+	{
+		return std::static_pointer_cast<ResourceType>(FindResource(key, typeid(ResourceType)));
+	}
+
+	template<typename ResourceType>
+	std::shared_ptr<ResourceType> ResourceCache::FindContent(const std::string& key, const ContentHash& contentHash)
+	{
+		return std::static_pointer_cast<ResourceType>(FindResourceContent(key, typeid(ResourceType), contentHash));
+	}
+
+	template<typename ResourceType>
+	std::shared_ptr<ResourceType> ResourceCache::Insert(const std::string& key, std::shared_ptr<ResourceType> pResource)
+	{
+		if (!pResource) return nullptr;
+
+		return std::static_pointer_cast<ResourceType>(InsertResource(key, typeid(ResourceType), std::move(pResource),
+			[](const void* pCached) { return static_cast<const ResourceType*>(pCached)->GetContentHash(); },
+			[](const void* pCached) { return static_cast<const ResourceType*>(pCached)->GetMemorySize(); }));
+	}
+}
+
+#endif // !RESOURCECACHE_H
\ No newline at end of file
@@ -5,6 +5,11 @@
 float4x4 gWorldViewProj : WorldViewProjection;
 Texture2D gDiffuseMap : DiffuseMap;
 
+// compact vertex stream: 16-bit UNORM position / UV quantized to the mesh bounds
+float3 gPositionScale : POSITIONSCALE;
+float3 gPositionOffset : POSITIONOFFSET;
+float4 gUVScaleOffset : UVSCALEOFFSET;
+
 struct VS_INPUT
 {
     float3 Position : POSITION;
@@ -96,14 +101,27 @@ SamplerState gSamAnisotropic
     AddressV = Wrap; // or Mirro, Clamp, Border
 };
 
+// -------------------------------------------------------------------
+//      Vertex Decoding
+// -------------------------------------------------------------------
+float3 DequantizePosition(float3 position)
+{
+    return position * gPositionScale + gPositionOffset;
+}
+
+float2 DequantizeUV(float2 uv)
+{
+    return uv * gUVScaleOffset.xy + gUVScaleOffset.zw;
+}
+
 // -------------------------------------------------------------------
 //      Vertex Shader
 // -------------------------------------------------------------------
 VS_OUTPUT VS(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT) 0;
-    output.Position = mul(float4(input.Position, 1.f), gWorldViewProj);
-    output.UV = input.UV;
+    output.Position = mul(float4(DequantizePosition(input.Position), 1.f), gWorldViewProj);
+    output.UV = DequantizeUV(input.UV);
     return output;
 }
 
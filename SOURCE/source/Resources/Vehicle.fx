@@ -9,6 +9,15 @@ Texture2D gDiffuseMap : DiffuseMap;
 Texture2D gNormalMap : NormalMap;
 Texture2D gSpecularMap : SpecularMap;
 Texture2D gGlossinessMap : GlossinessMap;
+bool gNormalMapIsXY : NormalMapIsXY; // BC5 normal map: only x and y are stored
+// channel packed material (MaterialPacker.h), 2 fetches instead of 4
+Texture2D gDiffuseGlossMap : DiffuseGlossMap; // rgb diffuse, a glossiness
+Texture2D gNormalSpecularMap : NormalSpecularMap; // rgb normal map, a specular intensity
+
+// compact vertex stream: 16-bit UNORM position / UV quantized to the mesh bounds
+float3 gPositionScale : POSITIONSCALE;
+float3 gPositionOffset : POSITIONOFFSET;
+float4 gUVScaleOffset : UVSCALEOFFSET;
 static const float3 gLightDirection = float3(0.577f, -0.577f, 0.577f);
 static const float3 gAmbientColor = float3(0.03f, 0.03f, 0.03f);
 
@@ -25,8 +34,8 @@ struct VS_INPUT
 {
     float3 Position : POSITION;
     float2 UV : TEXCOORD;
-    float3 Normal : NORMAL;
-    float3 Tangent : TANGENT;
+    float2 Normal : NORMAL; // octahedral
+    float2 Tangent : TANGENT; // octahedral
 };
 
 struct VS_OUTPUT
@@ -76,6 +85,17 @@ float3 Lambert(float lightIntensity, float3 diffusedSample)
     return float3(diffusedSample * lightIntensity * gDIV_PI);
 }
 
+// BC5 normal maps only store x and y, z of the unit length normal is rebuilt. Other formats keep their stored z.
+float3 SampleNormalMap(SamplerState samplerState, float2 uv)
+{
+    const float3 normalMapSample = gNormalMap.Sample(samplerState, uv).rgb;
+    if (!gNormalMapIsXY)
+        return normalMapSample;
+    const float2 xy = normalMapSample.rg * 2.f - 1.f;
+    const float z = sqrt(saturate(1.f - dot(xy, xy)));
+    return float3(xy, z) * 0.5f + 0.5f;
+}
+
 float3 Phong(float3 specularColor, float glossiness, float3 lightDirection, float3 vieuwDirction, float3 normal)
 {
     const float cosA = float(dot(reflect(lightDirection, normal.xyz), vieuwDirction));
@@ -84,29 +104,50 @@ float3 Phong(float3 specularColor, float glossiness, float3 lightDirection, floa
     return float3((specularColor * pow(cosA, glossiness)));
 }
 
+// -------------------------------------------------------------------
+//      Vertex Decoding
+// -------------------------------------------------------------------
+float3 DequantizePosition(float3 position)
+{
+    return position * gPositionScale + gPositionOffset;
+}
+
+float2 DequantizeUV(float2 uv)
+{
+    return uv * gUVScaleOffset.xy + gUVScaleOffset.zw;
+}
+
+float3 OctahedralDecode(float2 encoded)
+{
+    float3 direction = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+    const float fold = saturate(-direction.z);
+    direction.xy += (direction.xy >= 0.f) ? -fold : fold;
+    return normalize(direction);
+}
+
 // -------------------------------------------------------------------
 //      Vertex Shader
 // -------------------------------------------------------------------
 VS_OUTPUT VS(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
-    output.Position = mul(float4(input.Position, 1.f), gWorldViewProj);
-    output.WorldPosition = mul(float4(input.Position, 1.f), gWorldMatrix);
-    output.UV = input.UV;
-    output.Normal = mul(float4(input.Normal, 1.f), gWorldMatrix);
-    output.Tangent = mul(float4(input.Tangent, 1.f), gWorldMatrix);
+    const float3 position = DequantizePosition(input.Position);
+    output.Position = mul(float4(position, 1.f), gWorldViewProj);
+    output.WorldPosition = mul(float4(position, 1.f), gWorldMatrix);
+    output.UV = DequantizeUV(input.UV);
+    output.Normal = mul(float4(OctahedralDecode(input.Normal), 1.f), gWorldMatrix);
+    output.Tangent = mul(float4(OctahedralDecode(input.Tangent), 1.f), gWorldMatrix);
     return output;
 }
 
 // -------------------------------------------------------------------
 //      Pixel Shader(s)
 // -------------------------------------------------------------------
-float3 PS_POINT(VS_OUTPUT input) : SV_TARGET
-{   
+float3 Shade(VS_OUTPUT input, float3 diffusedMapSample, float3 normalMapSample, float3 specularMapSample, float glossinessMapSample)
+{
     // Normal
     const float3 biNormal = cross(input.Normal, input.Tangent);
     const float3x3 tangentSpaceAxis = float3x3(input.Tangent, biNormal, input.Normal);
-    float3 normalMapSample = gNormalMap.Sample(gSamPoint, input.UV);
     normalMapSample *= 2.f;
     normalMapSample *= -1.f;
     const float3 normal = mul(normalize(normalMapSample), tangentSpaceAxis);
@@ -115,74 +156,64 @@ float3 PS_POINT(VS_OUTPUT input) : SV_TARGET
     const float observedArea = ObservedArea(normal, gLightDirection);
     
     // Lambert
-    const float3 diffusedMapSample = gDiffuseMap.Sample(gSamPoint, input.UV).rgb;
     const float3 lambert = Lambert(gLightIntensity, diffusedMapSample);
     
     // Viewdirection
     const float3 viewDirection = normalize(input.WorldPosition.xyz - gCameraPos);
     
     // Phong
-    const float3 specularMapSample = gSpecularMap.Sample(gSamPoint, input.UV).rgb;
-    const float glossinessMapSample = gGlossinessMap.Sample(gSamPoint, input.UV).r;
     const float3 specular = Phong(specularMapSample, glossinessMapSample, gLightDirection, viewDirection, normal).rgb;
     
     return float3(gAmbientColor + ((lambert + specular) * observedArea));
 }
 
+// 4 separate maps
+float3 ShadeSeparate(VS_OUTPUT input, SamplerState samplerState)
+{
+    const float3 diffusedMapSample = gDiffuseMap.Sample(samplerState, input.UV).rgb;
+    const float3 normalMapSample = SampleNormalMap(samplerState, input.UV);
+    const float3 specularMapSample = gSpecularMap.Sample(samplerState, input.UV).rgb;
+    const float glossinessMapSample = gGlossinessMap.Sample(samplerState, input.UV).r;
+    return Shade(input, diffusedMapSample, normalMapSample, specularMapSample, glossinessMapSample);
+}
+
+// channel packed maps: the normal keeps its z (BC3 color block), specular is one intensity,
+// the slight colour tint of the specular map is dropped (accepted, see MaterialPacker.h)
+float3 ShadePacked(VS_OUTPUT input, SamplerState samplerState)
+{
+    const float4 diffuseGlossSample = gDiffuseGlossMap.Sample(samplerState, input.UV);
+    const float4 normalSpecularSample = gNormalSpecularMap.Sample(samplerState, input.UV);
+    return Shade(input, diffuseGlossSample.rgb, normalSpecularSample.rgb, normalSpecularSample.aaa, diffuseGlossSample.a);
+}
+
+float3 PS_POINT(VS_OUTPUT input) : SV_TARGET
+{
+    return ShadeSeparate(input, gSamPoint);
+}
+
 float3 PS_LINEAR(VS_OUTPUT input) : SV_TARGET
 {
-    // Normal
-    const float3 biNormal = cross(input.Normal, input.Tangent);
-    const float3x3 tangentSpaceAxis = float3x3(input.Tangent, biNormal, input.Normal);
-    float3 normalMapSample = gNormalMap.Sample(gSamLinear, input.UV);
-    normalMapSample *= 2.f;
-    normalMapSample *= -1.f;
-    const float3 normal = mul(normalize(normalMapSample), tangentSpaceAxis);
-    
-    // OA
-    const float observedArea = ObservedArea(normal, gLightDirection);
-    
-    // Lambert
-    const float3 diffusedMapSample = gDiffuseMap.Sample(gSamLinear, input.UV).rgb;
-    const float3 lambert = Lambert(gLightIntensity, diffusedMapSample);
-    
-    // Viewdirection
-    const float3 viewDirection = normalize(input.WorldPosition.xyz - gCameraPos);
-    
-    // Phong
-    const float3 specularMapSample = gSpecularMap.Sample(gSamLinear, input.UV).rgb;
-    const float glossinessMapSample = gGlossinessMap.Sample(gSamLinear, input.UV).r;
-    const float3 specular = Phong(specularMapSample, glossinessMapSample, gLightDirection, viewDirection, normal).rgb;
-    
-    return float3(gAmbientColor + ((lambert + specular) * observedArea));
+    return ShadeSeparate(input, gSamLinear);
 }
 
 float3 PS_ANISOTROPIC(VS_OUTPUT input) : SV_TARGET
 {
-    // Normal
-    const float3 biNormal = cross(input.Normal, input.Tangent);
-    const float3x3 tangentSpaceAxis = float3x3(input.Tangent, biNormal, input.Normal);
-    float3 normalMapSample = gNormalMap.Sample(gSamAnisotropic, input.UV);
-    normalMapSample *= 2.f;
-    normalMapSample *= -1.f;
-    const float3 normal = mul(normalize(normalMapSample), tangentSpaceAxis);
-    
-    // OA
-    const float observedArea = ObservedArea(normal, gLightDirection);
-    
-    // Lambert
-    const float3 diffusedMapSample = gDiffuseMap.Sample(gSamAnisotropic, input.UV).rgb;
-    const float3 lambert = Lambert(gLightIntensity, diffusedMapSample);
-    
-    // Viewdirection
-    const float3 viewDirection = normalize(input.WorldPosition.xyz - gCameraPos);
-    
-    // Phong
-    const float3 specularMapSample = gSpecularMap.Sample(gSamAnisotropic, input.UV).rgb;
-    const float glossinessMapSample = gGlossinessMap.Sample(gSamAnisotropic, input.UV).r;
-    const float3 specular = Phong(specularMapSample, glossinessMapSample, gLightDirection, viewDirection, normal).rgb;
-    
-    return float3(gAmbientColor + ((lambert + specular) * observedArea));
+    return ShadeSeparate(input, gSamAnisotropic);
+}
+
+float3 PS_POINT_PACKED(VS_OUTPUT input) : SV_TARGET
+{
+    return ShadePacked(input, gSamPoint);
+}
+
+float3 PS_LINEAR_PACKED(VS_OUTPUT input) : SV_TARGET
+{
+    return ShadePacked(input, gSamLinear);
+}
+
+float3 PS_ANISOTROPIC_PACKED(VS_OUTPUT input) : SV_TARGET
+{
+    return ShadePacked(input, gSamAnisotropic);
 }
 
 // -------------------------------------------------------------------
@@ -208,4 +239,23 @@ technique11 DefaultTechnique
         SetGeometryShader(NULL);
         SetPixelShader(CompileShader(ps_5_0, PS_ANISOTROPIC()));
     }
+    // channel packed material, pass index + 3 (VehicleEffect::PackedPassOffset)
+    pass POINT_FILTER_PACKED
+    {
+        SetVertexShader(CompileShader(vs_5_0, VS()));
+        SetGeometryShader(NULL);
+        SetPixelShader(CompileShader(ps_5_0, PS_POINT_PACKED()));
+    }
+    pass LINEAR_FILTER_PACKED
+    {
+        SetVertexShader(CompileShader(vs_5_0, VS()));
+        SetGeometryShader(NULL);
+        SetPixelShader(CompileShader(ps_5_0, PS_LINEAR_PACKED()));
+    }
+    pass ANISOTROPIC_FILTER_PACKED
+    {
+        SetVertexShader(CompileShader(vs_5_0, VS()));
+        SetGeometryShader(NULL);
+        SetPixelShader(CompileShader(ps_5_0, PS_ANISOTROPIC_PACKED()));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,781 @@
+#include "pch.h"
+#include "SoftwareRasterizer.h"
+#include "MaterialPacker.h"
+#include "RasterKernel.h"
+#include "Texture.h"
+#include "TextureSampler.h"
+#include "TileScheduler.h"
+#include "VectorN.h"
+#include "VehicleShader.h"
+
+#include <bit>
+#include <chrono>
+
+namespace dae
+{
+	namespace
+	{
+		// empty pixel in the visibility buffer
+		constexpr uint32_t g_NoTriangle{ UINT32_MAX };
+
+		// triangle + near, far and the 4 guard band planes
+		constexpr int g_MaxClipVertices{ 9 };
+
+		// Vertex_Out attributes interpolated for the pixel shader: world position, uv, normal, tangent
+		constexpr int g_NrOfAttributes{ 11 };
+
+		// clip space attributes are linear, so perspective correct interpolation still holds after clipping
+		inline Vertex_Out Lerp(const Vertex_Out& a, const Vertex_Out& b, float t)
+		{
+			Vertex_Out result{};
+			result.position = a.position + (b.position - a.position) * t;
+			result.worldPosition = a.worldPosition + (b.worldPosition - a.worldPosition) * t;
+			result.uv = a.uv + (b.uv - a.uv) * t;
+			result.normal = a.normal + (b.normal - a.normal) * t;
+			result.tangent = a.tangent + (b.tangent - a.tangent) * t;
+			return result;
+		}
+
+		inline uint32_t ToARGB(const ColorRGB& color)
+		{
+			return 0xFF000000u
+				| (static_cast<uint32_t>(Saturate(color.r) * 255.f) << 16)
+				| (static_cast<uint32_t>(Saturate(color.g) * 255.f) << 8)
+				| static_cast<uint32_t>(Saturate(color.b) * 255.f);
+		}
+
+		// 8x8 block coverage bits of the block relative pixel rect [minX, maxX] x [minY, maxY]
+		inline uint64_t GetBlockMask(int minX, int minY, int maxX, int maxY)
+		{
+			const uint64_t rowMask{ (0xFFull >> (EdgeTriangle::BlockSize - 1 - maxX)) & (0xFFull << minX) };
+			uint64_t mask{};
+			for (int row{ minY }; row <= maxY; ++row) mask |= rowMask << (row * EdgeTriangle::BlockSize);
+			return mask;
+		}
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer(int width, int height, uint32_t nrOfThreads)
+		: m_Width{ width }
+		, m_Height{ height }
+		, m_NrOfTilesX{ (width + TileSize - 1) / TileSize }
+		, m_NrOfTilesY{ (height + TileSize - 1) / TileSize }
+		, m_NrOfBlocksX{ (width + EdgeTriangle::BlockSize - 1) / EdgeTriangle::BlockSize }
+		, m_NrOfBlocksY{ (height + EdgeTriangle::BlockSize - 1) / EdgeTriangle::BlockSize }
+		, m_ColorBuffer(static_cast<size_t>(width) * height)
+		, m_DepthBuffer(static_cast<size_t>(width) * height)
+		, m_BlockMinDepth(static_cast<size_t>(m_NrOfBlocksX) * m_NrOfBlocksY)
+		, m_BlockMaxDepth(static_cast<size_t>(m_NrOfBlocksX) * m_NrOfBlocksY)
+		, m_VisibilityBuffer(static_cast<size_t>(width) * height)
+		, m_Shading{ SoftwareShading::Forward }
+		, m_ClearColor{ ToARGB(colors::Black) }
+		, m_TileBins(static_cast<size_t>(m_NrOfTilesX) * m_NrOfTilesY)
+		, m_TileStats(static_cast<size_t>(m_NrOfTilesX) * m_NrOfTilesY)
+		, m_pScheduler{ std::make_unique<TileScheduler>(nrOfThreads) }
+		, m_GuardBand{ 1.f }
+		, m_ClipStats{}
+		, m_CameraPosition{ Vector3::Zero }
+	{
+		SetGuardBand(8.f);
+	}
+
+	SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+	void SoftwareRasterizer::Clear(const ColorRGB& backgroundColor)
+	{
+		m_ClearColor = ToARGB(backgroundColor);
+
+		m_VerticesOut.clear();
+		m_DrawCalls.clear();
+		m_Triangles.clear();
+		for (std::vector<uint32_t>& bin : m_TileBins) bin.clear();
+		m_ClipStats = SoftwareClipStats{};
+	}
+
+	void SoftwareRasterizer::SetCameraPosition(const Vector3& cameraPosition)
+	{
+		m_CameraPosition = cameraPosition;
+	}
+
+	void SoftwareRasterizer::Draw(std::span<const Vertex> vertices, std::span<const uint32_t> indices, const Matrix& worldMatrix,
+		const Matrix& worldViewProjectionMatrix, const SoftwareMaterial& material, FilteringMode filteringMode)
+	{
+		const uint32_t drawIdx{ static_cast<uint32_t>(m_DrawCalls.size()) };
+		m_DrawCalls.push_back(DrawCall{ material, filteringMode });
+
+		const uint32_t firstVertex{ static_cast<uint32_t>(m_VerticesOut.size()) };
+		TransformVertices(vertices, worldMatrix, worldViewProjectionMatrix, firstVertex);
+
+		// D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST
+		ClipAndCullTriangles(indices.first(indices.size() / 3 * 3), firstVertex, drawIdx);
+	}
+
+	void SoftwareRasterizer::Flush()
+	{
+		const uint32_t nrOfTiles{ static_cast<uint32_t>(m_TileBins.size()) };
+		m_pScheduler->Run(nrOfTiles, [this](uint32_t tileIdx, uint32_t workerIdx) { RenderTile(tileIdx, workerIdx); });
+	}
+
+	void SoftwareRasterizer::SetNrOfThreads(uint32_t nrOfThreads)
+	{
+		if (nrOfThreads == 0) nrOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		if (nrOfThreads == m_pScheduler->GetNrOfThreads()) return;
+
+		m_pScheduler = std::make_unique<TileScheduler>(nrOfThreads);
+	}
+
+	uint32_t SoftwareRasterizer::GetNrOfThreads() const
+	{
+		return m_pScheduler->GetNrOfThreads();
+	}
+
+	void SoftwareRasterizer::SetShading(SoftwareShading shading)
+	{
+		m_Shading = shading;
+	}
+
+	SoftwareShading SoftwareRasterizer::GetShading() const
+	{
+		return m_Shading;
+	}
+
+	void SoftwareRasterizer::SetGuardBand(float guardBand)
+	{
+		// screen x = (ndc x + 1) * width / 2 has to stay inside the edge function range
+		const float maxGuardBand{ 2.f * EdgeTriangle::MaxCoordinate / std::max(m_Width, m_Height) - 1.f };
+		m_GuardBand = std::clamp(guardBand, 1.f, maxGuardBand);
+	}
+
+	float SoftwareRasterizer::GetGuardBand() const
+	{
+		return m_GuardBand;
+	}
+
+	int SoftwareRasterizer::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int SoftwareRasterizer::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	uint32_t* SoftwareRasterizer::GetColorBuffer()
+	{
+		return m_ColorBuffer.data();
+	}
+
+	const uint32_t* SoftwareRasterizer::GetColorBuffer() const
+	{
+		return m_ColorBuffer.data();
+	}
+
+	int SoftwareRasterizer::GetNrOfTilesX() const
+	{
+		return m_NrOfTilesX;
+	}
+
+	int SoftwareRasterizer::GetNrOfTilesY() const
+	{
+		return m_NrOfTilesY;
+	}
+
+	std::span<const SoftwareTileStats> SoftwareRasterizer::GetTileStats() const
+	{
+		return m_TileStats;
+	}
+
+	const SoftwareClipStats& SoftwareRasterizer::GetClipStats() const
+	{
+		return m_ClipStats;
+	}
+
+	void SoftwareRasterizer::PrintStats() const
+	{
+		uint64_t nrOfBinnedTriangles{};
+		uint64_t nrOfFragments{};
+		uint64_t nrOfShadedPixels{};
+		uint64_t nrOfRejectedTriangles{};
+		uint64_t nrOfBlocks{};
+		uint64_t nrOfRejectedBlocks{};
+		uint64_t nrOfAcceptedBlocks{};
+		float totalTimeMs{};
+		float maxTimeMs{};
+		std::vector<uint32_t> tilesPerWorker(GetNrOfThreads());
+		for (const SoftwareTileStats& tileStats : m_TileStats)
+		{
+			nrOfBinnedTriangles += tileStats.nrOfTriangles;
+			nrOfFragments += tileStats.nrOfFragments;
+			nrOfShadedPixels += tileStats.nrOfShadedPixels;
+			nrOfRejectedTriangles += tileStats.nrOfRejectedTriangles;
+			nrOfBlocks += tileStats.nrOfBlocks;
+			nrOfRejectedBlocks += tileStats.nrOfRejectedBlocks;
+			nrOfAcceptedBlocks += tileStats.nrOfAcceptedBlocks;
+			totalTimeMs += tileStats.timeMs;
+			maxTimeMs = std::max(maxTimeMs, tileStats.timeMs);
+			if (tileStats.workerIdx < tilesPerWorker.size()) ++tilesPerWorker[tileStats.workerIdx];
+		}
+
+		std::cout << "Software rasterizer: " << m_NrOfTilesX << "x" << m_NrOfTilesY << " tiles of " << TileSize << "x" << TileSize
+			<< ", " << GetNrOfThreads() << " thread(s), " << m_pScheduler->GetNrOfSteals() << " steals\n";
+		std::cout << "  Clip / cull: " << m_ClipStats.nrOfTriangles << " in, " << m_ClipStats.nrOfFrustumCulled << " frustum, "
+			<< m_ClipStats.nrOfBackFaceCulled << " back-face, " << m_ClipStats.nrOfZeroAreaCulled << " zero area culled, " << m_ClipStats.nrOfClipped
+			<< " clipped into " << m_ClipStats.nrOfClippedTriangles << " (guard band " << m_GuardBand << "x)\n";
+		std::cout << "  Triangles: " << m_Triangles.size() << " set up, " << nrOfBinnedTriangles << " binned ("
+			<< static_cast<float>(nrOfBinnedTriangles) / m_TileStats.size() << " per tile)\n";
+		std::cout << "  Hierarchical Z: " << nrOfRejectedTriangles << " binned triangles rejected, " << nrOfRejectedBlocks << " of " << nrOfBlocks
+			<< " blocks rejected, " << nrOfAcceptedBlocks << " trivially accepted\n";
+		std::cout << "  Shading: " << (m_Shading == SoftwareShading::VisibilityBuffer ? "visibility buffer" : "forward") << ", "
+			<< nrOfShadedPixels << " shaded pixels, " << nrOfFragments << " depth test passes (forward shades every one, "
+			<< static_cast<float>(nrOfFragments) / std::max(nrOfShadedPixels, uint64_t{ 1 }) << "x)\n";
+		std::cout << "  Tile time: " << totalTimeMs / m_TileStats.size() << " ms average, " << maxTimeMs << " ms max, " << totalTimeMs << " ms total\n";
+		std::cout << "  Tiles per worker:";
+		for (const uint32_t nrOfTiles : tilesPerWorker) std::cout << " " << nrOfTiles;
+		std::cout << "\n";
+	}
+
+	void SoftwareRasterizer::TransformVertices(std::span<const Vertex> vertices, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, size_t firstVertex)
+	{
+		// same as VS() in Vehicle.fx / Fire.fx, batched straight from / into the interleaved vertices
+		m_VerticesOut.resize(firstVertex + vertices.size());
+		if (vertices.empty()) return;
+
+		const size_t nrOfVertices{ vertices.size() };
+		const Vertex* pVertices{ vertices.data() };
+		Vertex_Out* pVerticesOut{ m_VerticesOut.data() + firstVertex };
+		worldViewProjectionMatrix.TransformPoints(&pVertices->position, sizeof(Vertex), &pVerticesOut->position, sizeof(Vertex_Out), nrOfVertices);
+		worldMatrix.TransformPoints(&pVertices->position, sizeof(Vertex), &pVerticesOut->worldPosition, sizeof(Vertex_Out), nrOfVertices);
+		worldMatrix.TransformVectors(&pVertices->normal, sizeof(Vertex), &pVerticesOut->normal, sizeof(Vertex_Out), nrOfVertices);
+		worldMatrix.TransformVectors(&pVertices->tangent, sizeof(Vertex), &pVerticesOut->tangent, sizeof(Vertex_Out), nrOfVertices);
+
+		for (size_t idx{}; idx < nrOfVertices; ++idx)
+		{
+			pVerticesOut[idx].uv = pVertices[idx].uv;
+		}
+	}
+
+	void SoftwareRasterizer::ClipAndCullTriangles(std::span<const uint32_t> indices, uint32_t firstVertex, uint32_t drawIdx)
+	{
+		constexpr int batchSize{ Float8::NrOfLanes };
+
+		// Vehicle.fx uses the default rasterizer state (cull back), Fire.fx sets CullMode = none
+		const bool cullBackFaces{ m_DrawCalls[drawIdx].material.shader == SoftwareShader::Vehicle };
+		const Float8 zero{ Float8::Broadcast(0.f) };
+		const Float8 guardBand{ Float8::Broadcast(m_GuardBand) };
+
+		const size_t nrOfTriangles{ indices.size() / 3 };
+		m_ClipStats.nrOfTriangles += static_cast<uint32_t>(nrOfTriangles);
+
+		// 8 triangles at a time, one per lane
+		for (size_t firstTriangle{}; firstTriangle < nrOfTriangles; firstTriangle += batchSize)
+		{
+			const int count{ static_cast<int>(std::min<size_t>(batchSize, nrOfTriangles - firstTriangle)) };
+
+			uint32_t vertexIdx[3][batchSize];
+			alignas(32) float lanes[3][4][batchSize];
+			for (int lane{}; lane < batchSize; ++lane)
+			{
+				const size_t triangleIdx{ firstTriangle + std::min(lane, count - 1) };
+				for (int corner{}; corner < 3; ++corner)
+				{
+					vertexIdx[corner][lane] = firstVertex + indices[triangleIdx * 3 + corner];
+					const Vector4& position{ m_VerticesOut[vertexIdx[corner][lane]].position };
+					for (int component{}; component < 4; ++component) lanes[corner][component][lane] = position[component];
+				}
+			}
+
+			Vector4x8 positions[3];
+			for (int corner{}; corner < 3; ++corner)
+			{
+				positions[corner] = { Float8::Load(lanes[corner][0]), Float8::Load(lanes[corner][1]), Float8::Load(lanes[corner][2]), Float8::Load(lanes[corner][3]) };
+			}
+
+			// Frustum culling: all three vertices outside the same plane
+			Float8 outside[6];
+			Float8 needsClipping{ zero };
+			for (int corner{}; corner < 3; ++corner)
+			{
+				const Vector4x8& position{ positions[corner] };
+				const Float8 planeOutside[6]{
+					position.x < -position.w, position.x > position.w,
+					position.y < -position.w, position.y > position.w,
+					position.z < zero, position.z > position.w };
+				for (int plane{}; plane < 6; ++plane) outside[plane] = corner == 0 ? planeOutside[plane] : outside[plane] & planeOutside[plane];
+
+				// near / far plane, or outside the guard band
+				const Float8 guardBandW{ guardBand * position.w };
+				needsClipping = needsClipping | (position.z < zero) | (position.z > position.w) | (Abs(position.x) > guardBandW) | (Abs(position.y) > guardBandW);
+			}
+			const Float8 isCulled{ outside[0] | outside[1] | outside[2] | outside[3] | outside[4] | outside[5] };
+
+			// Orientation: the screen area has the opposite sign of the determinant of (x, y, w) when every w > 0
+			const Vector4x8& p0{ positions[0] };
+			const Vector4x8& p1{ positions[1] };
+			const Vector4x8& p2{ positions[2] };
+			const Float8 determinant{
+				p0.x * (p1.y * p2.w - p1.w * p2.y)
+				- p0.y * (p1.x * p2.w - p1.w * p2.x)
+				+ p0.w * (p1.x * p2.y - p1.y * p2.x) };
+
+			const uint32_t culledBits{ GetMaskBits(isCulled) };
+			const uint32_t clipBits{ GetMaskBits(needsClipping) & ~culledBits };
+			const uint32_t zeroAreaBits{ GetMaskBits((determinant >= zero) & (determinant <= zero)) };
+			const uint32_t backFaceBits{ cullBackFaces ? GetMaskBits(determinant > zero) : 0u };
+
+			for (int lane{}; lane < count; ++lane)
+			{
+				const uint32_t laneBit{ 1u << lane };
+				if (culledBits & laneBit) ++m_ClipStats.nrOfFrustumCulled;
+				else if (clipBits & laneBit) ClipTriangle(vertexIdx[0][lane], vertexIdx[1][lane], vertexIdx[2][lane], drawIdx);
+				else if (zeroAreaBits & laneBit) ++m_ClipStats.nrOfZeroAreaCulled;
+				else if (backFaceBits & laneBit) ++m_ClipStats.nrOfBackFaceCulled;
+				else SetupTriangle(vertexIdx[0][lane], vertexIdx[1][lane], vertexIdx[2][lane], drawIdx);
+			}
+		}
+	}
+
+	void SoftwareRasterizer::ClipTriangle(uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t vertexIdx2, uint32_t drawIdx)
+	{
+		// Sutherland-Hodgman in homogeneous clip space, dot(plane, position) >= 0 is inside
+		const Vector4 planes[6]{
+			{ 0.f, 0.f, 1.f, 0.f },          // near: z >= 0
+			{ 0.f, 0.f, -1.f, 1.f },         // far: z <= w
+			{ 1.f, 0.f, 0.f, m_GuardBand },  // guard band: |x| <= guardBand * w
+			{ -1.f, 0.f, 0.f, m_GuardBand },
+			{ 0.f, 1.f, 0.f, m_GuardBand },  // |y| <= guardBand * w
+			{ 0.f, -1.f, 0.f, m_GuardBand },
+		};
+
+		Vertex_Out polygon[2][g_MaxClipVertices];
+		int nrOfVertices{ 3 };
+		polygon[0][0] = m_VerticesOut[vertexIdx0];
+		polygon[0][1] = m_VerticesOut[vertexIdx1];
+		polygon[0][2] = m_VerticesOut[vertexIdx2];
+
+		int current{};
+		for (const Vector4& plane : planes)
+		{
+			float distances[g_MaxClipVertices];
+			bool isOutside{ false };
+			for (int idx{}; idx < nrOfVertices; ++idx)
+			{
+				distances[idx] = Vector4::Dot(plane, polygon[current][idx].position);
+				isOutside |= distances[idx] < 0.f;
+			}
+			if (!isOutside) continue;
+
+			const Vertex_Out* pInput{ polygon[current] };
+			Vertex_Out* pOutput{ polygon[1 - current] };
+			int nrOfOutputVertices{};
+			for (int idx{}; idx < nrOfVertices; ++idx)
+			{
+				const int nextIdx{ (idx + 1) % nrOfVertices };
+				const bool isInside{ distances[idx] >= 0.f };
+				if (isInside) pOutput[nrOfOutputVertices++] = pInput[idx];
+				if (isInside != (distances[nextIdx] >= 0.f))
+				{
+					const float t{ distances[idx] / (distances[idx] - distances[nextIdx]) };
+					pOutput[nrOfOutputVertices++] = Lerp(pInput[idx], pInput[nextIdx], t);
+				}
+			}
+
+			current = 1 - current;
+			nrOfVertices = nrOfOutputVertices;
+			if (nrOfVertices < 3)
+			{
+				++m_ClipStats.nrOfFrustumCulled;
+				return;
+			}
+		}
+
+		// Triangle fan, same winding as the input triangle
+		++m_ClipStats.nrOfClipped;
+		m_ClipStats.nrOfClippedTriangles += nrOfVertices - 2;
+
+		const uint32_t firstVertex{ static_cast<uint32_t>(m_VerticesOut.size()) };
+		m_VerticesOut.insert(m_VerticesOut.end(), polygon[current], polygon[current] + nrOfVertices);
+		for (int idx{ 1 }; idx + 1 < nrOfVertices; ++idx)
+		{
+			SetupTriangle(firstVertex, firstVertex + idx, firstVertex + idx + 1, drawIdx);
+		}
+	}
+
+	void SoftwareRasterizer::SetupTriangle(uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t vertexIdx2, uint32_t drawIdx)
+	{
+		Triangle triangle{};
+		triangle.vertexIdx[0] = vertexIdx0;
+		triangle.vertexIdx[1] = vertexIdx1;
+		triangle.vertexIdx[2] = vertexIdx2;
+		triangle.drawIdx = drawIdx;
+
+		// Perspective divide + viewport transform, the clip stage keeps w > 0 and the guard band in range
+		Vector2 screen[3];
+		for (int idx{}; idx < 3; ++idx)
+		{
+			const Vector4& position{ m_VerticesOut[triangle.vertexIdx[idx]].position };
+			triangle.invW[idx] = 1.f / position.w;
+			screen[idx] = Vector2{ (position.x * triangle.invW[idx] + 1.f) * 0.5f * m_Width, (1.f - position.y * triangle.invW[idx]) * 0.5f * m_Height };
+			triangle.depth[idx] = position.z * triangle.invW[idx];
+		}
+
+		// Area of the snapped triangle, so culling and rasterization agree on degenerate triangles
+		int64_t area{ triangle.edges.Setup(screen) };
+
+		// Vehicle.fx uses the default rasterizer state (cull back), Fire.fx sets CullMode = none
+		const bool cullBackFaces{ m_DrawCalls[drawIdx].material.shader == SoftwareShader::Vehicle };
+		if (area == 0)
+		{
+			++m_ClipStats.nrOfZeroAreaCulled;
+			return;
+		}
+		if (cullBackFaces && area < 0)
+		{
+			++m_ClipStats.nrOfBackFaceCulled;
+			return;
+		}
+
+		// make back faces clockwise so the edge tests below hold for both windings
+		if (area < 0)
+		{
+			std::swap(triangle.vertexIdx[1], triangle.vertexIdx[2]);
+			std::swap(screen[1], screen[2]);
+			std::swap(triangle.depth[1], triangle.depth[2]);
+			std::swap(triangle.invW[1], triangle.invW[2]);
+			area = triangle.edges.Setup(screen);
+		}
+		triangle.invArea = 1.f / static_cast<float>(area);
+		triangle.minDepth = std::min({ triangle.depth[0], triangle.depth[1], triangle.depth[2] });
+		triangle.maxDepth = std::max({ triangle.depth[0], triangle.depth[1], triangle.depth[2] });
+
+		// Bounding box, clamped to the screen
+		const float minX{ std::max(0.f, std::min({ screen[0].x, screen[1].x, screen[2].x })) };
+		const float minY{ std::max(0.f, std::min({ screen[0].y, screen[1].y, screen[2].y })) };
+		const float maxX{ std::min(static_cast<float>(m_Width), std::max({ screen[0].x, screen[1].x, screen[2].x })) };
+		const float maxY{ std::min(static_cast<float>(m_Height), std::max({ screen[0].y, screen[1].y, screen[2].y })) };
+		if (minX >= maxX || minY >= maxY)
+		{
+			++m_ClipStats.nrOfFrustumCulled;
+			return;
+		}
+
+		triangle.minX = static_cast<int>(minX);
+		triangle.minY = static_cast<int>(minY);
+		triangle.maxX = std::min(m_Width - 1, static_cast<int>(maxX));
+		triangle.maxY = std::min(m_Height - 1, static_cast<int>(maxY));
+
+		m_Triangles.push_back(triangle);
+		BinTriangle(static_cast<uint32_t>(m_Triangles.size() - 1));
+	}
+
+	void SoftwareRasterizer::BinTriangle(uint32_t triangleIdx)
+	{
+		// every tile the bounding box touches, in submission order
+		const Triangle& triangle{ m_Triangles[triangleIdx] };
+		const int firstTileX{ triangle.minX / TileSize };
+		const int firstTileY{ triangle.minY / TileSize };
+		const int lastTileX{ triangle.maxX / TileSize };
+		const int lastTileY{ triangle.maxY / TileSize };
+		for (int tileY{ firstTileY }; tileY <= lastTileY; ++tileY)
+		{
+			for (int tileX{ firstTileX }; tileX <= lastTileX; ++tileX)
+			{
+				m_TileBins[tileY * m_NrOfTilesX + tileX].push_back(triangleIdx);
+			}
+		}
+	}
+
+	void SoftwareRasterizer::RenderTile(uint32_t tileIdx, uint32_t workerIdx)
+	{
+		const auto startTime{ std::chrono::steady_clock::now() };
+
+		const int tileMinX{ static_cast<int>(tileIdx % m_NrOfTilesX) * TileSize };
+		const int tileMinY{ static_cast<int>(tileIdx / m_NrOfTilesX) * TileSize };
+		const int tileMaxX{ std::min(tileMinX + TileSize, m_Width) - 1 };
+		const int tileMaxY{ std::min(tileMinY + TileSize, m_Height) - 1 };
+
+		//1. CLEAR COLOR & DEPTH (only the pixels of this tile)
+		for (int py{ tileMinY }; py <= tileMaxY; ++py)
+		{
+			const size_t rowStart{ static_cast<size_t>(py) * m_Width };
+			std::fill(m_ColorBuffer.begin() + rowStart + tileMinX, m_ColorBuffer.begin() + rowStart + tileMaxX + 1, m_ClearColor);
+			std::fill(m_DepthBuffer.begin() + rowStart + tileMinX, m_DepthBuffer.begin() + rowStart + tileMaxX + 1, 1.f);
+			if (m_Shading == SoftwareShading::VisibilityBuffer)
+			{
+				std::fill(m_VisibilityBuffer.begin() + rowStart + tileMinX, m_VisibilityBuffer.begin() + rowStart + tileMaxX + 1, g_NoTriangle);
+			}
+		}
+
+		constexpr int blockSize{ EdgeTriangle::BlockSize };
+		const int firstBlockX{ tileMinX / blockSize };
+		const int firstBlockY{ tileMinY / blockSize };
+		const int lastBlockX{ tileMaxX / blockSize };
+		const int lastBlockY{ tileMaxY / blockSize };
+		for (int blockY{ firstBlockY }; blockY <= lastBlockY; ++blockY)
+		{
+			const size_t rowStart{ static_cast<size_t>(blockY) * m_NrOfBlocksX };
+			std::fill(m_BlockMinDepth.begin() + rowStart + firstBlockX, m_BlockMinDepth.begin() + rowStart + lastBlockX + 1, 1.f);
+			std::fill(m_BlockMaxDepth.begin() + rowStart + firstBlockX, m_BlockMaxDepth.begin() + rowStart + lastBlockX + 1, 1.f);
+		}
+
+		//2. RASTERIZE THE BINNED TRIANGLES, in submission order
+		const std::vector<uint32_t>& bin{ m_TileBins[tileIdx] };
+		SoftwareTileStats& tileStats{ m_TileStats[tileIdx] };
+		tileStats = SoftwareTileStats{};
+
+		FragmentPacket packet{};
+		float tileMaxDepth{ 1.f };
+		for (const uint32_t triangleIdx : bin)
+		{
+			// Hierarchical Z: the whole triangle is behind everything in the tile
+			const Triangle& triangle{ m_Triangles[triangleIdx] };
+			if (triangle.minDepth >= tileMaxDepth)
+			{
+				++tileStats.nrOfRejectedTriangles;
+				continue;
+			}
+
+			if (!RasterizeTriangle(triangleIdx, tileMinX, tileMinY, tileMaxX, tileMaxY, packet, tileStats)) continue;
+
+			tileMaxDepth = 0.f;
+			for (int blockY{ firstBlockY }; blockY <= lastBlockY; ++blockY)
+			{
+				const auto rowStart{ m_BlockMaxDepth.begin() + static_cast<size_t>(blockY) * m_NrOfBlocksX };
+				tileMaxDepth = std::max(tileMaxDepth, *std::max_element(rowStart + firstBlockX, rowStart + lastBlockX + 1));
+			}
+		}
+
+		//3. SHADE THE VISIBLE PIXELS (visibility buffer)
+		if (m_Shading == SoftwareShading::VisibilityBuffer) ShadeVisibilityBuffer(tileMinX, tileMinY, tileMaxX, tileMaxY, packet, tileStats);
+		if (packet.count != 0) ShadePacket(packet);
+
+		tileStats.nrOfTriangles = static_cast<uint32_t>(bin.size());
+		tileStats.workerIdx = workerIdx;
+		tileStats.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	bool SoftwareRasterizer::RasterizeTriangle(uint32_t triangleIdx, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, FragmentPacket& packet, SoftwareTileStats& tileStats)
+	{
+		constexpr int blockSize{ EdgeTriangle::BlockSize };
+
+		const Triangle& triangle{ m_Triangles[triangleIdx] };
+		const float* depth{ triangle.depth };
+		const bool isDeferred{ m_Shading == SoftwareShading::VisibilityBuffer };
+
+		// Bounding box, clamped to the tile
+		const int startX{ std::max(triangle.minX, tileMinX) };
+		const int startY{ std::max(triangle.minY, tileMinY) };
+		const int endX{ std::min(triangle.maxX, tileMaxX) };
+		const int endY{ std::min(triangle.maxY, tileMaxY) };
+
+		// 8x8 blocks, tiles are a multiple of the block size
+		bool hasWrittenDepth{ false };
+		for (int blockY{ startY & ~(blockSize - 1) }; blockY <= endY; blockY += blockSize)
+		{
+			for (int blockX{ startX & ~(blockSize - 1) }; blockX <= endX; blockX += blockSize)
+			{
+				++tileStats.nrOfBlocks;
+
+				// Hierarchical Z: behind the farthest depth in the block, or in front of the nearest one
+				const size_t blockIdx{ static_cast<size_t>(blockY / blockSize) * m_NrOfBlocksX + blockX / blockSize };
+				if (triangle.minDepth >= m_BlockMaxDepth[blockIdx])
+				{
+					++tileStats.nrOfRejectedBlocks;
+					continue;
+				}
+				const bool isInFront{ triangle.maxDepth < m_BlockMinDepth[blockIdx] };
+
+				uint64_t coverage{ RasterizeBlock(triangle.edges, blockX, blockY) };
+				if (coverage == 0) continue;
+				if (isInFront) ++tileStats.nrOfAcceptedBlocks;
+
+				coverage &= GetBlockMask(std::max(startX - blockX, 0), std::max(startY - blockY, 0),
+					std::min(endX - blockX, blockSize - 1), std::min(endY - blockY, blockSize - 1));
+
+				float blockMinDepth{ m_BlockMinDepth[blockIdx] };
+				bool hasWrittenBlock{ false };
+
+				while (coverage != 0)
+				{
+					const int bitIdx{ std::countr_zero(coverage) };
+					coverage &= coverage - 1;
+					const int px{ blockX + bitIdx % blockSize };
+					const int py{ blockY + bitIdx / blockSize };
+
+					float weights[3];
+					triangle.GetWeights(px, py, weights);
+
+					// Depth test (DepthFunc = less), clamped to the vertex depths so the block bounds above hold exactly
+					const float pixelDepth{ std::clamp(weights[0] * depth[0] + weights[1] * depth[1] + weights[2] * depth[2], triangle.minDepth, triangle.maxDepth) };
+					const int pixelIdx{ py * m_Width + px };
+					if (!isInFront && pixelDepth >= m_DepthBuffer[pixelIdx]) continue;
+					m_DepthBuffer[pixelIdx] = pixelDepth;
+					blockMinDepth = std::min(blockMinDepth, pixelDepth);
+					hasWrittenBlock = true;
+					++tileStats.nrOfFragments;
+
+					if (isDeferred)
+					{
+						m_VisibilityBuffer[pixelIdx] = triangleIdx;
+						continue;
+					}
+					AddFragment(packet, triangleIdx, pixelIdx, weights);
+					++tileStats.nrOfShadedPixels;
+				}
+
+				if (hasWrittenBlock)
+				{
+					m_BlockMinDepth[blockIdx] = blockMinDepth;
+					m_BlockMaxDepth[blockIdx] = GetBlockMaxDepth(blockX, blockY);
+					hasWrittenDepth = true;
+				}
+			}
+		}
+		return hasWrittenDepth;
+	}
+
+	float SoftwareRasterizer::GetBlockMaxDepth(int blockX, int blockY) const
+	{
+		const int endX{ std::min(blockX + EdgeTriangle::BlockSize, m_Width) };
+		const int endY{ std::min(blockY + EdgeTriangle::BlockSize, m_Height) };
+
+		float maxDepth{ 0.f };
+		for (int py{ blockY }; py < endY; ++py)
+		{
+			const float* pRow{ m_DepthBuffer.data() + static_cast<size_t>(py) * m_Width };
+			for (int px{ blockX }; px < endX; ++px) maxDepth = std::max(maxDepth, pRow[px]);
+		}
+		return maxDepth;
+	}
+
+	void SoftwareRasterizer::ShadeVisibilityBuffer(int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, FragmentPacket& packet, SoftwareTileStats& tileStats)
+	{
+		// barycentrics are reconstructed from the stored triangle, same values as during rasterization
+		for (int py{ tileMinY }; py <= tileMaxY; ++py)
+		{
+			for (int px{ tileMinX }; px <= tileMaxX; ++px)
+			{
+				const int pixelIdx{ py * m_Width + px };
+				const uint32_t triangleIdx{ m_VisibilityBuffer[pixelIdx] };
+				if (triangleIdx == g_NoTriangle) continue;
+
+				const Triangle& triangle{ m_Triangles[triangleIdx] };
+				float weights[3];
+				triangle.GetWeights(px, py, weights);
+
+				AddFragment(packet, triangleIdx, pixelIdx, weights);
+				++tileStats.nrOfShadedPixels;
+			}
+		}
+	}
+
+	void SoftwareRasterizer::AddFragment(FragmentPacket& packet, uint32_t triangleIdx, int pixelIdx, const float weights[3])
+	{
+		const uint32_t drawIdx{ m_Triangles[triangleIdx].drawIdx };
+		if (packet.count != 0 && packet.drawIdx != drawIdx) ShadePacket(packet);
+
+		packet.drawIdx = drawIdx;
+		packet.pixelIdx[packet.count] = static_cast<uint32_t>(pixelIdx);
+		packet.triangleIdx[packet.count] = triangleIdx;
+		for (int corner{}; corner < 3; ++corner) packet.weights[corner][packet.count] = weights[corner];
+		if (++packet.count == FragmentPacket::Size) ShadePacket(packet);
+	}
+
+	void SoftwareRasterizer::ShadePacket(FragmentPacket& packet)
+	{
+		constexpr int size{ FragmentPacket::Size };
+		static_assert(size == Float8::NrOfLanes);
+
+		const DrawCall& drawCall{ m_DrawCalls[packet.drawIdx] };
+		const SoftwareMaterial& material{ drawCall.material };
+
+		// Gather the corner attributes (SoA), unused lanes repeat the first fragment
+		alignas(32) float invW[3][size];
+		alignas(32) float invWDdx[3][size]; // change of weight * invW one pixel to the right / down
+		alignas(32) float invWDdy[3][size];
+		alignas(32) float attributes[3][g_NrOfAttributes][size];
+		for (int lane{}; lane < size; ++lane)
+		{
+			const int source{ lane < packet.count ? lane : 0 };
+			const Triangle& triangle{ m_Triangles[packet.triangleIdx[source]] };
+			for (int corner{}; corner < 3; ++corner)
+			{
+				const Vertex_Out& vertex{ m_VerticesOut[triangle.vertexIdx[corner]] };
+				const float values[g_NrOfAttributes]{
+					vertex.worldPosition.x, vertex.worldPosition.y, vertex.worldPosition.z,
+					vertex.uv.x, vertex.uv.y,
+					vertex.normal.x, vertex.normal.y, vertex.normal.z,
+					vertex.tangent.x, vertex.tangent.y, vertex.tangent.z };
+				for (int attribute{}; attribute < g_NrOfAttributes; ++attribute) attributes[corner][attribute][lane] = values[attribute];
+				invW[corner][lane] = triangle.invW[corner];
+				invWDdx[corner][lane] = triangle.edges.stepX[corner] * triangle.invArea * triangle.invW[corner];
+				invWDdy[corner][lane] = triangle.edges.stepY[corner] * triangle.invArea * triangle.invW[corner];
+				packet.weights[corner][lane] = packet.weights[corner][source];
+			}
+		}
+
+		// Perspective correct interpolation
+		Float8 perspective[3];
+		for (int corner{}; corner < 3; ++corner) perspective[corner] = Float8::Load(packet.weights[corner]) * Float8::Load(invW[corner]);
+		const Float8 interpolatedW{ Float8::Broadcast(1.f) / (perspective[0] + perspective[1] + perspective[2]) };
+		const auto interpolate = [&](int attribute)
+			{
+				const Float8 sum{ Float8::Load(attributes[0][attribute]) * perspective[0] + Float8::Load(attributes[1][attribute]) * perspective[1]
+					+ Float8::Load(attributes[2][attribute]) * perspective[2] };
+				return sum * interpolatedW;
+			};
+		const auto interpolate3 = [&](int attribute) { return Vector3x8{ interpolate(attribute), interpolate(attribute + 1), interpolate(attribute + 2) }; };
+
+		// Screen space uv derivatives for the mip level / footprint, analytic instead of from 2x2 quads:
+		// d(sum(a * p) / sum(p)) = (sum(a * dp) - value * sum(dp)) / sum(p)
+		const auto differentiate = [&](int attribute, const Float8& value, const float (&invWDerivative)[3][size])
+			{
+				Float8 weighted{ Float8::Broadcast(0.f) };
+				Float8 sum{ Float8::Broadcast(0.f) };
+				for (int corner{}; corner < 3; ++corner)
+				{
+					const Float8 derivative{ Float8::Load(invWDerivative[corner]) };
+					weighted = weighted + Float8::Load(attributes[corner][attribute]) * derivative;
+					sum = sum + derivative;
+				}
+				return (weighted - value * sum) * interpolatedW;
+			};
+		const Vector2x8 uv{ interpolate(3), interpolate(4) };
+		const TextureCoordinates8 coordinates{
+			uv,
+			Vector2x8{ differentiate(3, uv.x, invWDdx), differentiate(4, uv.y, invWDdx) },
+			Vector2x8{ differentiate(3, uv.x, invWDdy), differentiate(4, uv.y, invWDdy) } };
+
+		// Pixel shader: Vehicle.fx, Fire.fx (PS_POINT / PS_LINEAR / PS_ANISOTROPIC) is the diffuse sample
+		const FilteringMode filteringMode{ drawCall.filteringMode };
+		Vector3x8 color;
+		if (material.shader == SoftwareShader::Vehicle)
+		{
+			const VehicleSamples8 samples{ material.pDiffuseGlossMap
+				? SamplePackedVehicleMaps(*material.pDiffuseGlossMap, *material.pNormalSpecularMap, coordinates, filteringMode)
+				: SampleVehicleMaps(*material.pDiffuseMap, *material.pNormalMap, *material.pSpecularMap, *material.pGlossinessMap, coordinates, filteringMode) };
+			const VehicleFragments8 fragments{
+				interpolate3(0),
+				interpolate3(5),
+				interpolate3(8),
+				samples.diffuse,
+				samples.normal,
+				samples.specular,
+				samples.glossiness };
+			color = ShadeVehicle(fragments, m_CameraPosition);
+		}
+		else
+		{
+			color = SampleTexture(*material.pDiffuseMap, coordinates, filteringMode);
+		}
+
+		alignas(32) float red[size];
+		alignas(32) float green[size];
+		alignas(32) float blue[size];
+		color.Store(red, green, blue);
+		for (int lane{}; lane < packet.count; ++lane)
+		{
+			m_ColorBuffer[packet.pixelIdx[lane]] = ToARGB(ColorRGB{ red[lane], green[lane], blue[lane] });
+		}
+		packet.count = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#ifndef SOFTWARERASTERIZER_H
+#define SOFTWARERASTERIZER_H
+
+#include "DataTypes.h"
+#include "RasterKernel.h"
+
+namespace dae
+{
+	class Texture;
+	class TileScheduler;
+
+	// which .fx file the software pipeline mirrors
+	enum class SoftwareShader
+	{
+		Vehicle = 0,
+		Fire,
+	};
+
+	enum class SoftwareShading
+	{
+		Forward = 0,      // shade every fragment that passes the depth test
+		VisibilityBuffer, // rasterize triangle IDs + depth first, then shade every visible pixel once
+	};
+
+	struct SoftwareMaterial
+	{
+		SoftwareShader shader{ SoftwareShader::Vehicle };
+		const Texture* pDiffuseMap{ nullptr };
+		const Texture* pNormalMap{ nullptr };
+		const Texture* pSpecularMap{ nullptr };
+		const Texture* pGlossinessMap{ nullptr };
+		// Vehicle: channel packed maps (MaterialPacker.h), used instead of the 4 above when set
+		const Texture* pDiffuseGlossMap{ nullptr };
+		const Texture* pNormalSpecularMap{ nullptr };
+	};
+
+	// triangles of the current frame through the clip / cull stage
+	struct SoftwareClipStats
+	{
+		uint32_t nrOfTriangles{};         // submitted by Draw
+		uint32_t nrOfFrustumCulled{};     // outside one frustum plane, or no pixel on screen
+		uint32_t nrOfBackFaceCulled{};
+		uint32_t nrOfZeroAreaCulled{};    // in clip space or after snapping to the sub-pixel grid
+		uint32_t nrOfClipped{};           // crossed the near / far plane or the guard band
+		uint32_t nrOfClippedTriangles{};  // fan triangles the clipped polygons were split into
+	};
+
+	struct SoftwareTileStats
+	{
+		uint32_t nrOfTriangles{}; // binned into the tile
+		uint32_t nrOfFragments{}; // passed the depth test, what forward shading runs the pixel shader on
+		uint32_t nrOfShadedPixels{};
+		// hierarchical depth
+		uint32_t nrOfRejectedTriangles{}; // behind the farthest depth of the tile
+		uint32_t nrOfBlocks{};            // 8x8 blocks of the surviving triangles
+		uint32_t nrOfRejectedBlocks{};    // behind the farthest depth of the block, before the edge test
+		uint32_t nrOfAcceptedBlocks{};    // in front of the nearest depth of the block, no per pixel depth test
+		uint32_t workerIdx{};
+		float timeMs{};
+	};
+
+	// CPU implementation of the DirectX pipeline, renders into an in-memory framebuffer (ARGB8888).
+	// Sort-middle: Draw transforms, clips and culls the triangles and bins them into screen tiles, Flush rasterizes and
+	// shades the tiles on all worker threads. A tile owns its pixels and walks its triangles in
+	// submission order, so the image does not depend on the thread count. Coverage comes from the
+	// fixed point edge functions in RasterKernel.h, one 8x8 block at a time. Every block keeps the
+	// nearest and farthest depth in it, so occluded triangles and blocks are skipped before the edge
+	// test and visible ones skip the per pixel depth test. In SoftwareShading::VisibilityBuffer a tile
+	// first resolves visibility for all its triangles and then runs the pixel shader once per pixel.
+	// Fragments are shaded in packets of 8 (VehicleShader.h, TextureSampler.h).
+	class SoftwareRasterizer final
+	{
+	public:
+		static constexpr int TileSize{ 64 };
+
+		// nrOfThreads = 0: one per hardware thread
+		explicit SoftwareRasterizer(int width, int height, uint32_t nrOfThreads = 0);
+		~SoftwareRasterizer();
+
+		SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+		SoftwareRasterizer(SoftwareRasterizer&&) noexcept = delete;
+		SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+		SoftwareRasterizer& operator=(SoftwareRasterizer&&) noexcept = delete;
+
+		// starts a new frame, the buffers are cleared by Flush
+		void Clear(const ColorRGB& backgroundColor);
+		void SetCameraPosition(const Vector3& cameraPosition);
+
+		// the vertex / index data and the material textures have to stay alive until Flush
+		void Draw(std::span<const Vertex> vertices, std::span<const uint32_t> indices, const Matrix& worldMatrix,
+			const Matrix& worldViewProjectionMatrix, const SoftwareMaterial& material, FilteringMode filteringMode);
+		void Flush();
+
+		void SetNrOfThreads(uint32_t nrOfThreads);
+		uint32_t GetNrOfThreads() const;
+		void SetShading(SoftwareShading shading);
+		SoftwareShading GetShading() const;
+		// in multiples of the viewport half size, triangles inside it skip side plane clipping.
+		// Clamped to what the fixed point rasterizer can address.
+		void SetGuardBand(float guardBand);
+		float GetGuardBand() const;
+
+		int GetWidth() const;
+		int GetHeight() const;
+		uint32_t* GetColorBuffer();
+		const uint32_t* GetColorBuffer() const;
+
+		// of the last Flush, row by row
+		int GetNrOfTilesX() const;
+		int GetNrOfTilesY() const;
+		std::span<const SoftwareTileStats> GetTileStats() const;
+		const SoftwareClipStats& GetClipStats() const;
+		void PrintStats() const;
+
+	private:
+		struct DrawCall
+		{
+			SoftwareMaterial material;
+			FilteringMode filteringMode;
+		};
+
+		// screen space setup of a triangle that survived culling
+		struct Triangle
+		{
+			uint32_t vertexIdx[3];
+			uint32_t drawIdx;
+			EdgeTriangle edges;
+			float depth[3];
+			float invW[3];
+			float invArea; // of the snapped triangle, turns edge values into barycentric weights
+			float minDepth, maxDepth;
+
+			void GetWeights(int px, int py, float weights[3]) const
+			{
+				for (int idx{}; idx < 3; ++idx) weights[idx] = static_cast<float>(edges.EvaluateUnbiased(idx, px, py)) * invArea;
+			}
+			int minX, minY, maxX, maxY; // pixel bounds, clamped to the screen
+		};
+
+		const int m_Width;
+		const int m_Height;
+		const int m_NrOfTilesX;
+		const int m_NrOfTilesY;
+		const int m_NrOfBlocksX;
+		const int m_NrOfBlocksY;
+
+		std::vector<uint32_t> m_ColorBuffer;
+		std::vector<float> m_DepthBuffer;
+		std::vector<float> m_BlockMinDepth; // per 8x8 block
+		std::vector<float> m_BlockMaxDepth;
+		std::vector<uint32_t> m_VisibilityBuffer; // index into m_Triangles
+		SoftwareShading m_Shading;
+		uint32_t m_ClearColor;
+
+		// everything of the current frame, reset by Clear
+		std::vector<Vertex_Out> m_VerticesOut;
+		std::vector<DrawCall> m_DrawCalls;
+		std::vector<Triangle> m_Triangles;
+		std::vector<std::vector<uint32_t>> m_TileBins;
+		std::vector<SoftwareTileStats> m_TileStats;
+
+		std::unique_ptr<TileScheduler> m_pScheduler;
+
+		float m_GuardBand;
+		SoftwareClipStats m_ClipStats;
+
+		Vector3 m_CameraPosition;
+
+		void TransformVertices(std::span<const Vertex> vertices, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, size_t firstVertex);
+		void ClipAndCullTriangles(std::span<const uint32_t> indices, uint32_t firstVertex, uint32_t drawIdx);
+		void ClipTriangle(uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t vertexIdx2, uint32_t drawIdx);
+		void SetupTriangle(uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t vertexIdx2, uint32_t drawIdx);
+		void BinTriangle(uint32_t triangleIdx);
+
+		void RenderTile(uint32_t tileIdx, uint32_t workerIdx);
+		// fragments waiting for the pixel shader, all from the same draw call
+		struct FragmentPacket
+		{
+			static constexpr int Size{ 8 };
+
+			uint32_t drawIdx;
+			int count;
+			uint32_t pixelIdx[Size];
+			uint32_t triangleIdx[Size];
+			float weights[3][Size];
+		};
+
+		// returns true when it wrote depth
+		bool RasterizeTriangle(uint32_t triangleIdx, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, FragmentPacket& packet, SoftwareTileStats& tileStats);
+		float GetBlockMaxDepth(int blockX, int blockY) const;
+		void ShadeVisibilityBuffer(int tileMinX, int tileMinY, int tileMaxX, int tileMaxY, FragmentPacket& packet, SoftwareTileStats& tileStats);
+
+		// shades the packet when it is full or the draw call changes, in order, so later fragments still win
+		void AddFragment(FragmentPacket& packet, uint32_t triangleIdx, int pixelIdx, const float weights[3]);
+		// perspective correct attributes + pixel shader, 8 fragments at once
+		void ShadePacket(FragmentPacket& packet);
+	};
+}
+
+#endif // !SOFTWARERASTERIZER_H
\ No newline at end of file
@@ -1,22 +1,137 @@
 #include "pch.h"
 #include "Texture.h"
+#include "DataTypes.h"
+#include "MipGenerator.h"
+#include "TextureCompressor.h"
+#include "MappedFile.h"
+#include "FileReader.h"
+#include "ResourceCache.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 
 namespace dae
 {
-	Texture::Texture(ID3D11Device* pDevice, SDL_Surface* pSurface)
-		: m_pDevice{ pDevice }
-		, m_pSurface{ pSurface }
-		, m_pSurfacePixels{ static_cast<uint32_t*>(pSurface->pixels) }
+	namespace
+	{
+		constexpr uint32_t g_TextureCacheMagic{ 0x43545244 }; // "DRTC"
+		constexpr uint32_t g_TextureCacheVersion{ 1 };
+
+		// followed by the blocks of every level at blockOffset, top level first
+		struct TextureCacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			uint32_t quality;
+			uint32_t mipFilter;
+			uint32_t mipContent;
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			int32_t width;
+			int32_t height;
+			uint32_t nrOfLevels;
+			uint32_t padding;
+			uint64_t blockOffset;
+			uint64_t blockSize;
+		};
+
+#ifdef DAE_HAS_DIRECTX
+		DXGI_FORMAT ToDXGIFormat(BlockFormat format)
+		{
+			switch (format)
+			{
+			case BlockFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+			case BlockFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+			case BlockFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+			case BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+			default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+		}
+#endif
+
+		const char* GetFormatName(BlockFormat format)
+		{
+			constexpr const char* names[]{ "R8G8B8A8", "BC1", "BC3", "BC4", "BC5" };
+			return names[static_cast<int>(format)];
+		}
+
+		// TextureMemoryStats, every texture adds what it holds
+		std::atomic<size_t> g_NrOfTextures{ 0 };
+		std::atomic<size_t> g_NrOfCPUCopies{ 0 };
+		std::atomic<size_t> g_CPUBytes{ 0 };
+		std::atomic<size_t> g_GPUBytes{ 0 };
+		std::atomic<size_t> g_NrOfDroppedLevels{ 0 };
+
+		// sizes of the levels below width x height, as GenerateMips lays them out
+		std::vector<TextureLevel> GetLevelLayout(int width, int height, uint32_t nrOfLevels)
+		{
+			std::vector<TextureLevel> levels{ TextureLevel{ 0, width, height } };
+			while (levels.size() < nrOfLevels)
+			{
+				const TextureLevel& above{ levels.back() };
+				levels.push_back(TextureLevel{ above.offset + static_cast<uint32_t>(above.width * above.height), std::max(above.width / 2, 1), std::max(above.height / 2, 1) });
+			}
+			return levels;
+		}
+	}
+
+	Texture::Texture(ID3D11Device* pDevice, std::vector<uint32_t>&& texels, std::vector<TextureLevel>&& levels, BlockFormat format, const uint8_t* pBlocks, const ContentHash& contentHash)
+		: m_Texels{ std::move(texels) }
+		, m_Levels{ std::move(levels) }
+		, m_Width{ m_Levels[0].width }
+		, m_Height{ m_Levels[0].height }
+		, m_Format{ format }
+		, m_ContentHash{ contentHash }
+		, m_pDevice{ pDevice }
 		, m_pResource{ nullptr }
 		, m_pSRV{ nullptr }
+		, m_NrOfCPUUsers{ 0 }
+		, m_NrOfDroppedLevels{ 0 }
+		, m_AccountedCPUBytes{ 0 }
+		, m_AccountedGPUBytes{ 0 }
+	{
+		++g_NrOfTextures;
+
+		// no device (headless / software only): the texels are the only copy
+#ifdef DAE_HAS_DIRECTX
+		if (pDevice) CreateResource(pBlocks);
+#else
+		assert(!pDevice);
+		(void)pBlocks;
+#endif
+
+		// uploaded, nothing samples the CPU copy until it is acquired
+		if (m_pResource) DropCPUCopy();
+		UpdateMemoryStats();
+	}
+
+	Texture::~Texture()
+	{
+#ifdef DAE_HAS_DIRECTX
+		if (m_pResource) m_pResource->Release();
+		if (m_pSRV) m_pSRV->Release();
+#endif
+
+		--g_NrOfTextures;
+		if (m_AccountedCPUBytes > 0) --g_NrOfCPUCopies;
+		g_CPUBytes -= m_AccountedCPUBytes;
+		g_GPUBytes -= m_AccountedGPUBytes;
+	}
+
+#ifdef DAE_HAS_DIRECTX
+	void Texture::CreateResource(const uint8_t* pBlocks)
 	{
-		DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
+		const DXGI_FORMAT dxgiFormat{ ToDXGIFormat(m_Format) };
 		D3D11_TEXTURE2D_DESC desc{};
-		desc.Width = pSurface->w;
-		desc.Height = pSurface->h;
-		desc.MipLevels = 1;
+		desc.Width = m_Width;
+		desc.Height = m_Height;
+		desc.MipLevels = static_cast<UINT>(m_Levels.size());
 		desc.ArraySize = 1;
-		desc.Format = format;
+		desc.Format = dxgiFormat;
 		desc.SampleDesc.Count = 1;
 		desc.SampleDesc.Quality = 0;
 		desc.Usage = D3D11_USAGE_DEFAULT;
@@ -24,39 +139,50 @@ namespace dae
 		desc.CPUAccessFlags = 0;
 		desc.MiscFlags = 0;
 
-		D3D11_SUBRESOURCE_DATA initData;
-		initData.pSysMem = pSurface->pixels;
-		initData.SysMemPitch = static_cast<UINT>(pSurface->pitch);
-		initData.SysMemSlicePitch = static_cast<UINT>(pSurface->h * pSurface->pitch);
-		HRESULT result{ pDevice->CreateTexture2D(&desc, &initData, &m_pResource) };
-		if (FAILED(result))
+		// one subresource per mip level, rows of 4x4 blocks when compressed
+		std::vector<D3D11_SUBRESOURCE_DATA> initData(m_Levels.size());
+		for (size_t levelIdx{}; levelIdx < m_Levels.size(); ++levelIdx)
 		{
-			assert(false);
-			return;
-		}
-
-		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc{};
-		SRVDesc.Format = format;
-		SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		SRVDesc.Texture2D.MipLevels = 1;
+			const TextureLevel& level{ m_Levels[levelIdx] };
+			if (m_Format == BlockFormat::None)
+			{
+				initData[levelIdx].pSysMem = m_Texels.data() + level.offset;
+				initData[levelIdx].SysMemPitch = static_cast<UINT>(level.width * sizeof(uint32_t));
+				initData[levelIdx].SysMemSlicePitch = static_cast<UINT>(level.height * level.width * sizeof(uint32_t));
+				continue;
+			}
 
-		result = pDevice->CreateShaderResourceView(m_pResource, &SRVDesc, &m_pSRV);
+			initData[levelIdx].pSysMem = pBlocks;
+			initData[levelIdx].SysMemPitch = static_cast<UINT>(GetBlockRowPitch(m_Format, level.width));
+			initData[levelIdx].SysMemSlicePitch = static_cast<UINT>(GetCompressedSize(m_Format, level.width, level.height));
+			pBlocks += initData[levelIdx].SysMemSlicePitch;
+		}
+		HRESULT result{ m_pDevice->CreateTexture2D(&desc, initData.data(), &m_pResource) };
 		if (FAILED(result))
 		{
 			assert(false);
 			return;
 		}
+
+		m_pSRV = CreateSRV(m_pResource);
+		assert(m_pSRV);
 	}
 
-	Texture::~Texture()
+	ID3D11ShaderResourceView* Texture::CreateSRV(ID3D11Texture2D* pResource) const
 	{
-		if (m_pSurface)
-		{
-			SDL_FreeSurface(m_pSurface);
-		}
-		if (m_pResource) m_pResource->Release();
-		if (m_pSRV) m_pSRV->Release();
+		D3D11_TEXTURE2D_DESC desc{};
+		pResource->GetDesc(&desc);
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc{};
+		SRVDesc.Format = desc.Format;
+		SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		SRVDesc.Texture2D.MipLevels = desc.MipLevels;
+
+		ID3D11ShaderResourceView* pSRV{ nullptr };
+		const HRESULT result{ m_pDevice->CreateShaderResourceView(pResource, &SRVDesc, &pSRV) };
+		return SUCCEEDED(result) ? pSRV : nullptr;
 	}
+#endif
 
 	ID3D11Device* Texture::GetDevice() const
 	{
@@ -73,8 +199,510 @@ namespace dae
 		return m_pSRV;
 	}
 
-	Texture* Texture::LoadFromFile(ID3D11Device* pDevice, const std::string& path)
+	int Texture::GetWidth() const
 	{
-		return new Texture{ pDevice, IMG_Load(path.c_str()) };
+		return m_Width;
+	}
+
+	int Texture::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	BlockFormat Texture::GetFormat() const
+	{
+		return m_Format;
+	}
+
+	size_t Texture::GetGPUSize() const
+	{
+		size_t size{};
+		for (const TextureLevel& level : m_Levels)
+		{
+			size += m_Format == BlockFormat::None ? level.width * level.height * sizeof(uint32_t) : GetCompressedSize(m_Format, level.width, level.height);
+		}
+		return size;
+	}
+
+	size_t Texture::GetCPUSize() const
+	{
+		return m_Texels.size() * sizeof(uint32_t);
+	}
+
+	size_t Texture::GetMemorySize() const
+	{
+		return GetCPUSize() + (m_pResource ? GetGPUSize() : 0);
+	}
+
+	ContentHash Texture::GetContentHash() const
+	{
+		return m_ContentHash;
+	}
+
+	const uint32_t* Texture::GetTexels() const
+	{
+		return HasCPUCopy() ? m_Texels.data() : nullptr;
+	}
+
+	std::span<const TextureLevel> Texture::GetLevels() const
+	{
+		return m_Levels;
+	}
+
+	void Texture::AcquireCPUAccess()
+	{
+		++m_NrOfCPUUsers;
+		if (HasCPUCopy() || !m_pResource) return;
+
+#ifdef DAE_HAS_DIRECTX
+		if (!ReadBackCPUCopy()) std::cout << "Could not read the texels of a " << m_Width << "x" << m_Height << " texture back from the GPU\n";
+#endif
+		UpdateMemoryStats();
+	}
+
+	void Texture::ReleaseCPUAccess()
+	{
+		assert(m_NrOfCPUUsers > 0);
+		if (--m_NrOfCPUUsers > 0 || !m_pResource) return;
+
+		DropCPUCopy();
+		UpdateMemoryStats();
+	}
+
+	bool Texture::HasCPUCopy() const
+	{
+		return !m_Texels.empty();
+	}
+
+	bool Texture::CanDropTopLevel() const
+	{
+		if (m_Levels.size() < 2) return false;
+
+		// D3D11 needs whole blocks on the top level of a mipmapped block compressed texture
+		const TextureLevel& level{ m_Levels[1] };
+		return m_Format == BlockFormat::None || (level.width % 4 == 0 && level.height % 4 == 0);
+	}
+
+	bool Texture::DropTopLevel()
+	{
+		if (!CanDropTopLevel()) return false;
+
+#ifdef DAE_HAS_DIRECTX
+		if (m_pResource)
+		{
+			// the lower levels move into a resource one level shorter, GPU to GPU
+			D3D11_TEXTURE2D_DESC desc{};
+			m_pResource->GetDesc(&desc);
+			desc.Width = m_Levels[1].width;
+			desc.Height = m_Levels[1].height;
+			desc.MipLevels = static_cast<UINT>(m_Levels.size() - 1);
+
+			ID3D11Texture2D* pResource{ nullptr };
+			if (FAILED(m_pDevice->CreateTexture2D(&desc, nullptr, &pResource))) return false;
+
+			ID3D11ShaderResourceView* pSRV{ CreateSRV(pResource) };
+			if (!pSRV)
+			{
+				pResource->Release();
+				return false;
+			}
+
+			ID3D11DeviceContext* pDeviceContext{ nullptr };
+			m_pDevice->GetImmediateContext(&pDeviceContext);
+			for (UINT levelIdx{ 1 }; levelIdx < desc.MipLevels + 1; ++levelIdx)
+			{
+				pDeviceContext->CopySubresourceRegion(pResource, levelIdx - 1, 0, 0, 0, m_pResource, levelIdx, nullptr);
+			}
+			pDeviceContext->Release();
+
+			m_pSRV->Release();
+			m_pResource->Release();
+			m_pResource = pResource;
+			m_pSRV = pSRV;
+		}
+#endif
+
+		// a new array of the lower levels, erasing in place would keep the memory
+		const uint32_t nrOfTopTexels{ m_Levels[1].offset };
+		if (HasCPUCopy()) m_Texels = std::vector<uint32_t>(m_Texels.begin() + nrOfTopTexels, m_Texels.end());
+		m_Levels.erase(m_Levels.begin());
+		for (TextureLevel& level : m_Levels) level.offset -= nrOfTopTexels;
+		m_Width = m_Levels[0].width;
+		m_Height = m_Levels[0].height;
+
+		m_ContentHash = ContentHash{};
+		++m_NrOfDroppedLevels;
+		++g_NrOfDroppedLevels;
+		UpdateMemoryStats();
+		return true;
+	}
+
+	uint32_t Texture::GetNrOfDroppedLevels() const
+	{
+		return m_NrOfDroppedLevels;
+	}
+
+	TextureMemoryStats Texture::GetMemoryStats()
+	{
+		return TextureMemoryStats{ g_NrOfTextures, g_NrOfCPUCopies, g_CPUBytes, g_GPUBytes, g_NrOfDroppedLevels };
+	}
+
+	uint32_t Texture::FitBudget(std::span<Texture* const> textures, size_t budget)
+	{
+		uint32_t nrOfDroppedLevels{};
+		while (true)
+		{
+			const TextureMemoryStats stats{ GetMemoryStats() };
+			if (stats.cpuBytes + stats.gpuBytes <= budget) break;
+
+			// the largest texture first, its top level frees the most
+			Texture* pLargest{ nullptr };
+			for (Texture* pTexture : textures)
+			{
+				if (!pTexture->CanDropTopLevel()) continue;
+				if (!pLargest || pTexture->GetMemorySize() > pLargest->GetMemorySize()) pLargest = pTexture;
+			}
+			if (!pLargest || !pLargest->DropTopLevel()) break;
+
+			++nrOfDroppedLevels;
+		}
+		return nrOfDroppedLevels;
+	}
+
+	void Texture::UpdateMemoryStats()
+	{
+		const size_t cpuBytes{ GetCPUSize() };
+		const size_t gpuBytes{ m_pResource ? GetGPUSize() : 0 };
+		if ((cpuBytes > 0) != (m_AccountedCPUBytes > 0))
+		{
+			if (cpuBytes > 0) ++g_NrOfCPUCopies;
+			else --g_NrOfCPUCopies;
+		}
+
+		// unsigned, a shrinking texture wraps around to a subtraction
+		g_CPUBytes += cpuBytes - m_AccountedCPUBytes;
+		g_GPUBytes += gpuBytes - m_AccountedGPUBytes;
+		m_AccountedCPUBytes = cpuBytes;
+		m_AccountedGPUBytes = gpuBytes;
+	}
+
+	void Texture::DropCPUCopy()
+	{
+		// swap, clear would keep the capacity
+		std::vector<uint32_t>{}.swap(m_Texels);
+	}
+
+#ifdef DAE_HAS_DIRECTX
+	bool Texture::ReadBackCPUCopy()
+	{
+		D3D11_TEXTURE2D_DESC desc{};
+		m_pResource->GetDesc(&desc);
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.MiscFlags = 0;
+
+		ID3D11Texture2D* pStagingResource{ nullptr };
+		if (FAILED(m_pDevice->CreateTexture2D(&desc, nullptr, &pStagingResource))) return false;
+
+		ID3D11DeviceContext* pDeviceContext{ nullptr };
+		m_pDevice->GetImmediateContext(&pDeviceContext);
+		pDeviceContext->CopyResource(pStagingResource, m_pResource);
+
+		// rows of texels, or rows of 4x4 blocks that are decoded after, the mapped rows can be padded
+		const TextureLevel& lastLevel{ m_Levels.back() };
+		std::vector<uint32_t> texels(lastLevel.offset + static_cast<size_t>(lastLevel.width) * lastLevel.height);
+		std::vector<uint8_t> blocks{};
+		bool isRead{ true };
+		for (UINT levelIdx{}; levelIdx < desc.MipLevels; ++levelIdx)
+		{
+			D3D11_MAPPED_SUBRESOURCE mappedLevel{};
+			isRead = SUCCEEDED(pDeviceContext->Map(pStagingResource, levelIdx, D3D11_MAP_READ, 0, &mappedLevel));
+			if (!isRead) break;
+
+			const TextureLevel& level{ m_Levels[levelIdx] };
+			const uint8_t* pRows{ static_cast<const uint8_t*>(mappedLevel.pData) };
+			if (m_Format == BlockFormat::None)
+			{
+				for (int y{}; y < level.height; ++y)
+				{
+					std::memcpy(texels.data() + level.offset + static_cast<size_t>(y) * level.width, pRows + static_cast<size_t>(y) * mappedLevel.RowPitch, level.width * sizeof(uint32_t));
+				}
+			}
+			else
+			{
+				const size_t rowPitch{ GetBlockRowPitch(m_Format, level.width) };
+				for (int blockRow{}; blockRow < (level.height + 3) / 4; ++blockRow)
+				{
+					const uint8_t* pRow{ pRows + static_cast<size_t>(blockRow) * mappedLevel.RowPitch };
+					blocks.insert(blocks.end(), pRow, pRow + rowPitch);
+				}
+			}
+			pDeviceContext->Unmap(pStagingResource, levelIdx);
+		}
+		pDeviceContext->Release();
+		pStagingResource->Release();
+		if (!isRead) return false;
+
+		if (m_Format != BlockFormat::None) DecompressTexels(blocks.data(), m_Format, m_Levels, texels.data());
+		m_Texels = std::move(texels);
+		return true;
+	}
+#endif
+
+	ColorRGB Texture::Sample(const Vector2& uv, FilteringMode filteringMode) const
+	{
+		assert(HasCPUCopy() && "Texture::Sample without CPU access");
+		constexpr float divByteMax{ 1.f / 255.f };
+
+		// Point (MIN_MAG_MIP_POINT)
+		if (filteringMode == FilteringMode::Point)
+		{
+			const uint32_t texel{ GetTexel(static_cast<int>(floorf(uv.x * m_Width)), static_cast<int>(floorf(uv.y * m_Height))) };
+			return ColorRGB
+			{
+				(texel & 0xFF) * divByteMax,
+				((texel >> 8) & 0xFF) * divByteMax,
+				((texel >> 16) & 0xFF) * divByteMax
+			};
+		}
+
+		// Linear / Anisotropic (single mip level, so anisotropic falls back to bilinear)
+		const float texelX{ uv.x * m_Width - 0.5f };
+		const float texelY{ uv.y * m_Height - 0.5f };
+		const float floorX{ floorf(texelX) };
+		const float floorY{ floorf(texelY) };
+		const float fracX{ texelX - floorX };
+		const float fracY{ texelY - floorY };
+		const int x0{ static_cast<int>(floorX) };
+		const int y0{ static_cast<int>(floorY) };
+
+		const uint32_t texels[4]{ GetTexel(x0, y0), GetTexel(x0 + 1, y0), GetTexel(x0, y0 + 1), GetTexel(x0 + 1, y0 + 1) };
+		const float weights[4]{ (1.f - fracX) * (1.f - fracY), fracX * (1.f - fracY), (1.f - fracX) * fracY, fracX * fracY };
+
+		ColorRGB color{};
+		for (int idx{}; idx < 4; ++idx)
+		{
+			color.r += (texels[idx] & 0xFF) * weights[idx];
+			color.g += ((texels[idx] >> 8) & 0xFF) * weights[idx];
+			color.b += ((texels[idx] >> 16) & 0xFF) * weights[idx];
+		}
+		return color * divByteMax;
+	}
+
+	uint32_t Texture::GetTexel(int x, int y) const
+	{
+		// Wrap addressing
+		x %= m_Width;
+		y %= m_Height;
+		if (x < 0) x += m_Width;
+		if (y < 0) y += m_Height;
+
+		return m_Texels[static_cast<size_t>(y) * m_Width + x];
+	}
+
+	TextureData::TextureData() = default;
+	TextureData::~TextureData() = default;
+
+	Texture* Texture::LoadFromFile(ID3D11Device* pDevice, const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression)
+	{
+		return Create(pDevice, Decode(path, mipSettings, compression));
+	}
+
+	std::shared_ptr<Texture> Texture::LoadFromFile(ResourceCache& cache, ID3D11Device* pDevice, const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression)
+	{
+		const std::string key{ GetCacheKey(path, mipSettings, compression) };
+		if (std::shared_ptr<Texture> pTexture{ cache.Find<Texture>(key) }) return pTexture;
+
+		// the same image under another key (a copy, other settings with the same result) is not uploaded again
+		std::unique_ptr<TextureData> pData{ Decode(path, mipSettings, compression) };
+		if (!pData) return nullptr;
+		if (std::shared_ptr<Texture> pTexture{ cache.FindContent<Texture>(key, pData->contentHash) }) return pTexture;
+
+		return cache.Insert(key, std::shared_ptr<Texture>{ Create(pDevice, std::move(pData)) });
+	}
+
+	std::string Texture::GetCacheKey(const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression)
+	{
+		std::stringstream ss;
+		ss << "texture " << ResourceCache::GetCanonicalPath(path) << " mips " << static_cast<int>(mipSettings.filter) << "/" << static_cast<int>(mipSettings.content)
+			<< " " << GetFormatName(compression.format) << (compression.quality == CompressionQuality::Quality ? " quality" : " fast");
+		return ss.str();
+	}
+
+	std::unique_ptr<TextureData> Texture::Decode(const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression, uint32_t nrOfThreads)
+	{
+		std::unique_ptr<TextureData> pData{ DecodeImage(path, mipSettings, compression, nrOfThreads) };
+		if (!pData) return nullptr;
+
+		// on the decoding thread, the render thread only compares hashes
+		const int32_t layout[]{ static_cast<int32_t>(pData->format), static_cast<int32_t>(pData->levels.size()), pData->levels[0].width };
+		pData->contentHash = HashBytes(pData->texels.data(), pData->texels.size() * sizeof(uint32_t), HashBytes(layout, sizeof(layout), ContentHash{}));
+		return pData;
+	}
+
+	std::unique_ptr<TextureData> Texture::DecodeImage(const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression, uint32_t nrOfThreads)
+	{
+		// 1. Up to date cache of the compressed levels: no decoding of the image, no encoding
+		uint64_t sourceSize{};
+		int64_t sourceWriteTime{};
+		const std::string cachePath{ path + ".texcache" };
+		if (compression.format != BlockFormat::None)
+		{
+			std::error_code errorCode{};
+			sourceSize = std::filesystem::file_size(path, errorCode);
+			if (!errorCode) sourceWriteTime = static_cast<int64_t>(std::filesystem::last_write_time(path, errorCode).time_since_epoch().count());
+
+			std::unique_ptr<TextureData> pData{ errorCode ? nullptr : LoadCache(cachePath, sourceSize, sourceWriteTime, mipSettings, compression) };
+			if (pData)
+			{
+				pData->path = path;
+
+				size_t blockSize{};
+				for (const TextureLevel& level : pData->levels) blockSize += GetCompressedSize(pData->format, level.width, level.height);
+
+				// one write, textures are decoded on several threads
+				std::stringstream ss;
+				ss << "Loaded " << path << " from " << cachePath << ": " << GetFormatName(pData->format) << ", " << pData->levels.size() << " levels, " << blockSize / 1024 << " KB\n";
+				std::cout << ss.str();
+				return pData;
+			}
+		}
+
+		// 2. Decode the image, from memory (the file is read in large batched reads, not through SDL's stdio)
+		// SDL_RWFromConstMem takes an int size, bigger files are not images we can load anyway
+		FileData file{};
+		const bool isRead{ ReadWholeFile(path, file) && file.size <= static_cast<size_t>(std::numeric_limits<int>::max()) };
+		SDL_Surface* pLoadedSurface{ isRead ? IMG_Load_RW(SDL_RWFromConstMem(file.pData.get(), static_cast<int>(file.size)), 1) : nullptr };
+		file = FileData{};
+		if (!pLoadedSurface)
+		{
+			std::cout << "Texture Not Found: " + path + "\n";
+			return nullptr;
+		}
+
+		// R8G8B8A8 byte order, both for the DXGI_FORMAT_R8G8B8A8_UNORM upload and for CPU sampling
+		if (pLoadedSurface->format->format != SDL_PIXELFORMAT_RGBA32)
+		{
+			SDL_Surface* pConvertedSurface{ SDL_ConvertSurfaceFormat(pLoadedSurface, SDL_PIXELFORMAT_RGBA32, 0) };
+			SDL_FreeSurface(pLoadedSurface);
+			pLoadedSurface = pConvertedSurface;
+		}
+
+		// CPU copy without the row padding of the surface
+		std::unique_ptr<TextureData> pData{ std::make_unique<TextureData>() };
+		pData->path = path;
+		const int width{ pLoadedSurface->w };
+		const int height{ pLoadedSurface->h };
+		pData->texels.resize(static_cast<size_t>(width) * height);
+		for (int y{}; y < height; ++y)
+		{
+			const uint8_t* pRow{ static_cast<const uint8_t*>(pLoadedSurface->pixels) + static_cast<size_t>(y) * pLoadedSurface->pitch };
+			std::memcpy(pData->texels.data() + static_cast<size_t>(y) * width, pRow, width * sizeof(uint32_t));
+		}
+		SDL_FreeSurface(pLoadedSurface);
+
+		pData->levels.push_back(TextureLevel{ 0, width, height });
+		if (mipSettings.filter != MipFilter::None) GenerateMips(pData->texels, pData->levels, mipSettings, nrOfThreads);
+
+		// 3. Encode, and write the cache for the next run. The CPU copy is replaced by the decoded blocks,
+		// so the software rasterizer sees what the GPU samples.
+		if (compression.format == BlockFormat::None) return pData;
+
+		// D3D11 needs whole blocks on the top level of a mipmapped block compressed texture
+		if (width % 4 != 0 || height % 4 != 0)
+		{
+			std::cout << "Not compressed, size not a multiple of 4: " + path + "\n";
+			return pData;
+		}
+
+		pData->format = compression.format;
+		pData->blocks = CompressTexels(pData->texels.data(), pData->levels, compression, nrOfThreads);
+		pData->pBlocks = pData->blocks.data();
+		DecompressTexels(pData->pBlocks, pData->format, pData->levels, pData->texels.data());
+		if (!WriteCache(cachePath, pData->blocks, pData->levels, sourceSize, sourceWriteTime, mipSettings, compression))
+		{
+			std::cout << "Could not write texture cache: " + cachePath + "\n";
+		}
+		return pData;
+	}
+
+	Texture* Texture::Create(ID3D11Device* pDevice, std::unique_ptr<TextureData> pData)
+	{
+		if (!pData) return nullptr;
+
+		// the blocks (and the cache mapping) are only needed for the upload
+		return new Texture{ pDevice, std::move(pData->texels), std::move(pData->levels), pData->format, pData->pBlocks, pData->contentHash };
+	}
+
+	Texture* Texture::CreateSolid(ID3D11Device* pDevice, uint32_t texel)
+	{
+		const int32_t layout[]{ static_cast<int32_t>(BlockFormat::None), 1, 1 };
+		return new Texture{ pDevice, std::vector<uint32_t>{ texel }, std::vector<TextureLevel>{ TextureLevel{ 0, 1, 1 } }, BlockFormat::None, nullptr, HashBytes(&texel, sizeof(uint32_t), HashBytes(layout, sizeof(layout), ContentHash{})) };
+	}
+
+	std::unique_ptr<TextureData> Texture::LoadCache(const std::string& cachePath, uint64_t sourceSize, int64_t sourceWriteTime, const MipSettings& mipSettings, const CompressionSettings& compression)
+	{
+		std::unique_ptr<MappedFile> pMappedFile{ std::make_unique<MappedFile>(cachePath) };
+		if (!pMappedFile->IsOpen() || pMappedFile->GetSize() < sizeof(TextureCacheHeader)) return nullptr;
+
+		TextureCacheHeader header{};
+		std::memcpy(&header, pMappedFile->GetData(), sizeof(TextureCacheHeader));
+
+		// Invalidation, a cache of higher quality than requested is fine
+		if (header.magic != g_TextureCacheMagic || header.version != g_TextureCacheVersion) return nullptr;
+		if (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime) return nullptr;
+		if (header.format != static_cast<uint32_t>(compression.format) || header.quality < static_cast<uint32_t>(compression.quality)) return nullptr;
+		if (header.mipFilter != static_cast<uint32_t>(mipSettings.filter) || header.mipContent != static_cast<uint32_t>(mipSettings.content)) return nullptr;
+		if (header.width <= 0 || header.height <= 0 || header.nrOfLevels == 0 || header.nrOfLevels > 32) return nullptr;
+
+		std::vector<TextureLevel> levels{ GetLevelLayout(header.width, header.height, header.nrOfLevels) };
+		size_t blockSize{};
+		for (const TextureLevel& level : levels) blockSize += GetCompressedSize(compression.format, level.width, level.height);
+		if (header.blockSize != blockSize || header.blockOffset + blockSize > pMappedFile->GetSize()) return nullptr;
+
+		std::unique_ptr<TextureData> pData{ std::make_unique<TextureData>() };
+		pData->format = compression.format;
+		pData->pBlocks = reinterpret_cast<const uint8_t*>(pMappedFile->GetData() + header.blockOffset);
+		pData->texels.resize(levels.back().offset + static_cast<size_t>(levels.back().width) * levels.back().height);
+		DecompressTexels(pData->pBlocks, pData->format, levels, pData->texels.data());
+		pData->levels = std::move(levels);
+
+		// uploaded straight from the mapping
+		pData->pMappedCache = std::move(pMappedFile);
+		return pData;
+	}
+
+	bool Texture::WriteCache(const std::string& cachePath, const std::vector<uint8_t>& blocks, std::span<const TextureLevel> levels, uint64_t sourceSize, int64_t sourceWriteTime, const MipSettings& mipSettings, const CompressionSettings& compression)
+	{
+		TextureCacheHeader header{};
+		header.magic = g_TextureCacheMagic;
+		header.version = g_TextureCacheVersion;
+		header.format = static_cast<uint32_t>(compression.format);
+		header.quality = static_cast<uint32_t>(compression.quality);
+		header.mipFilter = static_cast<uint32_t>(mipSettings.filter);
+		header.mipContent = static_cast<uint32_t>(mipSettings.content);
+		header.sourceSize = sourceSize;
+		header.sourceWriteTime = sourceWriteTime;
+		header.width = levels[0].width;
+		header.height = levels[0].height;
+		header.nrOfLevels = static_cast<uint32_t>(levels.size());
+		header.blockOffset = sizeof(TextureCacheHeader);
+		header.blockSize = blocks.size();
+
+		// write to a temporary file first, a crash never leaves a half written cache behind
+		const std::string tempPath{ cachePath + ".tmp" };
+		{
+			std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!file) return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(TextureCacheHeader));
+			file.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+			if (!file) return false;
+		}
+
+		std::error_code errorCode{};
+		std::filesystem::rename(tempPath, cachePath, errorCode);
+		return !errorCode;
 	}
 }
\ No newline at end of file
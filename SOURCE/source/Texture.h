@@ -1,10 +1,96 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
-struct SDL_Surface;
+#include "ResourceCache.h"
 
 namespace dae
 {
+	struct Vector2;
+	struct ColorRGB;
+	class MappedFile;
+	enum class FilteringMode;
+
+	// one mip level in Texture::GetTexels, rows are tightly packed
+	struct TextureLevel
+	{
+		uint32_t offset; // first texel
+		int32_t width;
+		int32_t height;
+	};
+
+	enum class MipFilter
+	{
+		None = 0, // top level only
+		Box,      // 2x2 average
+		Kaiser,   // Kaiser windowed sinc over 8x8 texels, sharper minified views
+	};
+
+	// what the texels hold, decides the space the mip levels are filtered in
+	enum class MipContent
+	{
+		Color = 0,  // linear data (specular, glossiness)
+		SRGBColor,  // gamma encoded color (diffuse), filtered in linear light
+		NormalMap,  // (n + 1) / 2, filtered as vectors and renormalized
+	};
+
+	struct MipSettings
+	{
+		MipFilter filter{ MipFilter::Box };
+		MipContent content{ MipContent::Color };
+	};
+
+	// GPU format of the texels (TextureCompressor.h), 4x4 texel blocks
+	enum class BlockFormat
+	{
+		None = 0, // R8G8B8A8, 4 bytes per texel
+		BC1,      // rgb, 0.5 byte per texel
+		BC3,      // rgb + alpha, 1 byte per texel
+		BC4,      // r (glossiness), 0.5 byte per texel
+		BC5,      // rg (normal map, b is reconstructed), 1 byte per texel
+	};
+
+	enum class CompressionQuality
+	{
+		Fast = 0, // bounding box endpoints, for iteration
+		Quality,  // principal axis + least squares endpoints, for shipping
+	};
+
+	// compressed textures are cached next to the image ("<path>.texcache") with all their mip levels
+	struct CompressionSettings
+	{
+		BlockFormat format{ BlockFormat::None };
+		CompressionQuality quality{ CompressionQuality::Fast };
+	};
+
+	// CPU side of a texture, every mip level ready for the upload. Texture::Decode produces it on any thread
+	// (file I/O, decoding, mips, encoding), Texture::Create turns it into the GPU resource on the render thread.
+	struct TextureData
+	{
+		TextureData();
+		~TextureData();
+
+		std::string path;
+		std::vector<uint32_t> texels;
+		std::vector<TextureLevel> levels;
+		BlockFormat format{ BlockFormat::None };
+		// the blocks of every level when compressed: freshly encoded, or straight from the mapped cache
+		std::vector<uint8_t> blocks;
+		std::unique_ptr<MappedFile> pMappedCache;
+		const uint8_t* pBlocks{ nullptr };
+		// HashBytes of the texels and their layout, the same image with the same settings hashes the same
+		ContentHash contentHash{};
+	};
+
+	// every Texture alive, polled with Texture::GetMemoryStats
+	struct TextureMemoryStats
+	{
+		size_t nrOfTextures;
+		size_t nrOfCPUCopies;     // textures with their texels in system memory
+		size_t cpuBytes;
+		size_t gpuBytes;
+		size_t nrOfDroppedLevels; // mip levels given up for a memory budget (Texture::FitBudget)
+	};
+
 	class Texture
 	{
 	public:
@@ -20,16 +106,104 @@ namespace dae
 		ID3D11Texture2D* GetResource() const;
 		ID3D11ShaderResourceView* GetSRV() const;
 
-		static Texture* LoadFromFile(ID3D11Device* pDevice, const std::string& path);
+		// of the top resident level
+		int GetWidth() const;
+		int GetHeight() const;
+		BlockFormat GetFormat() const;
+		// bytes of the GPU resource, all resident mip levels (also without a device)
+		size_t GetGPUSize() const;
+		// bytes of the CPU copy of the texels (0 when dropped)
+		size_t GetCPUSize() const;
+		// CPU copy + GPU resource (when there is one), what the texture costs in a ResourceCache
+		size_t GetMemorySize() const;
+		// of the texture as decoded, empty once a level was dropped (it no longer matches a fresh decode)
+		ContentHash GetContentHash() const;
+
+		// CPU copy of the texels (R8G8B8A8, decoded blocks when compressed), every resident mip level one after the other.
+		// nullptr while the copy is dropped, see AcquireCPUAccess.
+		const uint32_t* GetTexels() const;
+		std::span<const TextureLevel> GetLevels() const;
+
+		// Residency: a texture with a GPU resource drops its CPU copy once it is uploaded, CPU consumers (software
+		// sampling, picking) acquire it for as long as they sample. Acquiring a dropped copy reads it back from the
+		// GPU resource, the last release drops it again. Textures without a device always keep their copy. Render thread.
+		void AcquireCPUAccess();
+		void ReleaseCPUAccess();
+		bool HasCPUCopy() const;
+
+		// Demotion: the top mip level is given up, on the GPU (the lower levels are copied into a smaller resource,
+		// the SRV changes, rebind it) and in the CPU copy. Not for the last level, or when a block compressed top
+		// level would not be whole blocks anymore. Render thread.
+		bool CanDropTopLevel() const;
+		bool DropTopLevel();
+		uint32_t GetNrOfDroppedLevels() const;
+
+		static TextureMemoryStats GetMemoryStats();
+		// Drops top levels of the largest of these textures, one level at a time, until every texture together
+		// (GetMemoryStats, CPU + GPU) fits in budget or none of them can drop any more. Returns the levels dropped.
+		static uint32_t FitBudget(std::span<Texture* const> textures, size_t budget);
+
+		// Scalar float sampling of the top level, wrap addressing like the .fx SamplerStates.
+		// The software rasterizer uses SampleTexture (TextureSampler.h), 8 samples at once with mips.
+		ColorRGB Sample(const Vector2& uv, FilteringMode filteringMode) const;
+
+		// pDevice can be nullptr (always without DirectX), the texture is then only available for CPU sampling. With a device the CPU copy is
+		// dropped after the upload (AcquireCPUAccess).
+		// The full mip chain is generated at load time (MipGenerator.h) and uploaded with the top level.
+		// Compressed textures load from an up to date cache (same image size + write time, mip settings,
+		// format and at least the requested quality), otherwise they are encoded and the cache is (re)written.
+		static Texture* LoadFromFile(ID3D11Device* pDevice, const std::string& path, const MipSettings& mipSettings = {}, const CompressionSettings& compression = {});
+		// LoadFromFile through the cache: decoded when the key is not cached, created and uploaded only when the
+		// decoded content is not cached either
+		static std::shared_ptr<Texture> LoadFromFile(ResourceCache& cache, ID3D11Device* pDevice, const std::string& path, const MipSettings& mipSettings = {}, const CompressionSettings& compression = {});
+		// ResourceCache key of an image loaded with these settings
+		static std::string GetCacheKey(const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression);
+
+		// LoadFromFile in two steps for the asset loader (AssetLoader.h): Decode does not touch the device
+		// and is safe on worker threads, Create only builds the resource. Both return nullptr on failure.
+		// nrOfThreads for the mips and the encoding (0: one per hardware thread), 1 on the asset workers.
+		static std::unique_ptr<TextureData> Decode(const std::string& path, const MipSettings& mipSettings = {}, const CompressionSettings& compression = {}, uint32_t nrOfThreads = 0);
+		static Texture* Create(ID3D11Device* pDevice, std::unique_ptr<TextureData> pData);
+
+		// 1x1 texture of one R8G8B8A8 texel (r in the low byte), placeholder while the real one is loading
+		static Texture* CreateSolid(ID3D11Device* pDevice, uint32_t texel);
 
 	private:
-		explicit Texture(ID3D11Device* pDevice, SDL_Surface* pSurface);
+		// pBlocks: every level in format, one after the other (nullptr for BlockFormat::None, texels are uploaded)
+		explicit Texture(ID3D11Device* pDevice, std::vector<uint32_t>&& texels, std::vector<TextureLevel>&& levels, BlockFormat format, const uint8_t* pBlocks, const ContentHash& contentHash);
 
-		SDL_Surface* m_pSurface;
-		uint32_t* m_pSurfacePixels;
+		// Decode without the content hash
+		static std::unique_ptr<TextureData> DecodeImage(const std::string& path, const MipSettings& mipSettings, const CompressionSettings& compression, uint32_t nrOfThreads);
+
+		static std::unique_ptr<TextureData> LoadCache(const std::string& cachePath, uint64_t sourceSize, int64_t sourceWriteTime, const MipSettings& mipSettings, const CompressionSettings& compression);
+		static bool WriteCache(const std::string& cachePath, const std::vector<uint8_t>& blocks, std::span<const TextureLevel> levels, uint64_t sourceSize, int64_t sourceWriteTime, const MipSettings& mipSettings, const CompressionSettings& compression);
+
+		std::vector<uint32_t> m_Texels;
+		std::vector<TextureLevel> m_Levels;
+		int m_Width;
+		int m_Height;
+		const BlockFormat m_Format;
+		ContentHash m_ContentHash;
 		ID3D11Device* m_pDevice;
 		ID3D11Texture2D* m_pResource;
 		ID3D11ShaderResourceView* m_pSRV;
+
+		uint32_t m_NrOfCPUUsers;
+		uint32_t m_NrOfDroppedLevels;
+		// what this texture added to the TextureMemoryStats
+		size_t m_AccountedCPUBytes;
+		size_t m_AccountedGPUBytes;
+
+		// after every change of the copy or the resource
+		void UpdateMemoryStats();
+		void DropCPUCopy();
+#ifdef DAE_HAS_DIRECTX
+		void CreateResource(const uint8_t* pBlocks);
+		bool ReadBackCPUCopy();
+		ID3D11ShaderResourceView* CreateSRV(ID3D11Texture2D* pResource) const;
+#endif
+
+		uint32_t GetTexel(int x, int y) const;
 	};
 }
 
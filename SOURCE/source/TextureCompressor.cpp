@@ -0,0 +1,650 @@
+#include "pch.h"
+#include "TextureCompressor.h"
+#include "TileScheduler.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr int g_BlockDim{ 4 };
+		constexpr int g_NrOfBlockTexels{ g_BlockDim * g_BlockDim };
+
+		inline int GetChannel(uint32_t texel, int channel)
+		{
+			return static_cast<int>((texel >> (channel * 8)) & 0xFF);
+		}
+
+		inline int GetNrOfBlocks(int size)
+		{
+			return std::max((size + g_BlockDim - 1) / g_BlockDim, 1);
+		}
+
+		// 4x4 texels at (blockX, blockY), levels smaller than a block repeat their last row / column
+		void LoadBlock(const uint32_t* pTexels, int width, int height, int blockX, int blockY, uint32_t* pBlock)
+		{
+			for (int y{}; y < g_BlockDim; ++y)
+			{
+				const int texelY{ std::min(blockY * g_BlockDim + y, height - 1) };
+				for (int x{}; x < g_BlockDim; ++x)
+				{
+					const int texelX{ std::min(blockX * g_BlockDim + x, width - 1) };
+					pBlock[y * g_BlockDim + x] = pTexels[static_cast<size_t>(texelY) * width + texelX];
+				}
+			}
+		}
+
+		void StoreBlock(const uint32_t* pBlock, int width, int height, int blockX, int blockY, uint32_t* pTexels)
+		{
+			for (int y{}; y < g_BlockDim && blockY * g_BlockDim + y < height; ++y)
+			{
+				for (int x{}; x < g_BlockDim && blockX * g_BlockDim + x < width; ++x)
+				{
+					pTexels[static_cast<size_t>(blockY * g_BlockDim + y) * width + blockX * g_BlockDim + x] = pBlock[y * g_BlockDim + x];
+				}
+			}
+		}
+
+		//// BC1 color block: 2 x RGB565 endpoints, 2 bit index per texel ////
+		struct ColorBlock
+		{
+			uint16_t color0;
+			uint16_t color1;
+			uint32_t indices; // texel 0 in the lowest bits
+			int error;        // squared, summed over the texels
+		};
+
+		inline int Quantize(float value, int maxValue)
+		{
+			return std::clamp(static_cast<int>(value * maxValue / 255.f + 0.5f), 0, maxValue);
+		}
+
+		inline uint16_t To565(const float* pColor)
+		{
+			return static_cast<uint16_t>((Quantize(pColor[0], 31) << 11) | (Quantize(pColor[1], 63) << 5) | Quantize(pColor[2], 31));
+		}
+
+		// bit replication, like the GPU expands them
+		inline void From565(uint16_t color, int* pColor)
+		{
+			const int r{ (color >> 11) & 31 };
+			const int g{ (color >> 5) & 63 };
+			const int b{ color & 31 };
+			pColor[0] = (r << 3) | (r >> 2);
+			pColor[1] = (g << 2) | (g >> 4);
+			pColor[2] = (b << 3) | (b >> 2);
+		}
+
+		// one 565 component of color moved by delta, unchanged when that leaves the range
+		uint16_t Adjust565(uint16_t color, int channel, int delta)
+		{
+			const int shift{ channel == 0 ? 11 : (channel == 1 ? 5 : 0) };
+			const int maxValue{ channel == 1 ? 63 : 31 };
+			const int value{ ((color >> shift) & maxValue) + delta };
+			if (value < 0 || value > maxValue) return color;
+			return static_cast<uint16_t>((color & ~(maxValue << shift)) | (value << shift));
+		}
+
+		// color0 > color1: 4 colors. Otherwise (BC1 only) 3 colors + transparent black, BC3 always uses 4.
+		void GetColorPalette(uint16_t color0, uint16_t color1, bool allowThreeColors, int palette[4][3])
+		{
+			From565(color0, palette[0]);
+			From565(color1, palette[1]);
+			const bool isThreeColors{ allowThreeColors && color0 <= color1 };
+			for (int channel{}; channel < 3; ++channel)
+			{
+				const int a{ palette[0][channel] };
+				const int b{ palette[1][channel] };
+				palette[2][channel] = isThreeColors ? (a + b + 1) / 2 : (2 * a + b + 1) / 3;
+				palette[3][channel] = isThreeColors ? 0 : (a + 2 * b + 1) / 3;
+			}
+		}
+
+		// nearest palette color per texel, always in 4 color mode
+		ColorBlock EvaluateColorBlock(const int colors[g_NrOfBlockTexels][3], uint16_t color0, uint16_t color1)
+		{
+			if (color0 < color1) std::swap(color0, color1);
+
+			int palette[4][3];
+			GetColorPalette(color0, color1, false, palette);
+
+			ColorBlock block{ color0, color1, 0, 0 };
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				int bestIdx{};
+				int bestError{ INT_MAX };
+				for (int paletteIdx{}; paletteIdx < 4; ++paletteIdx)
+				{
+					int error{};
+					for (int channel{}; channel < 3; ++channel)
+					{
+						const int difference{ colors[texelIdx][channel] - palette[paletteIdx][channel] };
+						error += difference * difference;
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIdx = paletteIdx;
+					}
+				}
+				block.indices |= static_cast<uint32_t>(bestIdx) << (texelIdx * 2);
+				block.error += bestError;
+			}
+			return block;
+		}
+
+		// endpoints that minimize the squared error for the current indices (weights of color0 per index)
+		bool FitColorEndpoints(const int colors[g_NrOfBlockTexels][3], const ColorBlock& block, float* pColor0, float* pColor1)
+		{
+			constexpr float weights[4]{ 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+			float alphaAlpha{}, betaBeta{}, alphaBeta{};
+			float alphaColor[3]{}, betaColor[3]{};
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				const float alpha{ weights[(block.indices >> (texelIdx * 2)) & 3] };
+				const float beta{ 1.f - alpha };
+				alphaAlpha += alpha * alpha;
+				betaBeta += beta * beta;
+				alphaBeta += alpha * beta;
+				for (int channel{}; channel < 3; ++channel)
+				{
+					alphaColor[channel] += alpha * colors[texelIdx][channel];
+					betaColor[channel] += beta * colors[texelIdx][channel];
+				}
+			}
+
+			const float determinant{ alphaAlpha * betaBeta - alphaBeta * alphaBeta };
+			if (std::abs(determinant) < FLT_EPSILON) return false;
+
+			for (int channel{}; channel < 3; ++channel)
+			{
+				pColor0[channel] = std::clamp((betaBeta * alphaColor[channel] - alphaBeta * betaColor[channel]) / determinant, 0.f, 255.f);
+				pColor1[channel] = std::clamp((alphaAlpha * betaColor[channel] - alphaBeta * alphaColor[channel]) / determinant, 0.f, 255.f);
+			}
+			return true;
+		}
+
+		ColorBlock EncodeColorBlock(const uint32_t* pBlock, CompressionQuality quality)
+		{
+			int colors[g_NrOfBlockTexels][3];
+			float mean[3]{};
+			float minColor[3]{ 255.f, 255.f, 255.f };
+			float maxColor[3]{};
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				for (int channel{}; channel < 3; ++channel)
+				{
+					colors[texelIdx][channel] = GetChannel(pBlock[texelIdx], channel);
+					mean[channel] += colors[texelIdx][channel] / static_cast<float>(g_NrOfBlockTexels);
+					minColor[channel] = std::min(minColor[channel], static_cast<float>(colors[texelIdx][channel]));
+					maxColor[channel] = std::max(maxColor[channel], static_cast<float>(colors[texelIdx][channel]));
+				}
+			}
+
+			float covariance[3][3]{};
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				for (int row{}; row < 3; ++row)
+				{
+					for (int column{}; column < 3; ++column)
+					{
+						covariance[row][column] += (colors[texelIdx][row] - mean[row]) * (colors[texelIdx][column] - mean[column]);
+					}
+				}
+			}
+
+			// Fast: bounding box diagonal that follows the correlation of red and blue with green, inset by
+			// 1/16 of the range (the interpolated colors cover the inside of the box)
+			if (covariance[0][1] < 0.f) std::swap(minColor[0], maxColor[0]);
+			if (covariance[2][1] < 0.f) std::swap(minColor[2], maxColor[2]);
+			for (int channel{}; channel < 3; ++channel)
+			{
+				const float inset{ (maxColor[channel] - minColor[channel]) / 16.f };
+				minColor[channel] += inset;
+				maxColor[channel] -= inset;
+			}
+			ColorBlock best{ EvaluateColorBlock(colors, To565(maxColor), To565(minColor)) };
+			if (quality == CompressionQuality::Fast || best.error == 0) return best;
+
+			// Quality: extent of the colors along the principal axis (power iteration on the covariance)
+			float axis[3]{ maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2] };
+			if (axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] < FLT_EPSILON) axis[0] = axis[1] = axis[2] = 1.f;
+			for (int iteration{}; iteration < 8; ++iteration)
+			{
+				float next[3]{};
+				for (int row{}; row < 3; ++row)
+				{
+					next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+				}
+				const float length{ std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]) };
+				if (length < FLT_EPSILON) break;
+				for (int channel{}; channel < 3; ++channel) axis[channel] = next[channel] / length;
+			}
+			const float axisLength{ std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) };
+			for (float& value : axis) value /= axisLength;
+
+			float minProjection{ FLT_MAX };
+			float maxProjection{ -FLT_MAX };
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				float projection{};
+				for (int channel{}; channel < 3; ++channel) projection += (colors[texelIdx][channel] - mean[channel]) * axis[channel];
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+			float color0[3], color1[3];
+			for (int channel{}; channel < 3; ++channel)
+			{
+				color0[channel] = std::clamp(mean[channel] + axis[channel] * maxProjection, 0.f, 255.f);
+				color1[channel] = std::clamp(mean[channel] + axis[channel] * minProjection, 0.f, 255.f);
+			}
+			const ColorBlock principal{ EvaluateColorBlock(colors, To565(color0), To565(color1)) };
+			if (principal.error < best.error) best = principal;
+
+			// least squares endpoints for the chosen indices, as long as that improves
+			for (int iteration{}; iteration < 2 && FitColorEndpoints(colors, best, color0, color1); ++iteration)
+			{
+				const ColorBlock fitted{ EvaluateColorBlock(colors, To565(color0), To565(color1)) };
+				if (fitted.error >= best.error) break;
+				best = fitted;
+			}
+
+			// one 565 step on every endpoint component
+			for (int round{}; round < 2; ++round)
+			{
+				bool hasImproved{ false };
+				for (int endpoint{}; endpoint < 2; ++endpoint)
+				{
+					for (int channel{}; channel < 3; ++channel)
+					{
+						for (const int delta : { -1, 1 })
+						{
+							const uint16_t color0{ endpoint == 0 ? Adjust565(best.color0, channel, delta) : best.color0 };
+							const uint16_t color1{ endpoint == 1 ? Adjust565(best.color1, channel, delta) : best.color1 };
+							const ColorBlock adjusted{ EvaluateColorBlock(colors, color0, color1) };
+							if (adjusted.error < best.error)
+							{
+								best = adjusted;
+								hasImproved = true;
+							}
+						}
+					}
+				}
+				if (!hasImproved) break;
+			}
+			return best;
+		}
+
+		void WriteColorBlock(const ColorBlock& block, uint8_t* pOut)
+		{
+			std::memcpy(pOut, &block.color0, sizeof(uint16_t));
+			std::memcpy(pOut + 2, &block.color1, sizeof(uint16_t));
+			std::memcpy(pOut + 4, &block.indices, sizeof(uint32_t));
+		}
+
+		void DecodeColorBlock(const uint8_t* pIn, bool allowThreeColors, uint32_t* pBlock)
+		{
+			uint16_t color0, color1;
+			uint32_t indices;
+			std::memcpy(&color0, pIn, sizeof(uint16_t));
+			std::memcpy(&color1, pIn + 2, sizeof(uint16_t));
+			std::memcpy(&indices, pIn + 4, sizeof(uint32_t));
+
+			int palette[4][3];
+			GetColorPalette(color0, color1, allowThreeColors, palette);
+			const bool isThreeColors{ allowThreeColors && color0 <= color1 };
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				const uint32_t paletteIdx{ (indices >> (texelIdx * 2)) & 3 };
+				const uint32_t alpha{ isThreeColors && paletteIdx == 3 ? 0u : 255u };
+				pBlock[texelIdx] = palette[paletteIdx][0] | (palette[paletteIdx][1] << 8) | (palette[paletteIdx][2] << 16) | (alpha << 24);
+			}
+		}
+
+		//// BC4 single channel block: 2 x 8 bit endpoints, 3 bit index per texel ////
+		struct ValueBlock
+		{
+			uint8_t value0;
+			uint8_t value1;
+			uint64_t indices; // 48 bits, texel 0 in the lowest bits
+			int error;
+		};
+
+		// value0 > value1: 8 values. Otherwise 6 values + 0 and 255.
+		void GetValuePalette(int value0, int value1, int palette[8])
+		{
+			palette[0] = value0;
+			palette[1] = value1;
+			if (value0 > value1)
+			{
+				for (int step{ 1 }; step < 7; ++step) palette[step + 1] = ((7 - step) * value0 + step * value1 + 3) / 7;
+				return;
+			}
+			for (int step{ 1 }; step < 5; ++step) palette[step + 1] = ((5 - step) * value0 + step * value1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		ValueBlock EvaluateValueBlock(const int values[g_NrOfBlockTexels], int value0, int value1)
+		{
+			int palette[8];
+			GetValuePalette(value0, value1, palette);
+
+			ValueBlock block{ static_cast<uint8_t>(value0), static_cast<uint8_t>(value1), 0, 0 };
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				int bestIdx{};
+				int bestError{ INT_MAX };
+				for (int paletteIdx{}; paletteIdx < 8; ++paletteIdx)
+				{
+					const int difference{ values[texelIdx] - palette[paletteIdx] };
+					if (difference * difference < bestError)
+					{
+						bestError = difference * difference;
+						bestIdx = paletteIdx;
+					}
+				}
+				block.indices |= static_cast<uint64_t>(bestIdx) << (texelIdx * 3);
+				block.error += bestError;
+			}
+			return block;
+		}
+
+		ValueBlock EncodeValueBlock(const uint32_t* pBlock, int channel, CompressionQuality quality)
+		{
+			int values[g_NrOfBlockTexels];
+			int minValue{ 255 };
+			int maxValue{};
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+			{
+				values[texelIdx] = GetChannel(pBlock[texelIdx], channel);
+				minValue = std::min(minValue, values[texelIdx]);
+				maxValue = std::max(maxValue, values[texelIdx]);
+			}
+
+			// Fast: 8 values between the extremes
+			ValueBlock best{ EvaluateValueBlock(values, maxValue, minValue) };
+			if (quality == CompressionQuality::Fast || best.error == 0) return best;
+
+			// Quality: least squares endpoints for the chosen indices (8 value mode)
+			for (int iteration{}; iteration < 2; ++iteration)
+			{
+				float alphaAlpha{}, betaBeta{}, alphaBeta{}, alphaValue{}, betaValue{};
+				for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+				{
+					const int paletteIdx{ static_cast<int>((best.indices >> (texelIdx * 3)) & 7) };
+					const float alpha{ paletteIdx == 0 ? 1.f : (paletteIdx == 1 ? 0.f : (8 - paletteIdx) / 7.f) };
+					const float beta{ 1.f - alpha };
+					alphaAlpha += alpha * alpha;
+					betaBeta += beta * beta;
+					alphaBeta += alpha * beta;
+					alphaValue += alpha * values[texelIdx];
+					betaValue += beta * values[texelIdx];
+				}
+				const float determinant{ alphaAlpha * betaBeta - alphaBeta * alphaBeta };
+				if (std::abs(determinant) < FLT_EPSILON) break;
+
+				const int value0{ std::clamp(static_cast<int>((betaBeta * alphaValue - alphaBeta * betaValue) / determinant + 0.5f), 0, 255) };
+				const int value1{ std::clamp(static_cast<int>((alphaAlpha * betaValue - alphaBeta * alphaValue) / determinant + 0.5f), 0, 255) };
+				if (value0 <= value1) break;
+
+				const ValueBlock fitted{ EvaluateValueBlock(values, value0, value1) };
+				if (fitted.error >= best.error) break;
+				best = fitted;
+			}
+
+			// small steps on both endpoints, staying in 8 value mode
+			const int center0{ best.value0 };
+			const int center1{ best.value1 };
+			for (int delta0{ -2 }; delta0 <= 2; ++delta0)
+			{
+				for (int delta1{ -2 }; delta1 <= 2; ++delta1)
+				{
+					const int value0{ center0 + delta0 };
+					const int value1{ center1 + delta1 };
+					if ((delta0 == 0 && delta1 == 0) || value0 > 255 || value1 < 0 || value0 <= value1) continue;
+
+					const ValueBlock adjusted{ EvaluateValueBlock(values, value0, value1) };
+					if (adjusted.error < best.error) best = adjusted;
+				}
+			}
+
+			// 6 values between the extremes other than 0 and 255, which are exact in this mode
+			int innerMin{ 255 };
+			int innerMax{};
+			for (const int value : values)
+			{
+				if (value == 0 || value == 255) continue;
+				innerMin = std::min(innerMin, value);
+				innerMax = std::max(innerMax, value);
+			}
+			if (innerMin <= innerMax)
+			{
+				const ValueBlock sixValues{ EvaluateValueBlock(values, innerMin, innerMax) };
+				if (sixValues.error < best.error) best = sixValues;
+			}
+			return best;
+		}
+
+		void WriteValueBlock(const ValueBlock& block, uint8_t* pOut)
+		{
+			pOut[0] = block.value0;
+			pOut[1] = block.value1;
+			for (int byteIdx{}; byteIdx < 6; ++byteIdx) pOut[2 + byteIdx] = static_cast<uint8_t>(block.indices >> (byteIdx * 8));
+		}
+
+		void DecodeValueBlock(const uint8_t* pIn, int values[g_NrOfBlockTexels])
+		{
+			int palette[8];
+			GetValuePalette(pIn[0], pIn[1], palette);
+
+			uint64_t indices{};
+			for (int byteIdx{}; byteIdx < 6; ++byteIdx) indices |= static_cast<uint64_t>(pIn[2 + byteIdx]) << (byteIdx * 8);
+			for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx) values[texelIdx] = palette[(indices >> (texelIdx * 3)) & 7];
+		}
+
+		void EncodeBlock(const uint32_t* pBlock, const CompressionSettings& settings, uint8_t* pOut)
+		{
+			switch (settings.format)
+			{
+			case BlockFormat::BC1:
+				WriteColorBlock(EncodeColorBlock(pBlock, settings.quality), pOut);
+				break;
+			case BlockFormat::BC3:
+				WriteValueBlock(EncodeValueBlock(pBlock, 3, settings.quality), pOut);
+				WriteColorBlock(EncodeColorBlock(pBlock, settings.quality), pOut + 8);
+				break;
+			case BlockFormat::BC4:
+				WriteValueBlock(EncodeValueBlock(pBlock, 0, settings.quality), pOut);
+				break;
+			case BlockFormat::BC5:
+				WriteValueBlock(EncodeValueBlock(pBlock, 0, settings.quality), pOut);
+				WriteValueBlock(EncodeValueBlock(pBlock, 1, settings.quality), pOut + 8);
+				break;
+			default:
+				break;
+			}
+		}
+
+		void DecodeBlock(const uint8_t* pIn, BlockFormat format, uint32_t* pBlock)
+		{
+			int red[g_NrOfBlockTexels], green[g_NrOfBlockTexels];
+			switch (format)
+			{
+			case BlockFormat::BC1:
+				DecodeColorBlock(pIn, true, pBlock);
+				break;
+			case BlockFormat::BC3:
+				DecodeValueBlock(pIn, red);
+				DecodeColorBlock(pIn + 8, false, pBlock);
+				for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx) pBlock[texelIdx] = (pBlock[texelIdx] & 0x00FFFFFF) | (static_cast<uint32_t>(red[texelIdx]) << 24);
+				break;
+			case BlockFormat::BC4:
+				DecodeValueBlock(pIn, red);
+				for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx) pBlock[texelIdx] = static_cast<uint32_t>(red[texelIdx]) | 0xFF000000;
+				break;
+			case BlockFormat::BC5:
+				DecodeValueBlock(pIn, red);
+				DecodeValueBlock(pIn + 8, green);
+				for (int texelIdx{}; texelIdx < g_NrOfBlockTexels; ++texelIdx)
+				{
+					// unit length tangent space normal, z >= 0
+					const float x{ red[texelIdx] / 255.f * 2.f - 1.f };
+					const float y{ green[texelIdx] / 255.f * 2.f - 1.f };
+					const float z{ std::sqrt(std::max(1.f - x * x - y * y, 0.f)) };
+					const uint32_t blue{ static_cast<uint32_t>((z * 0.5f + 0.5f) * 255.f + 0.5f) };
+					pBlock[texelIdx] = static_cast<uint32_t>(red[texelIdx]) | (static_cast<uint32_t>(green[texelIdx]) << 8) | (blue << 16) | 0xFF000000;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	size_t GetBlockSize(BlockFormat format)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1:
+		case BlockFormat::BC4:
+			return 8;
+		case BlockFormat::BC3:
+		case BlockFormat::BC5:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	size_t GetCompressedSize(BlockFormat format, int width, int height)
+	{
+		return GetBlockRowPitch(format, width) * GetNrOfBlocks(height);
+	}
+
+	size_t GetBlockRowPitch(BlockFormat format, int width)
+	{
+		return GetBlockSize(format) * GetNrOfBlocks(width);
+	}
+
+	std::vector<uint8_t> CompressTexels(const uint32_t* pTexels, std::span<const TextureLevel> levels, const CompressionSettings& settings, uint32_t nrOfThreads)
+	{
+		size_t compressedSize{};
+		for (const TextureLevel& level : levels) compressedSize += GetCompressedSize(settings.format, level.width, level.height);
+		std::vector<uint8_t> blocks(compressedSize);
+		if (compressedSize == 0) return blocks;
+
+		TileScheduler scheduler{ nrOfThreads };
+		const size_t blockSize{ GetBlockSize(settings.format) };
+		size_t levelOffset{};
+		for (const TextureLevel& level : levels)
+		{
+			const uint32_t* pLevelTexels{ pTexels + level.offset };
+			const int nrOfBlocksX{ GetNrOfBlocks(level.width) };
+			uint8_t* pLevelBlocks{ blocks.data() + levelOffset };
+
+			// one task per row of blocks
+			scheduler.Run(static_cast<uint32_t>(GetNrOfBlocks(level.height)), [&](uint32_t blockY, uint32_t)
+				{
+					uint32_t block[g_NrOfBlockTexels];
+					for (int blockX{}; blockX < nrOfBlocksX; ++blockX)
+					{
+						LoadBlock(pLevelTexels, level.width, level.height, blockX, static_cast<int>(blockY), block);
+						EncodeBlock(block, settings, pLevelBlocks + (static_cast<size_t>(blockY) * nrOfBlocksX + blockX) * blockSize);
+					}
+				});
+			levelOffset += GetCompressedSize(settings.format, level.width, level.height);
+		}
+		return blocks;
+	}
+
+	void DecompressTexels(const uint8_t* pBlocks, BlockFormat format, std::span<const TextureLevel> levels, uint32_t* pTexels)
+	{
+		const size_t blockSize{ GetBlockSize(format) };
+		for (const TextureLevel& level : levels)
+		{
+			const int nrOfBlocksX{ GetNrOfBlocks(level.width) };
+			const int nrOfBlocksY{ GetNrOfBlocks(level.height) };
+			uint32_t block[g_NrOfBlockTexels];
+			for (int blockY{}; blockY < nrOfBlocksY; ++blockY)
+			{
+				for (int blockX{}; blockX < nrOfBlocksX; ++blockX)
+				{
+					DecodeBlock(pBlocks, format, block);
+					StoreBlock(block, level.width, level.height, blockX, blockY, pTexels + level.offset);
+					pBlocks += blockSize;
+				}
+			}
+		}
+	}
+
+	namespace Utils
+	{
+		bool BenchmarkTextureCompression(const std::string& path, int nrOfRuns)
+		{
+			const std::unique_ptr<Texture> pTexture{ Texture::LoadFromFile(nullptr, path, MipSettings{ MipFilter::None }) };
+			if (!pTexture) return false;
+
+			const TextureLevel topLevel{ pTexture->GetLevels()[0] };
+			const std::span<const TextureLevel> levels{ &topLevel, 1 };
+			const size_t nrOfTexels{ static_cast<size_t>(topLevel.width) * topLevel.height };
+			std::cout << "Texture Compression Benchmark: " << path << " (" << topLevel.width << "x" << topLevel.height << "), "
+				<< TileScheduler{}.GetNrOfThreads() << " threads\n";
+
+			struct FormatInfo
+			{
+				BlockFormat format;
+				const char* pName;
+				int nrOfChannels; // compared for the PSNR
+			};
+			constexpr FormatInfo formats[4]{ { BlockFormat::BC1, "BC1", 3 }, { BlockFormat::BC3, "BC3", 4 }, { BlockFormat::BC4, "BC4", 1 }, { BlockFormat::BC5, "BC5", 2 } };
+
+			bool isValid{ true };
+			std::vector<uint32_t> decoded(nrOfTexels);
+			for (const FormatInfo& info : formats)
+			{
+				double psnr[2]{};
+				for (const CompressionQuality quality : { CompressionQuality::Fast, CompressionQuality::Quality })
+				{
+					const CompressionSettings settings{ info.format, quality };
+					double bestMs{ DBL_MAX };
+					std::vector<uint8_t> blocks;
+					for (int run{}; run < nrOfRuns; ++run)
+					{
+						const auto startTime{ std::chrono::steady_clock::now() };
+						blocks = CompressTexels(pTexture->GetTexels(), levels, settings);
+						bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+					}
+
+					// BC5 rebuilds blue, only the stored channels count
+					DecompressTexels(blocks.data(), info.format, levels, decoded.data());
+					double squaredError{};
+					for (size_t texelIdx{}; texelIdx < nrOfTexels; ++texelIdx)
+					{
+						for (int channel{}; channel < info.nrOfChannels; ++channel)
+						{
+							const int difference{ GetChannel(decoded[texelIdx], channel) - GetChannel(pTexture->GetTexels()[texelIdx], channel) };
+							squaredError += difference * difference;
+						}
+					}
+					const double meanSquaredError{ squaredError / (static_cast<double>(nrOfTexels) * info.nrOfChannels) };
+					const int qualityIdx{ static_cast<int>(quality) };
+					psnr[qualityIdx] = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+
+					std::cout << "  " << info.pName << (quality == CompressionQuality::Fast ? " fast:    " : " quality: ") << bestMs << " ms, "
+						<< nrOfTexels / (bestMs * 1000.0) << " M texels/s, PSNR " << psnr[qualityIdx] << " dB, "
+						<< nrOfTexels * sizeof(uint32_t) / blocks.size() << ":1 vs R8G8B8A8\n";
+				}
+
+				// quality also evaluates the fast endpoints, it can never be worse
+				if (psnr[1] < psnr[0]) isValid = false;
+			}
+			std::cout << "  Compression: " << (isValid ? "OK" : "QUALITY WORSE THAN FAST") << "\n";
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#include "Texture.h"
+
+namespace dae
+{
+	// bytes per 4x4 block (8 for BC1 / BC4, 16 for BC3 / BC5)
+	size_t GetBlockSize(BlockFormat format);
+	// bytes of one level, levels smaller than a block still take a whole block
+	size_t GetCompressedSize(BlockFormat format, int width, int height);
+	// bytes per row of blocks (D3D11_SUBRESOURCE_DATA::SysMemPitch)
+	size_t GetBlockRowPitch(BlockFormat format, int width);
+
+	// Encodes every level of texels (R8G8B8A8, see Texture::GetTexels) into format, levels one after the
+	// other. Rows of blocks are spread over nrOfThreads (0: one per hardware thread).
+	// Fast: bounding box endpoints. Quality: principal axis endpoints refined by least squares and a
+	// search around them (BC1 / BC3 color), min / max vs least squares and the 6 value mode (BC4 / BC5),
+	// whichever has the smallest error.
+	std::vector<uint8_t> CompressTexels(const uint32_t* pTexels, std::span<const TextureLevel> levels, const CompressionSettings& settings, uint32_t nrOfThreads = 0);
+
+	// Decodes blocks back to R8G8B8A8 the way the GPU samples them: BC4 as (r, 0, 0, 1), BC5 as
+	// (r, g, b, 1) with b rebuilt from the unit length of the normal
+	void DecompressTexels(const uint8_t* pBlocks, BlockFormat format, std::span<const TextureLevel> levels, uint32_t* pTexels);
+
+	namespace Utils
+	{
+		// encoder throughput and PSNR of every format / quality on the top level of a texture file
+		bool BenchmarkTextureCompression(const std::string& path, int nrOfRuns = 3);
+	}
+}
+
+#endif // !TEXTURECOMPRESSOR_H
\ No newline at end of file
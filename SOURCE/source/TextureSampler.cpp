@@ -0,0 +1,613 @@
+#include "pch.h"
+#include "TextureSampler.h"
+#include "Texture.h"
+
+#include <bit>
+#include <chrono>
+#include <random>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr int g_MaxAnisotropy{ 16 }; // MaxAnisotropy of gSamAnisotropic
+
+		// bilinear: 8 bit texel fractions, 8.8 fixed point per channel after the horizontal lerp, 8.7 after the
+		// vertical one (a signed 16 bit difference times a 15 bit weight, like _mm256_mulhrs_epi16)
+		constexpr int g_FractionBits{ 8 };
+		constexpr int32_t g_FractionOne{ 1 << g_FractionBits };
+		constexpr int32_t g_HalfTexel{ g_FractionOne / 2 };
+		constexpr int32_t g_FilteredOne{ 1 << 7 };
+		constexpr float g_DivByteMax{ 1.f / 255.f };
+		constexpr float g_DivFilteredMax{ 1.f / (255.f * g_FilteredOne) };
+
+		// log2(1 + t) = t * p(t) for t in [0, 1), 7.7e-4 absolute error: far below the 1/256 the level fraction resolves
+		constexpr float g_Log2Coefficients[3]{ 1.424583357f, -0.5891725926f, 0.1653592083f };
+		// footprints below this have no mip level to pick, avoids log2(0)
+		constexpr float g_MinSqrLength{ 1e-20f };
+
+		static_assert(sizeof(TextureLevel) == 3 * sizeof(int32_t), "TextureLevel is gathered as 3 ints");
+
+		inline float Log2(float x)
+		{
+			const uint32_t bits{ std::bit_cast<uint32_t>(x) };
+			const float exponent{ static_cast<float>(static_cast<int32_t>(bits >> 23) - 127) };
+			const float t{ std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u) - 1.f };
+			return t * ((g_Log2Coefficients[2] * t + g_Log2Coefficients[1]) * t + g_Log2Coefficients[0]) + exponent;
+		}
+
+		// log2 of the footprint length in top level texels
+		inline float GetLod(float sqrLength)
+		{
+			return 0.5f * Log2(std::max(sqrLength, g_MinSqrLength));
+		}
+
+		inline int32_t GetPointTexel(float coordinate, int32_t size)
+		{
+			const float wrapped{ coordinate - std::floor(coordinate) };
+			const int32_t texel{ static_cast<int32_t>(wrapped * static_cast<float>(size)) };
+			return texel == size ? 0 : texel;
+		}
+
+		// wrap addressing of the 2 texels around a coordinate, fraction in 1/256 texel
+		inline void GetBilinearTexels(float coordinate, int32_t size, int32_t& texel0, int32_t& texel1, int32_t& fraction)
+		{
+			const float wrapped{ coordinate - std::floor(coordinate) };
+			const int32_t fixed{ static_cast<int32_t>(std::nearbyint(wrapped * static_cast<float>(size << g_FractionBits))) - g_HalfTexel };
+			// wrapped in [0, 1] puts texel0 in [-1, size - 1]
+			texel0 = fixed >> g_FractionBits;
+			fraction = fixed & (g_FractionOne - 1);
+			if (texel0 < 0) texel0 += size;
+			texel1 = texel0 + 1 == size ? 0 : texel0 + 1;
+		}
+
+		inline TextureSample ToColor(uint32_t texel)
+		{
+			return { ColorRGB{ (texel & 0xFF) * g_DivByteMax, ((texel >> 8) & 0xFF) * g_DivByteMax, ((texel >> 16) & 0xFF) * g_DivByteMax }, (texel >> 24) * g_DivByteMax };
+		}
+
+		inline TextureSample Lerp(const TextureSample& sample0, const TextureSample& sample1, float fraction)
+		{
+			return { sample0.color + (sample1.color - sample0.color) * fraction, sample0.alpha + (sample1.alpha - sample0.alpha) * fraction };
+		}
+
+		// texels: (x0, y0), (x1, y0), (x0, y1), (x1, y1). Horizontal lerp to 8.8 fixed point, vertical one as
+		// top + (bottom - top) * weight in 8.7 (rounded like _mm256_mulhrs_epi16), the same integer math as the
+		// AVX2 version. Both weights sum to exactly one, equal texels filter to themselves.
+		inline TextureSample Bilerp(const uint32_t texels[4], int32_t fractionX, int32_t fractionY)
+		{
+			const uint32_t weightX1{ static_cast<uint32_t>(fractionX) };
+			const uint32_t weightX0{ g_FractionOne - weightX1 };
+			const int32_t weightY1{ fractionY << 7 };
+
+			float channels[4];
+			for (int channel{}; channel < 4; ++channel)
+			{
+				const int shift{ channel * 8 };
+				const int32_t top{ static_cast<int32_t>((((texels[0] >> shift) & 0xFF) * weightX0 + ((texels[1] >> shift) & 0xFF) * weightX1) >> 1) };
+				const int32_t bottom{ static_cast<int32_t>((((texels[2] >> shift) & 0xFF) * weightX0 + ((texels[3] >> shift) & 0xFF) * weightX1) >> 1) };
+				channels[channel] = static_cast<float>(top + (((bottom - top) * weightY1 + 0x4000) >> 15)) * g_DivFilteredMax;
+			}
+			return { ColorRGB{ channels[0], channels[1], channels[2] }, channels[3] };
+		}
+
+		TextureSample SamplePoint(const uint32_t* pTexels, const TextureLevel& level, const Vector2& uv)
+		{
+			const int32_t x{ GetPointTexel(uv.x, level.width) };
+			const int32_t y{ GetPointTexel(uv.y, level.height) };
+			return ToColor(pTexels[level.offset + y * level.width + x]);
+		}
+
+		TextureSample SampleBilinear(const uint32_t* pTexels, const TextureLevel& level, const Vector2& uv)
+		{
+			int32_t x0, x1, fractionX;
+			int32_t y0, y1, fractionY;
+			GetBilinearTexels(uv.x, level.width, x0, x1, fractionX);
+			GetBilinearTexels(uv.y, level.height, y0, y1, fractionY);
+
+			const uint32_t* pRow0{ pTexels + level.offset + y0 * level.width };
+			const uint32_t* pRow1{ pTexels + level.offset + y1 * level.width };
+			const uint32_t texels[4]{ pRow0[x0], pRow0[x1], pRow1[x0], pRow1[x1] };
+			return Bilerp(texels, fractionX, fractionY);
+		}
+
+		TextureSample SampleTrilinear(const uint32_t* pTexels, std::span<const TextureLevel> levels, const Vector2& uv, float lod)
+		{
+			const int maxLevel{ static_cast<int>(levels.size()) - 1 };
+			const float clampedLod{ std::clamp(lod, 0.f, static_cast<float>(maxLevel)) };
+			const float levelFloor{ std::floor(clampedLod) };
+			const float fraction{ clampedLod - levelFloor };
+			const int level0{ static_cast<int>(levelFloor) };
+
+			const TextureSample sample0{ SampleBilinear(pTexels, levels[level0], uv) };
+			if (fraction == 0.f) return sample0;
+
+			const TextureSample sample1{ SampleBilinear(pTexels, levels[std::min(level0 + 1, maxLevel)], uv) };
+			return Lerp(sample0, sample1, fraction);
+		}
+
+#if defined(__AVX2__)
+		inline Float8 Log2(const Float8& x)
+		{
+			const __m256i bits{ _mm256_castps_si256(x.value) };
+			const Float8 exponent{ _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127))) };
+			const Float8 mantissa{ _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000))) };
+			const Float8 t{ mantissa - Float8::Broadcast(1.f) };
+			const Float8 polynomial{ MultiplyAdd(MultiplyAdd(Float8::Broadcast(g_Log2Coefficients[2]), t, Float8::Broadcast(g_Log2Coefficients[1])), t,
+				Float8::Broadcast(g_Log2Coefficients[0])) };
+			return MultiplyAdd(t, polynomial, exponent);
+		}
+
+		inline Float8 GetLod(const Float8& sqrLength)
+		{
+			return Float8::Broadcast(0.5f) * Log2(Max(sqrLength, Float8::Broadcast(g_MinSqrLength)));
+		}
+
+		inline Float8 Floor(const Float8& x)
+		{
+			return { _mm256_floor_ps(x.value) };
+		}
+
+		// offset, width and height of the level of every lane
+		struct LevelLanes
+		{
+			__m256i offset;
+			__m256i width;
+			__m256i height;
+		};
+
+		inline LevelLanes GatherLevels(const TextureLevel* pLevels, __m256i level)
+		{
+			const int* pFirst{ reinterpret_cast<const int*>(pLevels) };
+			const __m256i index{ _mm256_mullo_epi32(level, _mm256_set1_epi32(3)) };
+			return { _mm256_i32gather_epi32(pFirst, index, 4), _mm256_i32gather_epi32(pFirst + 1, index, 4), _mm256_i32gather_epi32(pFirst + 2, index, 4) };
+		}
+
+		inline __m256i GetPointTexels(const Float8& coordinate, __m256i size)
+		{
+			const Float8 wrapped{ coordinate - Floor(coordinate) };
+			const __m256i texel{ _mm256_cvttps_epi32((wrapped * Float8{ _mm256_cvtepi32_ps(size) }).value) };
+			return _mm256_andnot_si256(_mm256_cmpeq_epi32(texel, size), texel);
+		}
+
+		inline void GetBilinearTexels(const Float8& coordinate, __m256i size, __m256i& texel0, __m256i& texel1, __m256i& fraction)
+		{
+			const Float8 wrapped{ coordinate - Floor(coordinate) };
+			const Float8 scale{ _mm256_cvtepi32_ps(_mm256_slli_epi32(size, g_FractionBits)) };
+			const __m256i fixed{ _mm256_sub_epi32(_mm256_cvtps_epi32((wrapped * scale).value), _mm256_set1_epi32(g_HalfTexel)) };
+			texel0 = _mm256_srai_epi32(fixed, g_FractionBits);
+			fraction = _mm256_and_si256(fixed, _mm256_set1_epi32(g_FractionOne - 1));
+			texel0 = _mm256_add_epi32(texel0, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), texel0), size));
+			texel1 = _mm256_add_epi32(texel0, _mm256_set1_epi32(1));
+			texel1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(texel1, size), texel1);
+		}
+
+		// alpha is only converted / filtered when HasAlpha, it stays 0 otherwise
+		template<bool HasAlpha>
+		inline TextureSample8 ToColor(__m256i texels)
+		{
+			const __m256i byteMask{ _mm256_set1_epi32(0xFF) };
+			const Float8 divByteMax{ Float8::Broadcast(g_DivByteMax) };
+			return {
+				Vector3x8{
+					Float8{ _mm256_cvtepi32_ps(_mm256_and_si256(texels, byteMask)) } * divByteMax,
+					Float8{ _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(texels, 8), byteMask)) } * divByteMax,
+					Float8{ _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(texels, 16), byteMask)) } * divByteMax },
+				HasAlpha ? Float8{ _mm256_cvtepi32_ps(_mm256_srli_epi32(texels, 24)) } * divByteMax : Float8::Broadcast(0.f)
+			};
+		}
+
+		template<bool HasAlpha>
+		inline TextureSample8 Lerp(const TextureSample8& sample0, const TextureSample8& sample1, const Float8& fraction)
+		{
+			const Vector3x8& color0{ sample0.color };
+			const Vector3x8& color1{ sample1.color };
+			return {
+				Vector3x8{ MultiplyAdd(color1.x - color0.x, fraction, color0.x), MultiplyAdd(color1.y - color0.y, fraction, color0.y), MultiplyAdd(color1.z - color0.z, fraction, color0.z) },
+				HasAlpha ? MultiplyAdd(sample1.alpha - sample0.alpha, fraction, sample0.alpha) : sample0.alpha
+			};
+		}
+
+		// 16 bit per channel: every 128 bit half of a texel register unpacks to 2 texels (RGBA) per register,
+		// texels 0, 1 | 4, 5 from the low bytes and 2, 3 | 6, 7 from the high bytes
+		template<bool HasAlpha>
+		inline TextureSample8 Bilerp(__m256i texel00, __m256i texel10, __m256i texel01, __m256i texel11, __m256i fractionX, __m256i fractionY)
+		{
+			const __m256i zero{ _mm256_setzero_si256() };
+
+			// weight of a texel repeated over its 4 channels, in the unpack order
+			const __m256i pairX{ _mm256_or_si256(fractionX, _mm256_slli_epi32(fractionX, 16)) };
+			const __m256i pairY{ _mm256_or_si256(fractionY, _mm256_slli_epi32(fractionY, 16)) };
+			const __m256i weightsX1[2]{ _mm256_unpacklo_epi32(pairX, pairX), _mm256_unpackhi_epi32(pairX, pairX) };
+			const __m256i weightsY1[2]{ _mm256_slli_epi16(_mm256_unpacklo_epi32(pairY, pairY), 7), _mm256_slli_epi16(_mm256_unpackhi_epi32(pairY, pairY), 7) };
+
+			__m256i filtered[2];
+			for (int half{}; half < 2; ++half)
+			{
+				const auto unpack = [&](__m256i texels) { return half == 0 ? _mm256_unpacklo_epi8(texels, zero) : _mm256_unpackhi_epi8(texels, zero); };
+				const __m256i weightX1{ weightsX1[half] };
+				const __m256i weightX0{ _mm256_sub_epi16(_mm256_set1_epi16(g_FractionOne), weightX1) };
+				const __m256i weightY1{ weightsY1[half] };
+
+				// <= 255 * 256 fits unsigned 16 bit, halved to 8.7 the difference fits signed 16 bit
+				const __m256i top{ _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(unpack(texel00), weightX0), _mm256_mullo_epi16(unpack(texel10), weightX1)), 1) };
+				const __m256i bottom{ _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(unpack(texel01), weightX0), _mm256_mullo_epi16(unpack(texel11), weightX1)), 1) };
+				filtered[half] = _mm256_add_epi16(top, _mm256_mulhrs_epi16(_mm256_sub_epi16(bottom, top), weightY1));
+			}
+
+			// 32 bit RGBA of texels 0 | 4, 1 | 5, 2 | 6 and 3 | 7, transposed to SoA
+			const __m256i texels04{ _mm256_unpacklo_epi16(filtered[0], zero) };
+			const __m256i texels15{ _mm256_unpackhi_epi16(filtered[0], zero) };
+			const __m256i texels26{ _mm256_unpacklo_epi16(filtered[1], zero) };
+			const __m256i texels37{ _mm256_unpackhi_epi16(filtered[1], zero) };
+			const __m256i redGreen01{ _mm256_unpacklo_epi32(texels04, texels15) };
+			const __m256i redGreen23{ _mm256_unpacklo_epi32(texels26, texels37) };
+			const __m256i blueAlpha01{ _mm256_unpackhi_epi32(texels04, texels15) };
+			const __m256i blueAlpha23{ _mm256_unpackhi_epi32(texels26, texels37) };
+
+			const Float8 divFilteredMax{ Float8::Broadcast(g_DivFilteredMax) };
+			return {
+				Vector3x8{
+					Float8{ _mm256_cvtepi32_ps(_mm256_unpacklo_epi64(redGreen01, redGreen23)) } * divFilteredMax,
+					Float8{ _mm256_cvtepi32_ps(_mm256_unpackhi_epi64(redGreen01, redGreen23)) } * divFilteredMax,
+					Float8{ _mm256_cvtepi32_ps(_mm256_unpacklo_epi64(blueAlpha01, blueAlpha23)) } * divFilteredMax },
+				HasAlpha ? Float8{ _mm256_cvtepi32_ps(_mm256_unpackhi_epi64(blueAlpha01, blueAlpha23)) } * divFilteredMax : Float8::Broadcast(0.f)
+			};
+		}
+
+		template<bool HasAlpha>
+		TextureSample8 SamplePoint(const uint32_t* pTexels, const TextureLevel* pLevels, __m256i level, const Vector2x8& uv)
+		{
+			const LevelLanes lanes{ GatherLevels(pLevels, level) };
+			const __m256i x{ GetPointTexels(uv.x, lanes.width) };
+			const __m256i y{ GetPointTexels(uv.y, lanes.height) };
+			const __m256i index{ _mm256_add_epi32(_mm256_add_epi32(lanes.offset, _mm256_mullo_epi32(y, lanes.width)), x) };
+			return ToColor<HasAlpha>(_mm256_i32gather_epi32(reinterpret_cast<const int*>(pTexels), index, 4));
+		}
+
+		template<bool HasAlpha>
+		TextureSample8 SampleBilinear(const uint32_t* pTexels, const TextureLevel* pLevels, __m256i level, const Vector2x8& uv)
+		{
+			const LevelLanes lanes{ GatherLevels(pLevels, level) };
+			__m256i x0, x1, fractionX;
+			__m256i y0, y1, fractionY;
+			GetBilinearTexels(uv.x, lanes.width, x0, x1, fractionX);
+			GetBilinearTexels(uv.y, lanes.height, y0, y1, fractionY);
+
+			const int* pBase{ reinterpret_cast<const int*>(pTexels) };
+			const __m256i row0{ _mm256_add_epi32(lanes.offset, _mm256_mullo_epi32(y0, lanes.width)) };
+			const __m256i row1{ _mm256_add_epi32(lanes.offset, _mm256_mullo_epi32(y1, lanes.width)) };
+			return Bilerp<HasAlpha>(
+				_mm256_i32gather_epi32(pBase, _mm256_add_epi32(row0, x0), 4),
+				_mm256_i32gather_epi32(pBase, _mm256_add_epi32(row0, x1), 4),
+				_mm256_i32gather_epi32(pBase, _mm256_add_epi32(row1, x0), 4),
+				_mm256_i32gather_epi32(pBase, _mm256_add_epi32(row1, x1), 4),
+				fractionX, fractionY);
+		}
+
+		template<bool HasAlpha>
+		TextureSample8 SampleTrilinear(const uint32_t* pTexels, std::span<const TextureLevel> levels, const Vector2x8& uv, const Float8& lod)
+		{
+			const Float8 maxLevel{ Float8::Broadcast(static_cast<float>(levels.size() - 1)) };
+			const Float8 clampedLod{ Min(Max(lod, Float8::Broadcast(0.f)), maxLevel) };
+			const Float8 levelFloor{ Floor(clampedLod) };
+			const Float8 fraction{ clampedLod - levelFloor };
+			const __m256i level0{ _mm256_cvtps_epi32(levelFloor.value) };
+
+			const TextureSample8 sample0{ SampleBilinear<HasAlpha>(pTexels, levels.data(), level0, uv) };
+			// magnification, or every lane exactly on a level
+			if (GetMaskBits(fraction > Float8::Broadcast(0.f)) == 0) return sample0;
+
+			const __m256i level1{ _mm256_min_epi32(_mm256_add_epi32(level0, _mm256_set1_epi32(1)), _mm256_cvtps_epi32(maxLevel.value)) };
+			return Lerp<HasAlpha>(sample0, SampleBilinear<HasAlpha>(pTexels, levels.data(), level1, uv), fraction);
+		}
+
+		template<bool HasAlpha>
+		TextureSample8 SampleLanes(const Texture& texture, const TextureCoordinates8& coordinates, FilteringMode filteringMode)
+		{
+			const uint32_t* pTexels{ texture.GetTexels() };
+			const std::span<const TextureLevel> levels{ texture.GetLevels() };
+
+			// footprint in top level texels
+			const Float8 width{ Float8::Broadcast(static_cast<float>(levels[0].width)) };
+			const Float8 height{ Float8::Broadcast(static_cast<float>(levels[0].height)) };
+			const Float8 ddxX{ coordinates.uvDdx.x * width };
+			const Float8 ddxY{ coordinates.uvDdx.y * height };
+			const Float8 ddyX{ coordinates.uvDdy.x * width };
+			const Float8 ddyY{ coordinates.uvDdy.y * height };
+			const Float8 sqrLengthX{ MultiplyAdd(ddxX, ddxX, ddxY * ddxY) };
+			const Float8 sqrLengthY{ MultiplyAdd(ddyX, ddyX, ddyY * ddyY) };
+
+			switch (filteringMode)
+			{
+			case FilteringMode::Point:
+			{
+				// nearest level
+				const Float8 maxLevel{ Float8::Broadcast(static_cast<float>(levels.size() - 1)) };
+				const Float8 lod{ GetLod(Max(sqrLengthX, sqrLengthY)) };
+				const Float8 level{ Min(Max(Floor(lod + Float8::Broadcast(0.5f)), Float8::Broadcast(0.f)), maxLevel) };
+				return SamplePoint<HasAlpha>(pTexels, levels.data(), _mm256_cvtps_epi32(level.value), coordinates.uv);
+			}
+			case FilteringMode::Linear:
+				return SampleTrilinear<HasAlpha>(pTexels, levels, coordinates.uv, GetLod(Max(sqrLengthX, sqrLengthY)));
+			case FilteringMode::Anisotropic:
+			{
+				// one tap per minor axis length along the major axis, at the level of the minor axis.
+				// Footprints below a texel (magnification) take a single tap
+				const Float8 one{ Float8::Broadcast(1.f) };
+				const Float8 isMajorX{ sqrLengthX >= sqrLengthY };
+				const Float8 sqrMajor{ Max(sqrLengthX, sqrLengthY) };
+				const Float8 sqrMinor{ Min(sqrLengthX, sqrLengthY) };
+				const Float8 ratio{ Sqrt(sqrMajor / Max(sqrMinor, Float8::Broadcast(g_MinSqrLength))) };
+				const Float8 nrOfTaps{ Select(sqrMajor > one,
+					Min(Max(Float8{ _mm256_ceil_ps(ratio.value) }, one), Float8::Broadcast(static_cast<float>(g_MaxAnisotropy))), one) };
+				const Float8 lod{ GetLod(sqrMajor) - Log2(nrOfTaps) };
+				const Float8 invNrOfTaps{ one / nrOfTaps };
+				const Vector2x8 axis{ Select(isMajorX, coordinates.uvDdx.x, coordinates.uvDdy.x), Select(isMajorX, coordinates.uvDdx.y, coordinates.uvDdy.y) };
+
+				alignas(32) float laneTaps[Float8::NrOfLanes];
+				nrOfTaps.Store(laneTaps);
+				const int maxNrOfTaps{ static_cast<int>(*std::max_element(std::begin(laneTaps), std::end(laneTaps))) };
+
+				const Float8 zero{ Float8::Broadcast(0.f) };
+				Vector3x8 sum{ zero, zero, zero };
+				Float8 alphaSum{ zero };
+				for (int tap{}; tap < maxNrOfTaps; ++tap)
+				{
+					const Float8 tapIdx{ Float8::Broadcast(static_cast<float>(tap)) };
+					const Float8 offset{ (tapIdx + Float8::Broadcast(0.5f)) * invNrOfTaps - Float8::Broadcast(0.5f) };
+					const Float8 isActive{ tapIdx < nrOfTaps };
+					const TextureSample8 sample{ SampleTrilinear<HasAlpha>(pTexels, levels, coordinates.uv + axis * offset, lod) };
+					sum = sum + Vector3x8{ sample.color.x & isActive, sample.color.y & isActive, sample.color.z & isActive };
+					if constexpr (HasAlpha) alphaSum = alphaSum + (sample.alpha & isActive);
+				}
+				return { sum * invNrOfTaps, alphaSum * invNrOfTaps };
+			}
+			default:
+				return { Vector3x8::Broadcast(Vector3{ 1.f, 0.f, 1.f }), Float8::Broadcast(1.f) };
+			}
+		}
+#endif
+	}
+
+	Vector3x8 SampleTexture(const Texture& texture, const TextureCoordinates8& coordinates, FilteringMode filteringMode)
+	{
+#if defined(__AVX2__)
+		return SampleLanes<false>(texture, coordinates, filteringMode).color;
+#else
+		return SampleTextureRGBA(texture, coordinates, filteringMode).color;
+#endif
+	}
+
+	TextureSample8 SampleTextureRGBA(const Texture& texture, const TextureCoordinates8& coordinates, FilteringMode filteringMode)
+	{
+#if defined(__AVX2__)
+		return SampleLanes<true>(texture, coordinates, filteringMode);
+#else
+		float channels[4][Float8::NrOfLanes];
+		for (int lane{}; lane < Float8::NrOfLanes; ++lane)
+		{
+			const TextureSample sample{ SampleTextureReferenceRGBA(texture, coordinates.uv.GetLane(lane), coordinates.uvDdx.GetLane(lane), coordinates.uvDdy.GetLane(lane), filteringMode) };
+			channels[0][lane] = sample.color.r;
+			channels[1][lane] = sample.color.g;
+			channels[2][lane] = sample.color.b;
+			channels[3][lane] = sample.alpha;
+		}
+		return { Vector3x8::Load(channels[0], channels[1], channels[2]), Float8::Load(channels[3]) };
+#endif
+	}
+
+	ColorRGB SampleTextureReference(const Texture& texture, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, FilteringMode filteringMode)
+	{
+		return SampleTextureReferenceRGBA(texture, uv, uvDdx, uvDdy, filteringMode).color;
+	}
+
+	TextureSample SampleTextureReferenceRGBA(const Texture& texture, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, FilteringMode filteringMode)
+	{
+		const uint32_t* pTexels{ texture.GetTexels() };
+		const std::span<const TextureLevel> levels{ texture.GetLevels() };
+
+		// footprint in top level texels
+		const Vector2 size{ static_cast<float>(levels[0].width), static_cast<float>(levels[0].height) };
+		const Vector2 ddx{ uvDdx.x * size.x, uvDdx.y * size.y };
+		const Vector2 ddy{ uvDdy.x * size.x, uvDdy.y * size.y };
+		const float sqrLengthX{ Vector2::Dot(ddx, ddx) };
+		const float sqrLengthY{ Vector2::Dot(ddy, ddy) };
+
+		switch (filteringMode)
+		{
+		case FilteringMode::Point:
+		{
+			const float maxLevel{ static_cast<float>(levels.size() - 1) };
+			const float level{ std::clamp(std::floor(GetLod(std::max(sqrLengthX, sqrLengthY)) + 0.5f), 0.f, maxLevel) };
+			return SamplePoint(pTexels, levels[static_cast<size_t>(level)], uv);
+		}
+		case FilteringMode::Linear:
+			return SampleTrilinear(pTexels, levels, uv, GetLod(std::max(sqrLengthX, sqrLengthY)));
+		case FilteringMode::Anisotropic:
+		{
+			const float sqrMajor{ std::max(sqrLengthX, sqrLengthY) };
+			const float sqrMinor{ std::min(sqrLengthX, sqrLengthY) };
+			const float ratio{ std::sqrt(sqrMajor / std::max(sqrMinor, g_MinSqrLength)) };
+			const float nrOfTaps{ sqrMajor > 1.f ? std::clamp(std::ceil(ratio), 1.f, static_cast<float>(g_MaxAnisotropy)) : 1.f };
+			const float lod{ GetLod(sqrMajor) - Log2(nrOfTaps) };
+			const float invNrOfTaps{ 1.f / nrOfTaps };
+			const Vector2 axis{ sqrLengthX >= sqrLengthY ? uvDdx : uvDdy };
+
+			TextureSample sum{};
+			for (int tap{}; tap < static_cast<int>(nrOfTaps); ++tap)
+			{
+				const float offset{ (tap + 0.5f) * invNrOfTaps - 0.5f };
+				const TextureSample sample{ SampleTrilinear(pTexels, levels, uv + axis * offset, lod) };
+				sum.color += sample.color;
+				sum.alpha += sample.alpha;
+			}
+			return { sum.color * invNrOfTaps, sum.alpha * invNrOfTaps };
+		}
+		default:
+			return { colors::Magenta, 1.f };
+		}
+	}
+
+	namespace Utils
+	{
+		bool BenchmarkTextureSampler(const std::string& path, size_t nrOfSamples)
+		{
+			const std::unique_ptr<Texture> pTexture{ Texture::LoadFromFile(nullptr, path) };
+			if (!pTexture) return false;
+
+			constexpr int nrOfLanes{ Float8::NrOfLanes };
+			nrOfSamples = std::max<size_t>((nrOfSamples + nrOfLanes - 1) / nrOfLanes * nrOfLanes, nrOfLanes);
+
+			// uv over several wraps, footprints from magnified to 64 texels, up to 32:1 anisotropic
+			std::mt19937 generator{ 42 };
+			std::uniform_real_distribution<float> uvDistribution{ -2.f, 3.f };
+			std::uniform_real_distribution<float> unitDistribution{ 0.f, 1.f };
+			const float texelSize{ 1.f / std::max(pTexture->GetWidth(), pTexture->GetHeight()) };
+
+			// SoA: u, v, ddx u, ddx v, ddy u, ddy v
+			std::vector<float> coordinates(nrOfSamples * 6);
+			const auto getSoA = [&](int component) { return coordinates.data() + nrOfSamples * component; };
+			for (size_t idx{}; idx < nrOfSamples; ++idx)
+			{
+				const float angle{ unitDistribution(generator) * 6.2831853f };
+				const float length{ texelSize * std::exp2(-3.f + 9.f * unitDistribution(generator)) };
+				const float anisotropy{ std::exp2(5.f * unitDistribution(generator)) };
+				const float values[6]{ uvDistribution(generator), uvDistribution(generator),
+					std::cos(angle) * length, std::sin(angle) * length,
+					-std::sin(angle) * length / anisotropy, std::cos(angle) * length / anisotropy };
+				for (int component{}; component < 6; ++component) getSoA(component)[idx] = values[component];
+			}
+			const auto getCoordinates = [&](size_t idx, float scale)
+				{
+					const Float8 derivativeScale{ Float8::Broadcast(scale) };
+					return TextureCoordinates8{
+						Vector2x8{ Float8::Load(getSoA(0) + idx), Float8::Load(getSoA(1) + idx) },
+						Vector2x8{ Float8::Load(getSoA(2) + idx) * derivativeScale, Float8::Load(getSoA(3) + idx) * derivativeScale },
+						Vector2x8{ Float8::Load(getSoA(4) + idx) * derivativeScale, Float8::Load(getSoA(5) + idx) * derivativeScale } };
+				};
+
+#if defined(__AVX2__)
+			const char* pInstructionSet{ "AVX2" };
+#else
+			const char* pInstructionSet{ "scalar" };
+#endif
+			std::cout << "Texture Sampler Benchmark: " << path << " (" << pTexture->GetWidth() << "x" << pTexture->GetHeight() << ", "
+				<< pTexture->GetLevels().size() << " levels), " << nrOfSamples << " samples, " << pInstructionSet << "\n";
+
+			const char* modeNames[3]{ "Point", "Linear", "Anisotropic" };
+			std::vector<float> colors(nrOfSamples * 4);
+			std::vector<TextureSample> referenceSamples(nrOfSamples);
+			bool isValid{ true };
+			for (int mode{}; mode < 3; ++mode)
+			{
+				const FilteringMode filteringMode{ static_cast<FilteringMode>(mode) };
+
+				const auto startTime{ std::chrono::steady_clock::now() };
+				for (size_t idx{}; idx < nrOfSamples; idx += nrOfLanes)
+				{
+					SampleTexture(*pTexture, getCoordinates(idx, 1.f), filteringMode).Store(colors.data() + idx, colors.data() + nrOfSamples + idx, colors.data() + nrOfSamples * 2 + idx);
+				}
+				const double sampleMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() };
+
+				// rgba overwrites the rgb results, they are checked against the reference below
+				const auto rgbaStart{ std::chrono::steady_clock::now() };
+				for (size_t idx{}; idx < nrOfSamples; idx += nrOfLanes)
+				{
+					const TextureSample8 sample{ SampleTextureRGBA(*pTexture, getCoordinates(idx, 1.f), filteringMode) };
+					sample.color.Store(colors.data() + idx, colors.data() + nrOfSamples + idx, colors.data() + nrOfSamples * 2 + idx);
+					sample.alpha.Store(colors.data() + nrOfSamples * 3 + idx);
+				}
+				const double rgbaMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rgbaStart).count() };
+
+				const auto referenceStart{ std::chrono::steady_clock::now() };
+				for (size_t idx{}; idx < nrOfSamples; ++idx)
+				{
+					referenceSamples[idx] = SampleTextureReferenceRGBA(*pTexture, Vector2{ getSoA(0)[idx], getSoA(1)[idx] }, Vector2{ getSoA(2)[idx], getSoA(3)[idx] },
+						Vector2{ getSoA(4)[idx], getSoA(5)[idx] }, filteringMode);
+				}
+				const double referenceMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - referenceStart).count() };
+
+				size_t nrOfDifferentSamples{};
+				float maxError{};
+				for (size_t idx{}; idx < nrOfSamples; ++idx)
+				{
+					const TextureSample& referenceSample{ referenceSamples[idx] };
+					const float reference[4]{ referenceSample.color.r, referenceSample.color.g, referenceSample.color.b, referenceSample.alpha };
+					float error{};
+					for (int channel{}; channel < 4; ++channel) error = std::max(error, std::abs(colors[nrOfSamples * channel + idx] - reference[channel]));
+					if (error != 0.f) ++nrOfDifferentSamples;
+					maxError = std::max(maxError, error);
+				}
+				// rounding of the level / tap math can pick another level in rare lanes, never more than a few LSB
+				if (maxError > 4.f / 255.f) isValid = false;
+
+				const double nrOfMegaSamples{ nrOfSamples / 1e6 };
+				std::cout << "  " << modeNames[mode] << ": " << sampleMs << " ms, " << nrOfMegaSamples / (sampleMs / 1000.0) << " M samples/s, rgba " << rgbaMs << " ms, reference "
+					<< referenceMs << " ms (" << referenceMs / sampleMs << "x), " << nrOfDifferentSamples << " different samples, max error " << maxError << "\n";
+			}
+
+			// magnified point / bilinear against the float Texture::Sample of the top level,
+			// point sampling differs only where the two round a texel border differently
+			for (int mode{}; mode < 2; ++mode)
+			{
+				const FilteringMode filteringMode{ static_cast<FilteringMode>(mode) };
+				size_t nrOfDifferentSamples{};
+				float maxError{};
+				for (size_t idx{}; idx < nrOfSamples; idx += nrOfLanes)
+				{
+					const Vector3x8 color{ SampleTexture(*pTexture, getCoordinates(idx, 0.f), filteringMode) };
+					for (int lane{}; lane < nrOfLanes; ++lane)
+					{
+						const ColorRGB expected{ pTexture->Sample(Vector2{ getSoA(0)[idx + lane], getSoA(1)[idx + lane] }, filteringMode) };
+						const Vector3 actual{ color.GetLane(lane) };
+						const float error{ std::max({ std::abs(actual.x - expected.r), std::abs(actual.y - expected.g), std::abs(actual.z - expected.b) }) };
+						if (error > 1.f / 255.f) ++nrOfDifferentSamples;
+						maxError = std::max(maxError, error);
+					}
+				}
+				std::cout << "  " << modeNames[mode] << " vs Texture::Sample (magnified): " << nrOfDifferentSamples << " samples off by more than 1 / 255, max error "
+					<< maxError * 255.f << " / 255\n";
+			}
+
+			// a solid texture samples back exactly, filtering must not darken it (white stays 255 in ToARGB)
+			for (const uint32_t texel : { 0xFFFFFFFFu, 0x80C3417Fu, 0x00010203u })
+			{
+				const std::unique_ptr<Texture> pSolid{ Texture::CreateSolid(nullptr, texel) };
+				const TextureSample expected{ ToColor(texel) };
+				const float reference[4]{ expected.color.r, expected.color.g, expected.color.b, expected.alpha };
+				size_t nrOfDifferentSamples{};
+				for (int mode{}; mode < 2; ++mode)
+				{
+					const FilteringMode filteringMode{ static_cast<FilteringMode>(mode) };
+					for (size_t idx{}; idx < nrOfSamples; idx += nrOfLanes)
+					{
+						for (const float scale : { 0.f, 1.f })
+						{
+							const TextureCoordinates8 laneCoordinates{ getCoordinates(idx, scale) };
+							const TextureSample8 sample{ SampleTextureRGBA(*pSolid, laneCoordinates, filteringMode) };
+							alignas(32) float channels[4][nrOfLanes];
+							sample.color.Store(channels[0], channels[1], channels[2]);
+							sample.alpha.Store(channels[3]);
+							for (int lane{}; lane < nrOfLanes; ++lane)
+							{
+								const TextureSample referenceSample{ SampleTextureReferenceRGBA(*pSolid, laneCoordinates.uv.GetLane(lane),
+									laneCoordinates.uvDdx.GetLane(lane), laneCoordinates.uvDdy.GetLane(lane), filteringMode) };
+								const float scalar[4]{ referenceSample.color.r, referenceSample.color.g, referenceSample.color.b, referenceSample.alpha };
+								for (int channel{}; channel < 4; ++channel)
+								{
+									if (channels[channel][lane] != reference[channel] || scalar[channel] != reference[channel]) ++nrOfDifferentSamples;
+								}
+							}
+						}
+					}
+				}
+				if (nrOfDifferentSamples > 0) isValid = false;
+				std::cout << "  Solid 0x" << std::hex << texel << std::dec << " (point, linear): " << nrOfDifferentSamples << " channels not sampled back exactly\n";
+			}
+
+			std::cout << (isValid ? "  Sampler: OK\n" : "  Sampler: MISMATCH\n");
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
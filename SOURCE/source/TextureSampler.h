@@ -0,0 +1,51 @@
+#ifndef TEXTURESAMPLER_H
+#define TEXTURESAMPLER_H
+
+#include "VectorN.h"
+
+namespace dae
+{
+	class Texture;
+
+	// uv of 8 pixels and how it changes one pixel to the right / down, the derivatives select the mip level
+	struct TextureCoordinates8
+	{
+		Vector2x8 uv;
+		Vector2x8 uvDdx;
+		Vector2x8 uvDdy;
+	};
+
+	// rgb and alpha of 8 samples, alpha carries the second map of a packed material
+	struct TextureSample8
+	{
+		Vector3x8 color;
+		Float8 alpha;
+	};
+
+	struct TextureSample
+	{
+		ColorRGB color;
+		float alpha;
+	};
+
+	// CPU counterpart of the .fx SamplerStates, wrap addressing, rgb in [0, 1]. 8 samples per call:
+	// Point       MIN_MAG_MIP_POINT, nearest texel of the nearest level
+	// Linear      MIN_MAG_MIP_LINEAR, bilinear in both neighbouring levels (trilinear when there are mips)
+	// Anisotropic up to 16 trilinear taps along the major axis of the pixel footprint, at the level of the minor axis
+	// Bilinear filtering runs in 16-bit fixed point (8 bit texel fractions) on AVX2 gathers.
+	Vector3x8 SampleTexture(const Texture& texture, const TextureCoordinates8& coordinates, FilteringMode filteringMode);
+	// Same filtering with the alpha channel, alpha in [0, 1]
+	TextureSample8 SampleTextureRGBA(const Texture& texture, const TextureCoordinates8& coordinates, FilteringMode filteringMode);
+	// Scalar version of the same fixed point math, for validation and CPUs without AVX2
+	ColorRGB SampleTextureReference(const Texture& texture, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, FilteringMode filteringMode);
+	TextureSample SampleTextureReferenceRGBA(const Texture& texture, const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, FilteringMode filteringMode);
+
+	namespace Utils
+	{
+		// Random coordinates on a texture file: SampleTexture vs SampleTextureReference (and Texture::Sample
+		// for magnified bilinear) per filtering mode, samples / second of each
+		bool BenchmarkTextureSampler(const std::string& path, size_t nrOfSamples = 1 << 20);
+	}
+}
+
+#endif // !TEXTURESAMPLER_H
\ No newline at end of file
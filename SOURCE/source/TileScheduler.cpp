@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "TileScheduler.h"
+
+namespace dae
+{
+	namespace
+	{
+		inline uint64_t PackRange(uint32_t begin, uint32_t end)
+		{
+			return static_cast<uint64_t>(end) << 32 | begin;
+		}
+
+		inline uint32_t GetBegin(uint64_t range)
+		{
+			return static_cast<uint32_t>(range);
+		}
+
+		inline uint32_t GetEnd(uint64_t range)
+		{
+			return static_cast<uint32_t>(range >> 32);
+		}
+	}
+
+	TileScheduler::TileScheduler(uint32_t nrOfThreads)
+		: m_NrOfThreads{ nrOfThreads ? nrOfThreads : std::max(std::thread::hardware_concurrency(), 1u) }
+		, m_pQueues{ std::make_unique<WorkerQueue[]>(m_NrOfThreads) }
+		, m_pTask{ nullptr }
+		, m_Generation{ 0 }
+		, m_NrOfBusyWorkers{ 0 }
+		, m_IsStopping{ false }
+		, m_NrOfSteals{ 0 }
+	{
+		for (uint32_t workerIdx{}; workerIdx < m_NrOfThreads; ++workerIdx)
+		{
+			m_pQueues[workerIdx].range.store(0);
+		}
+
+		m_Threads.reserve(m_NrOfThreads - 1);
+		for (uint32_t workerIdx{ 1 }; workerIdx < m_NrOfThreads; ++workerIdx)
+		{
+			m_Threads.emplace_back(&TileScheduler::WorkerLoop, this, workerIdx);
+		}
+	}
+
+	TileScheduler::~TileScheduler()
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_StartCondition.notify_all();
+
+		for (std::thread& thread : m_Threads) thread.join();
+	}
+
+	void TileScheduler::Run(uint32_t nrOfTasks, const std::function<void(uint32_t, uint32_t)>& task)
+	{
+		if (nrOfTasks == 0) return;
+
+		m_NrOfSteals.store(0, std::memory_order_relaxed);
+
+		// single thread: plain loop, same task order as a reference implementation
+		if (m_NrOfThreads == 1)
+		{
+			for (uint32_t taskIdx{}; taskIdx < nrOfTasks; ++taskIdx) task(taskIdx, 0);
+			return;
+		}
+
+		// contiguous ranges keep neighbouring tiles (shared triangles, texels) on the same core
+		for (uint32_t workerIdx{}; workerIdx < m_NrOfThreads; ++workerIdx)
+		{
+			const uint32_t begin{ static_cast<uint32_t>(static_cast<uint64_t>(nrOfTasks) * workerIdx / m_NrOfThreads) };
+			const uint32_t end{ static_cast<uint32_t>(static_cast<uint64_t>(nrOfTasks) * (workerIdx + 1) / m_NrOfThreads) };
+			m_pQueues[workerIdx].range.store(PackRange(begin, end), std::memory_order_relaxed);
+		}
+
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_pTask = &task;
+			m_NrOfBusyWorkers = m_NrOfThreads - 1;
+			++m_Generation;
+		}
+		m_StartCondition.notify_all();
+
+		Work(0);
+
+		std::unique_lock lock{ m_Mutex };
+		m_DoneCondition.wait(lock, [this]() { return m_NrOfBusyWorkers == 0; });
+		m_pTask = nullptr;
+	}
+
+	uint32_t TileScheduler::GetNrOfThreads() const
+	{
+		return m_NrOfThreads;
+	}
+
+	uint32_t TileScheduler::GetNrOfSteals() const
+	{
+		return m_NrOfSteals.load(std::memory_order_relaxed);
+	}
+
+	void TileScheduler::WorkerLoop(uint32_t workerIdx)
+	{
+		uint64_t generation{};
+		while (true)
+		{
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_StartCondition.wait(lock, [&]() { return m_IsStopping || m_Generation != generation; });
+				if (m_IsStopping) return;
+				generation = m_Generation;
+			}
+
+			Work(workerIdx);
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				--m_NrOfBusyWorkers;
+			}
+			m_DoneCondition.notify_one();
+		}
+	}
+
+	void TileScheduler::Work(uint32_t workerIdx)
+	{
+		const std::function<void(uint32_t, uint32_t)>& task{ *m_pTask };
+
+		uint32_t taskIdx{};
+		while (Pop(workerIdx, taskIdx) || Steal(workerIdx, taskIdx))
+		{
+			task(taskIdx, workerIdx);
+		}
+	}
+
+	bool TileScheduler::Pop(uint32_t workerIdx, uint32_t& taskIdx)
+	{
+		std::atomic<uint64_t>& range{ m_pQueues[workerIdx].range };
+		uint64_t current{ range.load(std::memory_order_acquire) };
+		while (GetBegin(current) < GetEnd(current))
+		{
+			if (range.compare_exchange_weak(current, PackRange(GetBegin(current) + 1, GetEnd(current)), std::memory_order_acq_rel))
+			{
+				taskIdx = GetBegin(current);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TileScheduler::Steal(uint32_t workerIdx, uint32_t& taskIdx)
+	{
+		// tasks are never added during a Run, so once every range is empty the work is done
+		for (uint32_t offset{ 1 }; offset < m_NrOfThreads; ++offset)
+		{
+			const uint32_t victimIdx{ (workerIdx + offset) % m_NrOfThreads };
+			std::atomic<uint64_t>& victimRange{ m_pQueues[victimIdx].range };
+
+			uint64_t current{ victimRange.load(std::memory_order_acquire) };
+			while (GetBegin(current) < GetEnd(current))
+			{
+				// back half, rounded up so a single remaining task can be stolen too
+				const uint32_t begin{ GetBegin(current) };
+				const uint32_t end{ GetEnd(current) };
+				const uint32_t stolenBegin{ end - (end - begin + 1) / 2 };
+				if (victimRange.compare_exchange_weak(current, PackRange(begin, stolenBegin), std::memory_order_acq_rel))
+				{
+					// only this worker writes its own (empty) range, thieves skip empty ranges
+					m_pQueues[workerIdx].range.store(PackRange(stolenBegin + 1, end), std::memory_order_release);
+					m_NrOfSteals.fetch_add(1, std::memory_order_relaxed);
+					taskIdx = stolenBegin;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
\ No newline at end of file
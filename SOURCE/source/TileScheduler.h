@@ -0,0 +1,63 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	// Persistent worker threads for per-frame parallel loops (screen tiles of the software rasterizer).
+	// Run splits the tasks into one contiguous range per worker. A worker takes tasks from the front
+	// of its own range, and when that is empty it steals the back half of another worker's range,
+	// so expensive tiles do not leave the other cores idle. Both are a single CAS on a packed
+	// (begin, end) pair, no locks while tasks are running.
+	class TileScheduler final
+	{
+	public:
+		// nrOfThreads = 0: one per hardware thread. The calling thread of Run is worker 0.
+		explicit TileScheduler(uint32_t nrOfThreads = 0);
+		~TileScheduler();
+
+		TileScheduler(const TileScheduler&) = delete;
+		TileScheduler(TileScheduler&&) noexcept = delete;
+		TileScheduler& operator=(const TileScheduler&) = delete;
+		TileScheduler& operator=(TileScheduler&&) noexcept = delete;
+
+		// task(taskIdx, workerIdx) for every taskIdx in [0, nrOfTasks), returns when all of them are done
+		void Run(uint32_t nrOfTasks, const std::function<void(uint32_t, uint32_t)>& task);
+
+		uint32_t GetNrOfThreads() const;
+		// ranges stolen during the last Run
+		uint32_t GetNrOfSteals() const;
+
+	private:
+		struct alignas(64) WorkerQueue
+		{
+			std::atomic<uint64_t> range; // begin in the low, end in the high 32 bits
+		};
+
+		const uint32_t m_NrOfThreads;
+		std::unique_ptr<WorkerQueue[]> m_pQueues;
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_StartCondition;
+		std::condition_variable m_DoneCondition;
+		const std::function<void(uint32_t, uint32_t)>* m_pTask;
+		uint64_t m_Generation;
+		uint32_t m_NrOfBusyWorkers;
+		bool m_IsStopping;
+
+		std::atomic<uint32_t> m_NrOfSteals;
+
+		void WorkerLoop(uint32_t workerIdx);
+		void Work(uint32_t workerIdx);
+		bool Pop(uint32_t workerIdx, uint32_t& taskIdx);
+		bool Steal(uint32_t workerIdx, uint32_t& taskIdx);
+	};
+}
+
+#endif // !TILESCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,485 @@
+#ifndef VECTORN_H
+#define VECTORN_H
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <bit>
+
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix.h"
+#include "DataTypes.h"
+
+// SoA wide vectors: Width lanes of Vector2 / Vector3 / Vector4, one register per component.
+// FloatN<4> maps to SSE, FloatN<8> to AVX2 and FloatN<16> to AVX-512 when the build enables them
+// (/arch:AVX2, /arch:AVX512), every other width / instruction set uses the scalar fallback.
+namespace dae
+{
+#pragma region FloatN
+	// Scalar fallback
+	template<int Width>
+	struct FloatN
+	{
+		static constexpr int NrOfLanes{ Width };
+
+		float lanes[Width];
+
+		static FloatN Broadcast(float value)
+		{
+			FloatN result;
+			for (int lane{}; lane < Width; ++lane) result.lanes[lane] = value;
+			return result;
+		}
+
+		static FloatN Load(const float* pValues)
+		{
+			FloatN result;
+			for (int lane{}; lane < Width; ++lane) result.lanes[lane] = pValues[lane];
+			return result;
+		}
+
+		void Store(float* pValues) const
+		{
+			for (int lane{}; lane < Width; ++lane) pValues[lane] = lanes[lane];
+		}
+
+		float GetLane(int lane) const
+		{
+			return lanes[lane];
+		}
+
+		friend FloatN operator+(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return x + y; }); }
+		friend FloatN operator-(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return x - y; }); }
+		friend FloatN operator*(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return x * y; }); }
+		friend FloatN operator/(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return x / y; }); }
+		friend FloatN operator-(const FloatN& a) { return Apply(a, a, [](float x, float) { return -x; }); }
+		friend FloatN Min(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return y < x ? y : x; }); }
+		friend FloatN Max(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return x < y ? y : x; }); }
+		friend FloatN Sqrt(const FloatN& a) { return Apply(a, a, [](float x, float) { return std::sqrt(x); }); }
+		friend FloatN Abs(const FloatN& a) { return Apply(a, a, [](float x, float) { return std::abs(x); }); }
+		friend FloatN MultiplyAdd(const FloatN& a, const FloatN& b, const FloatN& c) { return a * b + c; }
+
+		// masks are all ones / all zeros per lane, like the SIMD compares
+		friend FloatN operator<(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return ToMask(x < y); }); }
+		friend FloatN operator>(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return ToMask(x > y); }); }
+		friend FloatN operator<=(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return ToMask(x <= y); }); }
+		friend FloatN operator>=(const FloatN& a, const FloatN& b) { return Apply(a, b, [](float x, float y) { return ToMask(x >= y); }); }
+		friend FloatN operator&(const FloatN& a, const FloatN& b) { return ApplyBits(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+		friend FloatN operator|(const FloatN& a, const FloatN& b) { return ApplyBits(a, b, [](uint32_t x, uint32_t y) { return x | y; }); }
+		// mask ? a : b
+		friend FloatN Select(const FloatN& mask, const FloatN& a, const FloatN& b) { return (mask & a) | ApplyBits(mask, b, [](uint32_t x, uint32_t y) { return ~x & y; }); }
+		// bit per lane of the mask
+		friend uint32_t GetMaskBits(const FloatN& mask)
+		{
+			uint32_t bits{};
+			for (int lane{}; lane < Width; ++lane) bits |= (std::bit_cast<uint32_t>(mask.lanes[lane]) >> 31) << lane;
+			return bits;
+		}
+
+	private:
+		template<typename Function>
+		static FloatN Apply(const FloatN& a, const FloatN& b, const Function& function)
+		{
+			FloatN result;
+			for (int lane{}; lane < Width; ++lane) result.lanes[lane] = function(a.lanes[lane], b.lanes[lane]);
+			return result;
+		}
+
+		template<typename Function>
+		static FloatN ApplyBits(const FloatN& a, const FloatN& b, const Function& function)
+		{
+			FloatN result;
+			for (int lane{}; lane < Width; ++lane)
+			{
+				result.lanes[lane] = std::bit_cast<float>(function(std::bit_cast<uint32_t>(a.lanes[lane]), std::bit_cast<uint32_t>(b.lanes[lane])));
+			}
+			return result;
+		}
+
+		static float ToMask(bool value)
+		{
+			return std::bit_cast<float>(value ? 0xFFFFFFFFu : 0u);
+		}
+	};
+
+	// SSE (x64 baseline)
+	template<>
+	struct FloatN<4>
+	{
+		static constexpr int NrOfLanes{ 4 };
+
+		__m128 value;
+
+		static FloatN Broadcast(float scalar) { return { _mm_set1_ps(scalar) }; }
+		static FloatN Load(const float* pValues) { return { _mm_loadu_ps(pValues) }; }
+		void Store(float* pValues) const { _mm_storeu_ps(pValues, value); }
+		float GetLane(int lane) const { alignas(16) float lanes[4]; _mm_store_ps(lanes, value); return lanes[lane]; }
+
+		friend FloatN operator+(const FloatN& a, const FloatN& b) { return { _mm_add_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a, const FloatN& b) { return { _mm_sub_ps(a.value, b.value) }; }
+		friend FloatN operator*(const FloatN& a, const FloatN& b) { return { _mm_mul_ps(a.value, b.value) }; }
+		friend FloatN operator/(const FloatN& a, const FloatN& b) { return { _mm_div_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a) { return { _mm_xor_ps(a.value, _mm_set1_ps(-0.f)) }; }
+		friend FloatN Min(const FloatN& a, const FloatN& b) { return { _mm_min_ps(a.value, b.value) }; }
+		friend FloatN Max(const FloatN& a, const FloatN& b) { return { _mm_max_ps(a.value, b.value) }; }
+		friend FloatN Sqrt(const FloatN& a) { return { _mm_sqrt_ps(a.value) }; }
+		friend FloatN Abs(const FloatN& a) { return { _mm_andnot_ps(_mm_set1_ps(-0.f), a.value) }; }
+#if defined(__FMA__) || defined(__AVX2__)
+		friend FloatN MultiplyAdd(const FloatN& a, const FloatN& b, const FloatN& c) { return { _mm_fmadd_ps(a.value, b.value, c.value) }; }
+#else
+		friend FloatN MultiplyAdd(const FloatN& a, const FloatN& b, const FloatN& c) { return a * b + c; }
+#endif
+
+		friend FloatN operator<(const FloatN& a, const FloatN& b) { return { _mm_cmplt_ps(a.value, b.value) }; }
+		friend FloatN operator>(const FloatN& a, const FloatN& b) { return { _mm_cmpgt_ps(a.value, b.value) }; }
+		friend FloatN operator<=(const FloatN& a, const FloatN& b) { return { _mm_cmple_ps(a.value, b.value) }; }
+		friend FloatN operator>=(const FloatN& a, const FloatN& b) { return { _mm_cmpge_ps(a.value, b.value) }; }
+		friend FloatN operator&(const FloatN& a, const FloatN& b) { return { _mm_and_ps(a.value, b.value) }; }
+		friend FloatN operator|(const FloatN& a, const FloatN& b) { return { _mm_or_ps(a.value, b.value) }; }
+		friend FloatN Select(const FloatN& mask, const FloatN& a, const FloatN& b) { return { _mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value)) }; }
+		friend uint32_t GetMaskBits(const FloatN& mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask.value)); }
+	};
+
+#if defined(__AVX2__)
+	// AVX2
+	template<>
+	struct FloatN<8>
+	{
+		static constexpr int NrOfLanes{ 8 };
+
+		__m256 value;
+
+		static FloatN Broadcast(float scalar) { return { _mm256_set1_ps(scalar) }; }
+		static FloatN Load(const float* pValues) { return { _mm256_loadu_ps(pValues) }; }
+		void Store(float* pValues) const { _mm256_storeu_ps(pValues, value); }
+		float GetLane(int lane) const { alignas(32) float lanes[8]; _mm256_store_ps(lanes, value); return lanes[lane]; }
+
+		friend FloatN operator+(const FloatN& a, const FloatN& b) { return { _mm256_add_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a, const FloatN& b) { return { _mm256_sub_ps(a.value, b.value) }; }
+		friend FloatN operator*(const FloatN& a, const FloatN& b) { return { _mm256_mul_ps(a.value, b.value) }; }
+		friend FloatN operator/(const FloatN& a, const FloatN& b) { return { _mm256_div_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a) { return { _mm256_xor_ps(a.value, _mm256_set1_ps(-0.f)) }; }
+		friend FloatN Min(const FloatN& a, const FloatN& b) { return { _mm256_min_ps(a.value, b.value) }; }
+		friend FloatN Max(const FloatN& a, const FloatN& b) { return { _mm256_max_ps(a.value, b.value) }; }
+		friend FloatN Sqrt(const FloatN& a) { return { _mm256_sqrt_ps(a.value) }; }
+		friend FloatN Abs(const FloatN& a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.value) }; }
+		friend FloatN MultiplyAdd(const FloatN& a, const FloatN& b, const FloatN& c) { return { _mm256_fmadd_ps(a.value, b.value, c.value) }; }
+
+		friend FloatN operator<(const FloatN& a, const FloatN& b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ) }; }
+		friend FloatN operator>(const FloatN& a, const FloatN& b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ) }; }
+		friend FloatN operator<=(const FloatN& a, const FloatN& b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ) }; }
+		friend FloatN operator>=(const FloatN& a, const FloatN& b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_GE_OQ) }; }
+		friend FloatN operator&(const FloatN& a, const FloatN& b) { return { _mm256_and_ps(a.value, b.value) }; }
+		friend FloatN operator|(const FloatN& a, const FloatN& b) { return { _mm256_or_ps(a.value, b.value) }; }
+		friend FloatN Select(const FloatN& mask, const FloatN& a, const FloatN& b) { return { _mm256_blendv_ps(b.value, a.value, mask.value) }; }
+		friend uint32_t GetMaskBits(const FloatN& mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask.value)); }
+	};
+#endif
+
+#if defined(__AVX512F__)
+	// AVX-512 (compares produce vector masks too, so the interface stays the same)
+	template<>
+	struct FloatN<16>
+	{
+		static constexpr int NrOfLanes{ 16 };
+
+		__m512 value;
+
+		static FloatN Broadcast(float scalar) { return { _mm512_set1_ps(scalar) }; }
+		static FloatN Load(const float* pValues) { return { _mm512_loadu_ps(pValues) }; }
+		void Store(float* pValues) const { _mm512_storeu_ps(pValues, value); }
+		float GetLane(int lane) const { alignas(64) float lanes[16]; _mm512_store_ps(lanes, value); return lanes[lane]; }
+
+		friend FloatN operator+(const FloatN& a, const FloatN& b) { return { _mm512_add_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a, const FloatN& b) { return { _mm512_sub_ps(a.value, b.value) }; }
+		friend FloatN operator*(const FloatN& a, const FloatN& b) { return { _mm512_mul_ps(a.value, b.value) }; }
+		friend FloatN operator/(const FloatN& a, const FloatN& b) { return { _mm512_div_ps(a.value, b.value) }; }
+		friend FloatN operator-(const FloatN& a) { return { _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.value), _mm512_set1_epi32(INT32_MIN))) }; }
+		friend FloatN Min(const FloatN& a, const FloatN& b) { return { _mm512_min_ps(a.value, b.value) }; }
+		friend FloatN Max(const FloatN& a, const FloatN& b) { return { _mm512_max_ps(a.value, b.value) }; }
+		friend FloatN Sqrt(const FloatN& a) { return { _mm512_sqrt_ps(a.value) }; }
+		friend FloatN Abs(const FloatN& a) { return { _mm512_abs_ps(a.value) }; }
+		friend FloatN MultiplyAdd(const FloatN& a, const FloatN& b, const FloatN& c) { return { _mm512_fmadd_ps(a.value, b.value, c.value) }; }
+
+		friend FloatN operator<(const FloatN& a, const FloatN& b) { return FromMask(_mm512_cmp_ps_mask(a.value, b.value, _CMP_LT_OQ)); }
+		friend FloatN operator>(const FloatN& a, const FloatN& b) { return FromMask(_mm512_cmp_ps_mask(a.value, b.value, _CMP_GT_OQ)); }
+		friend FloatN operator<=(const FloatN& a, const FloatN& b) { return FromMask(_mm512_cmp_ps_mask(a.value, b.value, _CMP_LE_OQ)); }
+		friend FloatN operator>=(const FloatN& a, const FloatN& b) { return FromMask(_mm512_cmp_ps_mask(a.value, b.value, _CMP_GE_OQ)); }
+		friend FloatN operator&(const FloatN& a, const FloatN& b) { return { _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a.value), _mm512_castps_si512(b.value))) }; }
+		friend FloatN operator|(const FloatN& a, const FloatN& b) { return { _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a.value), _mm512_castps_si512(b.value))) }; }
+		friend FloatN Select(const FloatN& mask, const FloatN& a, const FloatN& b) { return { _mm512_mask_blend_ps(ToMask(mask), b.value, a.value) }; }
+		friend uint32_t GetMaskBits(const FloatN& mask) { return static_cast<uint32_t>(ToMask(mask)); }
+
+	private:
+		static FloatN FromMask(__mmask16 mask) { return { _mm512_castsi512_ps(_mm512_maskz_set1_epi32(mask, -1)) }; }
+		static __mmask16 ToMask(const FloatN& mask) { return _mm512_cmplt_epi32_mask(_mm512_castps_si512(mask.value), _mm512_setzero_si512()); } // sign bit, AVX512F only
+	};
+#endif
+#pragma endregion
+
+#pragma region Vector2xN
+	template<int Width>
+	struct Vector2xN
+	{
+		FloatN<Width> x;
+		FloatN<Width> y;
+
+		static Vector2xN Broadcast(const Vector2& v) { return { FloatN<Width>::Broadcast(v.x), FloatN<Width>::Broadcast(v.y) }; }
+
+		// count < Width: the remaining lanes repeat the last element
+		static Vector2xN Load(const Vector2* pFirst, size_t stride, int count = Width)
+		{
+			alignas(64) float lanes[2][Width];
+			for (int lane{}; lane < Width; ++lane)
+			{
+				const Vector2& v{ *reinterpret_cast<const Vector2*>(reinterpret_cast<const char*>(pFirst) + stride * std::min(lane, count - 1)) };
+				lanes[0][lane] = v.x;
+				lanes[1][lane] = v.y;
+			}
+			return { FloatN<Width>::Load(lanes[0]), FloatN<Width>::Load(lanes[1]) };
+		}
+
+		static Vector2xN LoadUVs(const Vertex* pVertices, int count = Width) { return Load(&pVertices->uv, sizeof(Vertex), count); }
+
+		Vector2 GetLane(int lane) const { return Vector2{ x.GetLane(lane), y.GetLane(lane) }; }
+
+		friend Vector2xN operator+(const Vector2xN& a, const Vector2xN& b) { return { a.x + b.x, a.y + b.y }; }
+		friend Vector2xN operator-(const Vector2xN& a, const Vector2xN& b) { return { a.x - b.x, a.y - b.y }; }
+		friend Vector2xN operator*(const Vector2xN& a, const FloatN<Width>& scale) { return { a.x * scale, a.y * scale }; }
+	};
+#pragma endregion
+
+#pragma region Vector3xN
+	template<int Width>
+	struct Vector3xN
+	{
+		FloatN<Width> x;
+		FloatN<Width> y;
+		FloatN<Width> z;
+
+		static Vector3xN Broadcast(const Vector3& v) { return { FloatN<Width>::Broadcast(v.x), FloatN<Width>::Broadcast(v.y), FloatN<Width>::Broadcast(v.z) }; }
+
+		// Strided AoS load / store (stride in bytes), count < Width: the remaining lanes repeat the last element
+		static Vector3xN Load(const Vector3* pFirst, size_t stride, int count = Width)
+		{
+			alignas(64) float lanes[3][Width];
+			for (int lane{}; lane < Width; ++lane)
+			{
+				const Vector3& v{ *reinterpret_cast<const Vector3*>(reinterpret_cast<const char*>(pFirst) + stride * std::min(lane, count - 1)) };
+				lanes[0][lane] = v.x;
+				lanes[1][lane] = v.y;
+				lanes[2][lane] = v.z;
+			}
+			return { FloatN<Width>::Load(lanes[0]), FloatN<Width>::Load(lanes[1]), FloatN<Width>::Load(lanes[2]) };
+		}
+
+		void Store(Vector3* pFirst, size_t stride, int count = Width) const
+		{
+			alignas(64) float lanes[3][Width];
+			x.Store(lanes[0]);
+			y.Store(lanes[1]);
+			z.Store(lanes[2]);
+			for (int lane{}; lane < count; ++lane)
+			{
+				*reinterpret_cast<Vector3*>(reinterpret_cast<char*>(pFirst) + stride * lane) = Vector3{ lanes[0][lane], lanes[1][lane], lanes[2][lane] };
+			}
+		}
+
+		// SoA streams
+		static Vector3xN Load(const float* pX, const float* pY, const float* pZ) { return { FloatN<Width>::Load(pX), FloatN<Width>::Load(pY), FloatN<Width>::Load(pZ) }; }
+		void Store(float* pX, float* pY, float* pZ) const { x.Store(pX); y.Store(pY); z.Store(pZ); }
+
+		static Vector3xN LoadPositions(const Vertex* pVertices, int count = Width) { return Load(&pVertices->position, sizeof(Vertex), count); }
+		static Vector3xN LoadNormals(const Vertex* pVertices, int count = Width) { return Load(&pVertices->normal, sizeof(Vertex), count); }
+		static Vector3xN LoadTangents(const Vertex* pVertices, int count = Width) { return Load(&pVertices->tangent, sizeof(Vertex), count); }
+
+		Vector3 GetLane(int lane) const { return Vector3{ x.GetLane(lane), y.GetLane(lane), z.GetLane(lane) }; }
+
+		FloatN<Width> SqrMagnitude() const { return Dot(*this, *this); }
+		FloatN<Width> Magnitude() const { return Sqrt(SqrMagnitude()); }
+		// same as Vector3::Normalized (division by the magnitude)
+		Vector3xN Normalized() const
+		{
+			const FloatN<Width> magnitude{ Magnitude() };
+			return { x / magnitude, y / magnitude, z / magnitude };
+		}
+
+		static FloatN<Width> Dot(const Vector3xN& a, const Vector3xN& b)
+		{
+			return MultiplyAdd(a.z, b.z, MultiplyAdd(a.y, b.y, a.x * b.x));
+		}
+
+		static Vector3xN Cross(const Vector3xN& a, const Vector3xN& b)
+		{
+			return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+		}
+
+		static Vector3xN Lerp(const Vector3xN& a, const Vector3xN& b, const FloatN<Width>& t)
+		{
+			return { MultiplyAdd(b.x - a.x, t, a.x), MultiplyAdd(b.y - a.y, t, a.y), MultiplyAdd(b.z - a.z, t, a.z) };
+		}
+
+		friend Vector3xN Min(const Vector3xN& a, const Vector3xN& b) { return { Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z) }; }
+		friend Vector3xN Max(const Vector3xN& a, const Vector3xN& b) { return { Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z) }; }
+		friend Vector3xN Select(const FloatN<Width>& mask, const Vector3xN& a, const Vector3xN& b) { return { Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z) }; }
+
+		friend Vector3xN operator+(const Vector3xN& a, const Vector3xN& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+		friend Vector3xN operator-(const Vector3xN& a, const Vector3xN& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+		friend Vector3xN operator-(const Vector3xN& a) { return { -a.x, -a.y, -a.z }; }
+		friend Vector3xN operator*(const Vector3xN& a, const FloatN<Width>& scale) { return { a.x * scale, a.y * scale, a.z * scale }; }
+		friend Vector3xN operator*(const Vector3xN& a, float scale) { return a * FloatN<Width>::Broadcast(scale); }
+		friend Vector3xN operator/(const Vector3xN& a, const FloatN<Width>& scale) { return { a.x / scale, a.y / scale, a.z / scale }; }
+	};
+#pragma endregion
+
+#pragma region Vector4xN
+	template<int Width>
+	struct Vector4xN
+	{
+		FloatN<Width> x;
+		FloatN<Width> y;
+		FloatN<Width> z;
+		FloatN<Width> w;
+
+		static Vector4xN Broadcast(const Vector4& v)
+		{
+			return { FloatN<Width>::Broadcast(v.x), FloatN<Width>::Broadcast(v.y), FloatN<Width>::Broadcast(v.z), FloatN<Width>::Broadcast(v.w) };
+		}
+
+		static Vector4xN Load(const Vector4* pFirst, size_t stride, int count = Width)
+		{
+			alignas(64) float lanes[4][Width];
+			for (int lane{}; lane < Width; ++lane)
+			{
+				const Vector4& v{ *reinterpret_cast<const Vector4*>(reinterpret_cast<const char*>(pFirst) + stride * std::min(lane, count - 1)) };
+				lanes[0][lane] = v.x;
+				lanes[1][lane] = v.y;
+				lanes[2][lane] = v.z;
+				lanes[3][lane] = v.w;
+			}
+			return { FloatN<Width>::Load(lanes[0]), FloatN<Width>::Load(lanes[1]), FloatN<Width>::Load(lanes[2]), FloatN<Width>::Load(lanes[3]) };
+		}
+
+		void Store(Vector4* pFirst, size_t stride, int count = Width) const
+		{
+			alignas(64) float lanes[4][Width];
+			x.Store(lanes[0]);
+			y.Store(lanes[1]);
+			z.Store(lanes[2]);
+			w.Store(lanes[3]);
+			for (int lane{}; lane < count; ++lane)
+			{
+				float* pDestination{ reinterpret_cast<float*>(reinterpret_cast<char*>(pFirst) + stride * lane) };
+				pDestination[0] = lanes[0][lane];
+				pDestination[1] = lanes[1][lane];
+				pDestination[2] = lanes[2][lane];
+				pDestination[3] = lanes[3][lane];
+			}
+		}
+
+		Vector4 GetLane(int lane) const { return Vector4{ x.GetLane(lane), y.GetLane(lane), z.GetLane(lane), w.GetLane(lane) }; }
+
+		Vector3xN<Width> GetXYZ() const { return { x, y, z }; }
+
+		static FloatN<Width> Dot(const Vector4xN& a, const Vector4xN& b)
+		{
+			return MultiplyAdd(a.w, b.w, MultiplyAdd(a.z, b.z, MultiplyAdd(a.y, b.y, a.x * b.x)));
+		}
+
+		static Vector4xN Lerp(const Vector4xN& a, const Vector4xN& b, const FloatN<Width>& t)
+		{
+			return { MultiplyAdd(b.x - a.x, t, a.x), MultiplyAdd(b.y - a.y, t, a.y), MultiplyAdd(b.z - a.z, t, a.z), MultiplyAdd(b.w - a.w, t, a.w) };
+		}
+
+		friend Vector4xN Min(const Vector4xN& a, const Vector4xN& b) { return { Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z), Min(a.w, b.w) }; }
+		friend Vector4xN Max(const Vector4xN& a, const Vector4xN& b) { return { Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z), Max(a.w, b.w) }; }
+
+		friend Vector4xN operator+(const Vector4xN& a, const Vector4xN& b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+		friend Vector4xN operator-(const Vector4xN& a, const Vector4xN& b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+		friend Vector4xN operator*(const Vector4xN& a, const FloatN<Width>& scale) { return { a.x * scale, a.y * scale, a.z * scale, a.w * scale }; }
+	};
+#pragma endregion
+
+#pragma region Matrix
+	// Matrix with every element broadcast, hoist it out of loops (Matrix::operator[] is not inline)
+	template<int Width>
+	struct MatrixxN
+	{
+		FloatN<Width> elements[4][4];
+
+		static MatrixxN Broadcast(const Matrix& m)
+		{
+			MatrixxN result;
+			for (int row{}; row < 4; ++row)
+			{
+				const Vector4 values{ m[row] };
+				for (int column{}; column < 4; ++column)
+				{
+					result.elements[row][column] = FloatN<Width>::Broadcast(values[column]);
+				}
+			}
+			return result;
+		}
+
+		// (x, y, z) dotted with one column, without the translation row
+		FloatN<Width> TransformColumn(int column, const FloatN<Width>& x, const FloatN<Width>& y, const FloatN<Width>& z) const
+		{
+			return MultiplyAdd(z, elements[2][column], MultiplyAdd(y, elements[1][column], x * elements[0][column]));
+		}
+	};
+
+	// Row vectors like Matrix::TransformPoint: (p, 1) * m
+	template<int Width>
+	Vector4xN<Width> TransformPoint(const MatrixxN<Width>& m, const Vector3xN<Width>& p)
+	{
+		return {
+			m.TransformColumn(0, p.x, p.y, p.z) + m.elements[3][0],
+			m.TransformColumn(1, p.x, p.y, p.z) + m.elements[3][1],
+			m.TransformColumn(2, p.x, p.y, p.z) + m.elements[3][2],
+			m.TransformColumn(3, p.x, p.y, p.z) + m.elements[3][3]
+		};
+	}
+
+	template<int Width>
+	Vector4xN<Width> TransformPoint(const MatrixxN<Width>& m, const Vector4xN<Width>& p)
+	{
+		return {
+			MultiplyAdd(p.w, m.elements[3][0], m.TransformColumn(0, p.x, p.y, p.z)),
+			MultiplyAdd(p.w, m.elements[3][1], m.TransformColumn(1, p.x, p.y, p.z)),
+			MultiplyAdd(p.w, m.elements[3][2], m.TransformColumn(2, p.x, p.y, p.z)),
+			MultiplyAdd(p.w, m.elements[3][3], m.TransformColumn(3, p.x, p.y, p.z))
+		};
+	}
+
+	// (v, 0) * m, like Matrix::TransformVector
+	template<int Width>
+	Vector3xN<Width> TransformVector(const MatrixxN<Width>& m, const Vector3xN<Width>& v)
+	{
+		return { m.TransformColumn(0, v.x, v.y, v.z), m.TransformColumn(1, v.x, v.y, v.z), m.TransformColumn(2, v.x, v.y, v.z) };
+	}
+
+	template<int Width>
+	Vector4xN<Width> TransformPoint(const Matrix& m, const Vector3xN<Width>& p) { return TransformPoint(MatrixxN<Width>::Broadcast(m), p); }
+	template<int Width>
+	Vector4xN<Width> TransformPoint(const Matrix& m, const Vector4xN<Width>& p) { return TransformPoint(MatrixxN<Width>::Broadcast(m), p); }
+	template<int Width>
+	Vector3xN<Width> TransformVector(const Matrix& m, const Vector3xN<Width>& v) { return TransformVector(MatrixxN<Width>::Broadcast(m), v); }
+#pragma endregion
+
+	using Float4 = FloatN<4>;
+	using Float8 = FloatN<8>;
+	using Float16 = FloatN<16>;
+	using Vector2x8 = Vector2xN<8>;
+	using Vector3x4 = Vector3xN<4>;
+	using Vector3x8 = Vector3xN<8>;
+	using Vector3x16 = Vector3xN<16>;
+	using Vector4x4 = Vector4xN<4>;
+	using Vector4x8 = Vector4xN<8>;
+	using Vector4x16 = Vector4xN<16>;
+	using Matrixx8 = MatrixxN<8>;
+}
+
+#endif // !VECTORN_H
\ No newline at end of file
@@ -34,6 +34,11 @@ namespace dae
 		{
 			std::wcout << L"m_pNormalMapVariable not valid!\n";
 		}
+		m_pNormalMapIsXYVariable = m_pEffect->GetVariableByName("gNormalMapIsXY")->AsScalar();
+		if (!m_pNormalMapIsXYVariable->IsValid())
+		{
+			std::wcout << L"m_pNormalMapIsXYVariable not valid!\n";
+		}
 		// SpecularMap
 		m_pSpecularMapVariable = m_pEffect->GetVariableByName("gSpecularMap")->AsShaderResource();
 		if (!m_pSpecularMapVariable->IsValid())
@@ -45,29 +50,40 @@ namespace dae
 		{
 			std::wcout << L"m_pGlossinessMapVariable not valid!\n";
 		}
+		// Channel packed maps
+		m_pDiffuseGlossMapVariable = m_pEffect->GetVariableByName("gDiffuseGlossMap")->AsShaderResource();
+		if (!m_pDiffuseGlossMapVariable->IsValid())
+		{
+			std::wcout << L"m_pDiffuseGlossMapVariable not valid!\n";
+		}
+		m_pNormalSpecularMapVariable = m_pEffect->GetVariableByName("gNormalSpecularMap")->AsShaderResource();
+		if (!m_pNormalSpecularMapVariable->IsValid())
+		{
+			std::wcout << L"m_pNormalSpecularMapVariable not valid!\n";
+		}
 
-		// Create Vertex Layout
+		// Create Vertex Layout (VehicleVertex)
 		static constexpr uint32_t numElements{ 4 };
 		D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
 
 		vertexDesc[0].SemanticName = "POSITION";
-		vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[0].AlignedByteOffset = 0;
+		vertexDesc[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+		vertexDesc[0].AlignedByteOffset = offsetof(VehicleVertex, position);
 		vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[1].SemanticName = "TEXCOORD";
-		vertexDesc[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-		vertexDesc[1].AlignedByteOffset = 12;
+		vertexDesc[1].Format = DXGI_FORMAT_R16G16_UNORM;
+		vertexDesc[1].AlignedByteOffset = offsetof(VehicleVertex, uv);
 		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[2].SemanticName = "NORMAL";
-		vertexDesc[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[2].AlignedByteOffset = 20;
+		vertexDesc[2].Format = DXGI_FORMAT_R16G16_SNORM;
+		vertexDesc[2].AlignedByteOffset = offsetof(VehicleVertex, normal);
 		vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[3].SemanticName = "TANGENT";
-		vertexDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[3].AlignedByteOffset = 32;
+		vertexDesc[3].Format = DXGI_FORMAT_R16G16_SNORM;
+		vertexDesc[3].AlignedByteOffset = offsetof(VehicleVertex, tangent);
 		vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		// Create Input Layout
@@ -97,8 +113,11 @@ namespace dae
 		if (m_pWorldMatrixVariable) m_pWorldMatrixVariable->Release();
 		if (m_pDiffusedMapVariable) m_pDiffusedMapVariable->Release();
 		if (m_pNormalMapVariable) m_pNormalMapVariable->Release();
+		if (m_pNormalMapIsXYVariable) m_pNormalMapIsXYVariable->Release();
 		if (m_pSpecularMapVariable) m_pSpecularMapVariable->Release();
 		if (m_pGlossinessMapVariable) m_pGlossinessMapVariable->Release();
+		if (m_pDiffuseGlossMapVariable) m_pDiffuseGlossMapVariable->Release();
+		if (m_pNormalSpecularMapVariable) m_pNormalSpecularMapVariable->Release();
 		if (m_pCameraPositionVariable) m_pCameraPositionVariable->Release();
 	}
 
@@ -116,6 +135,11 @@ namespace dae
 		{
 			m_pNormalMapVariable->SetResource(pNormalMap->GetSRV());
 		}
+		// z is only rebuilt for BC5, like the CPU decoder does
+		if (m_pNormalMapIsXYVariable)
+		{
+			m_pNormalMapIsXYVariable->SetBool(pNormalMap->GetFormat() == BlockFormat::BC5);
+		}
 	}
 
 	void VehicleEffect::SetSpecualarMap(Texture* pSpecularMap) const
@@ -134,6 +158,22 @@ namespace dae
 		}
 	}
 
+	void VehicleEffect::SetDiffuseGlossMap(Texture* pDiffuseGlossMap) const
+	{
+		if (m_pDiffuseGlossMapVariable)
+		{
+			m_pDiffuseGlossMapVariable->SetResource(pDiffuseGlossMap->GetSRV());
+		}
+	}
+
+	void VehicleEffect::SetNormalSpecularMap(Texture* pNormalSpecularMap) const
+	{
+		if (m_pNormalSpecularMapVariable)
+		{
+			m_pNormalSpecularMapVariable->SetResource(pNormalSpecularMap->GetSRV());
+		}
+	}
+
 	ID3DX11EffectMatrixVariable* VehicleEffect::GetWorldMatrix() const
 	{
 		return m_pWorldMatrixVariable;
@@ -2,6 +2,7 @@
 #define VECHILEEFFECT_H
 
 #include "BaseEffect.h"
+#include "VertexFormats.h"
 
 namespace dae
 {
@@ -10,6 +11,11 @@ namespace dae
 	class VehicleEffect final : public BaseEffect
 	{
 	public:
+		// compact vertex stream matching the input layout
+		using VertexType = VehicleVertex;
+		// passes 0..2 shade from the 4 separate maps, 3..5 from the channel packed pair (same filtering order)
+		static constexpr uint32_t PackedPassOffset{ 3 };
+
 		explicit VehicleEffect(ID3D11Device* pDevice, const std::wstring& assertfile);
 		virtual ~VehicleEffect();
 
@@ -22,6 +28,9 @@ namespace dae
 		void SetNormalMap(Texture* pNormalMap) const;
 		void SetSpecualarMap(Texture* pSpecularMap) const;
 		void SetGlossinessMap(Texture* pGlossinessMap) const;
+		// channel packed material (MaterialPacker.h)
+		void SetDiffuseGlossMap(Texture* pDiffuseGlossMap) const;
+		void SetNormalSpecularMap(Texture* pNormalSpecularMap) const;
 
 		ID3DX11EffectMatrixVariable* GetWorldMatrix() const;
 		ID3DX11EffectVectorVariable* GetCameraPos() const;
@@ -30,8 +39,11 @@ namespace dae
 		ID3DX11EffectMatrixVariable* m_pWorldMatrixVariable;
 		ID3DX11EffectShaderResourceVariable* m_pDiffusedMapVariable;
 		ID3DX11EffectShaderResourceVariable* m_pNormalMapVariable;
+		ID3DX11EffectScalarVariable* m_pNormalMapIsXYVariable;
 		ID3DX11EffectShaderResourceVariable* m_pSpecularMapVariable;
 		ID3DX11EffectShaderResourceVariable* m_pGlossinessMapVariable;
+		ID3DX11EffectShaderResourceVariable* m_pDiffuseGlossMapVariable;
+		ID3DX11EffectShaderResourceVariable* m_pNormalSpecularMapVariable;
 		ID3DX11EffectVectorVariable* m_pCameraPositionVariable;
 
 	};
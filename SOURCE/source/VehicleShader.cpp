@@ -0,0 +1,279 @@
+#include "pch.h"
+#include "VehicleShader.h"
+
+#include <bit>
+#include <chrono>
+#include <random>
+
+namespace dae
+{
+	namespace
+	{
+		// Vehicle.fx constants
+		const Vector3 g_LightDirection{ 0.577f, -0.577f, 0.577f };
+		constexpr ColorRGB g_AmbientColor{ 0.03f, 0.03f, 0.03f };
+		constexpr float g_DivPI{ 0.3183098862f };
+		constexpr float g_LightIntensity{ 7.f };
+
+		// log2(1 + t) = t * p(t) and 2^t = p(t) for t in [0, 1), least squares fits weighted to equal ripple
+		constexpr int g_NrOfCoefficients{ 5 };
+		constexpr float g_Log2Coefficients[g_NrOfCoefficients]{ 1.441965040f, -0.7096572832f, 0.4175790889f, -0.1962497462f, 0.04637718344f };
+		constexpr float g_Exp2Coefficients[g_NrOfCoefficients]{ 1.000002593f, 0.6930038528f, 0.2414426574f, 0.05201162895f, 0.01353408034f };
+		constexpr float g_MinExponent{ -126.f };
+		constexpr float g_MaxExponent{ 127.f };
+
+		inline float Polynomial(float t, const float(&coefficients)[g_NrOfCoefficients])
+		{
+			float result{ coefficients[g_NrOfCoefficients - 1] };
+			for (int idx{ g_NrOfCoefficients - 2 }; idx >= 0; --idx) result = result * t + coefficients[idx];
+			return result;
+		}
+
+		inline Float8 Polynomial(const Float8& t, const float(&coefficients)[g_NrOfCoefficients])
+		{
+			Float8 result{ Float8::Broadcast(coefficients[g_NrOfCoefficients - 1]) };
+			for (int idx{ g_NrOfCoefficients - 2 }; idx >= 0; --idx) result = MultiplyAdd(result, t, Float8::Broadcast(coefficients[idx]));
+			return result;
+		}
+
+		// like ToARGB in SoftwareRasterizer.cpp
+		inline uint32_t ToChannel(float value)
+		{
+			return static_cast<uint32_t>(Saturate(value) * 255.f);
+		}
+	}
+
+	Vector3x8 ShadeVehicle(const VehicleFragments8& fragments, const Vector3& cameraPosition)
+	{
+		const Vector3x8 lightDirection{ Vector3x8::Broadcast(g_LightDirection) };
+
+		// Normal
+		const Vector3x8 biNormal{ Vector3x8::Cross(fragments.normal, fragments.tangent) };
+		const Vector3x8 sampledNormal{ (fragments.normalSample * -2.f).Normalized() };
+		const Vector3x8 normal{ fragments.tangent * sampledNormal.x + biNormal * sampledNormal.y + fragments.normal * sampledNormal.z };
+
+		// OA
+		const Float8 observedArea{ Min(Max(Vector3x8::Dot(normal, lightDirection), Float8::Broadcast(0.f)), Float8::Broadcast(1.f)) };
+
+		// Lambert
+		const Vector3x8 lambert{ fragments.diffuseSample * g_LightIntensity * g_DivPI };
+
+		// Viewdirection
+		const Vector3x8 viewDirection{ (fragments.worldPosition - Vector3x8::Broadcast(cameraPosition)).Normalized() };
+
+		// Phong, lanes below FLT_EPSILON get no specular (FastPow stays on positive inputs)
+		const Vector3x8 reflected{ lightDirection - normal * (Vector3x8::Dot(lightDirection, normal) * Float8::Broadcast(2.f)) };
+		const Float8 cosA{ Vector3x8::Dot(reflected, viewDirection) };
+		const Float8 epsilon{ Float8::Broadcast(FLT_EPSILON) };
+		const Float8 phong{ Select(cosA >= epsilon, FastPow(Max(cosA, epsilon), fragments.glossinessSample), Float8::Broadcast(0.f)) };
+		const Vector3x8 specular{ fragments.specularSample * phong };
+
+		const Vector3x8 ambient{ Vector3x8::Broadcast(Vector3{ g_AmbientColor.r, g_AmbientColor.g, g_AmbientColor.b }) };
+		return ambient + (lambert + specular) * observedArea;
+	}
+
+	ColorRGB ShadeVehicleReference(const VehicleFragment& fragment, const Vector3& cameraPosition)
+	{
+		// Normal
+		const Vector3 biNormal{ Vector3::Cross(fragment.normal, fragment.tangent) };
+		const ColorRGB& normalMapSample{ fragment.normalSample };
+		const Vector3 sampledNormal{ Vector3{ normalMapSample.r * -2.f, normalMapSample.g * -2.f, normalMapSample.b * -2.f }.Normalized() };
+		const Vector3 normal{ fragment.tangent * sampledNormal.x + biNormal * sampledNormal.y + fragment.normal * sampledNormal.z };
+
+		// OA
+		const float observedArea{ Saturate(Vector3::Dot(normal, g_LightDirection)) };
+
+		// Lambert
+		const ColorRGB lambert{ fragment.diffuseSample * g_LightIntensity * g_DivPI };
+
+		// Viewdirection
+		const Vector3 viewDirection{ (fragment.worldPosition - cameraPosition).Normalized() };
+
+		// Phong
+		ColorRGB specular{};
+		const float cosA{ Vector3::Dot(Vector3::Reflect(g_LightDirection, normal), viewDirection) };
+		if (cosA >= FLT_EPSILON)
+		{
+			specular = fragment.specularSample * powf(cosA, fragment.glossinessSample);
+		}
+
+		return g_AmbientColor + (lambert + specular) * observedArea;
+	}
+
+	Float8 FastPow(const Float8& x, const Float8& y)
+	{
+#if defined(__AVX2__)
+		// log2(x) = exponent + log2(1 + t), with the mantissa 1 + t in [1, 2)
+		const __m256i bits{ _mm256_castps_si256(x.value) };
+		const Float8 exponent{ _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127))) };
+		const Float8 mantissa{ _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000))) };
+		const Float8 t{ mantissa - Float8::Broadcast(1.f) };
+		const Float8 log2{ MultiplyAdd(t, Polynomial(t, g_Log2Coefficients), exponent) };
+
+		// 2^z = 2^integer * 2^fraction, the integer part is added to the exponent bits
+		const Float8 z{ Min(Max(y * log2, Float8::Broadcast(g_MinExponent)), Float8::Broadcast(g_MaxExponent)) };
+		const Float8 integer{ _mm256_floor_ps(z.value) };
+		const Float8 fraction{ Polynomial(z - integer, g_Exp2Coefficients) };
+		return { _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(fraction.value), _mm256_slli_epi32(_mm256_cvtps_epi32(integer.value), 23))) };
+#else
+		Float8 result;
+		for (int lane{}; lane < Float8::NrOfLanes; ++lane) result.lanes[lane] = FastPow(x.lanes[lane], y.lanes[lane]);
+		return result;
+#endif
+	}
+
+	float FastPow(float x, float y)
+	{
+		// log2(x) = exponent + log2(1 + t), with the mantissa 1 + t in [1, 2)
+		const uint32_t bits{ std::bit_cast<uint32_t>(x) };
+		const float exponent{ static_cast<float>(static_cast<int32_t>(bits >> 23) - 127) };
+		const float t{ std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u) - 1.f };
+		const float log2{ t * Polynomial(t, g_Log2Coefficients) + exponent };
+
+		// 2^z = 2^integer * 2^fraction, the integer part is added to the exponent bits
+		const float z{ std::clamp(y * log2, g_MinExponent, g_MaxExponent) };
+		const float integer{ std::floor(z) };
+		const float fraction{ Polynomial(z - integer, g_Exp2Coefficients) };
+		return std::bit_cast<float>(std::bit_cast<int32_t>(fraction) + (static_cast<int32_t>(integer) << 23));
+	}
+
+	namespace Utils
+	{
+		bool ValidateVehicleShading(size_t nrOfFragments)
+		{
+			constexpr int nrOfLanes{ Float8::NrOfLanes };
+			nrOfFragments = std::max<size_t>((nrOfFragments + nrOfLanes - 1) / nrOfLanes * nrOfLanes, nrOfLanes);
+
+			// random surface points around the origin, seen from a camera like the one in Renderer
+			std::mt19937 generator{ 42 };
+			std::uniform_real_distribution<float> unitDistribution{ 0.f, 1.f };
+			std::uniform_real_distribution<float> signedDistribution{ -1.f, 1.f };
+			const auto randomDirection = [&]()
+				{
+					Vector3 direction{};
+					while (direction.SqrMagnitude() < 0.01f) direction = Vector3{ signedDistribution(generator), signedDistribution(generator), signedDistribution(generator) };
+					return direction.Normalized();
+				};
+			const auto randomColor = [&]() { return ColorRGB{ unitDistribution(generator), unitDistribution(generator), unitDistribution(generator) }; };
+
+			const Vector3 cameraPosition{ 0.f, 0.f, -50.f };
+			std::vector<VehicleFragment> fragments(nrOfFragments);
+			for (VehicleFragment& fragment : fragments)
+			{
+				fragment.worldPosition = Vector3{ signedDistribution(generator), signedDistribution(generator), signedDistribution(generator) } * 20.f;
+				fragment.normal = randomDirection();
+				// orthogonal to the normal, like the mesh tangents
+				Vector3 tangent{ randomDirection() };
+				tangent = tangent - fragment.normal * Vector3::Dot(tangent, fragment.normal);
+				fragment.tangent = tangent.SqrMagnitude() > 1e-4f ? tangent.Normalized() : Vector3::Cross(fragment.normal, Vector3::UnitY).Normalized();
+				fragment.diffuseSample = randomColor();
+				// a normal map stores (n + 1) / 2, the shader flips it with * -2, keep it away from 0
+				fragment.normalSample = randomColor();
+				fragment.normalSample.b = 0.5f + 0.5f * fragment.normalSample.b;
+				fragment.specularSample = randomColor();
+				fragment.glossinessSample = unitDistribution(generator);
+			}
+
+			// SoA copy, the layout the software rasterizer hands to ShadeVehicle
+			std::vector<float> soa(nrOfFragments * 19);
+			const auto getSoA = [&](int component) { return soa.data() + nrOfFragments * component; };
+			for (size_t idx{}; idx < nrOfFragments; ++idx)
+			{
+				const VehicleFragment& fragment{ fragments[idx] };
+				const float values[19]{
+					fragment.worldPosition.x, fragment.worldPosition.y, fragment.worldPosition.z,
+					fragment.normal.x, fragment.normal.y, fragment.normal.z,
+					fragment.tangent.x, fragment.tangent.y, fragment.tangent.z,
+					fragment.diffuseSample.r, fragment.diffuseSample.g, fragment.diffuseSample.b,
+					fragment.normalSample.r, fragment.normalSample.g, fragment.normalSample.b,
+					fragment.specularSample.r, fragment.specularSample.g, fragment.specularSample.b,
+					fragment.glossinessSample };
+				for (int component{}; component < 19; ++component) getSoA(component)[idx] = values[component];
+			}
+
+			std::vector<ColorRGB> referenceColors(nrOfFragments);
+			std::vector<float> colors(nrOfFragments * 3);
+
+			const auto referenceStart{ std::chrono::steady_clock::now() };
+			for (size_t idx{}; idx < nrOfFragments; ++idx) referenceColors[idx] = ShadeVehicleReference(fragments[idx], cameraPosition);
+			const double referenceMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - referenceStart).count() };
+
+			const auto simdStart{ std::chrono::steady_clock::now() };
+			for (size_t idx{}; idx < nrOfFragments; idx += nrOfLanes)
+			{
+				const auto load = [&](int component) { return Vector3x8::Load(getSoA(component) + idx, getSoA(component + 1) + idx, getSoA(component + 2) + idx); };
+				const VehicleFragments8 packet{ load(0), load(3), load(6), load(9), load(12), load(15), Float8::Load(getSoA(18) + idx) };
+				ShadeVehicle(packet, cameraPosition).Store(colors.data() + idx, colors.data() + nrOfFragments + idx, colors.data() + nrOfFragments * 2 + idx);
+			}
+			const double simdMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simdStart).count() };
+
+			// 8-bit output, what ends up in the framebuffer
+			size_t nrOfDifferentPixels{};
+			uint32_t maxChannelError{};
+			float maxColorError{};
+			for (size_t idx{}; idx < nrOfFragments; ++idx)
+			{
+				const float reference[3]{ referenceColors[idx].r, referenceColors[idx].g, referenceColors[idx].b };
+				bool isDifferent{ false };
+				for (int channel{}; channel < 3; ++channel)
+				{
+					const float color{ colors[nrOfFragments * channel + idx] };
+					const uint32_t a{ ToChannel(color) };
+					const uint32_t b{ ToChannel(reference[channel]) };
+					const uint32_t error{ a > b ? a - b : b - a };
+					maxChannelError = std::max(maxChannelError, error);
+					maxColorError = std::max(maxColorError, std::abs(color - reference[channel]));
+					if (error != 0) isDifferent = true;
+				}
+				if (isDifferent) ++nrOfDifferentPixels;
+			}
+
+			// FastPow over the whole cosine range, with the glossiness range and larger exponents
+			float maxPowError{};
+			float maxPowErrorOverBound{};
+			for (int exponentRange{}; exponentRange < 2; ++exponentRange)
+			{
+				const float maxY{ exponentRange == 0 ? 1.f : 64.f };
+				for (int idx{}; idx < (1 << 16); idx += nrOfLanes)
+				{
+					alignas(32) float x[nrOfLanes];
+					alignas(32) float y[nrOfLanes];
+					alignas(32) float result[nrOfLanes];
+					for (int lane{}; lane < nrOfLanes; ++lane)
+					{
+						// log-uniform in [FLT_EPSILON, 1]
+						x[lane] = std::exp2(-23.f * unitDistribution(generator));
+						y[lane] = maxY * unitDistribution(generator);
+					}
+					FastPow(Float8::Load(x), Float8::Load(y)).Store(result);
+					for (int lane{}; lane < nrOfLanes; ++lane)
+					{
+						const double exact{ std::pow(static_cast<double>(x[lane]), static_cast<double>(y[lane])) };
+						if (exact < std::exp2(-126.0)) continue;
+						const float error{ static_cast<float>(std::abs(result[lane] - exact) / exact) };
+						const float bound{ 1.1e-5f * y[lane] + 1e-7f * std::abs(y[lane] * std::log2(x[lane])) + 3e-6f };
+						if (exponentRange == 0) maxPowError = std::max(maxPowError, error);
+						maxPowErrorOverBound = std::max(maxPowErrorOverBound, error / bound);
+					}
+				}
+			}
+
+#if defined(__AVX2__)
+			const char* pInstructionSet{ "AVX2" };
+#else
+			const char* pInstructionSet{ "scalar" };
+#endif
+			const double nrOfMegaFragments{ nrOfFragments / 1e6 };
+			std::cout << "Vehicle Shading Validation: " << nrOfFragments << " random fragments, " << pInstructionSet << "\n";
+			std::cout << "  Reference (scalar, powf): " << referenceMs << " ms, " << nrOfMegaFragments / (referenceMs / 1000.0) << " M fragments/s\n";
+			std::cout << "  ShadeVehicle (8 wide):    " << simdMs << " ms, " << nrOfMegaFragments / (simdMs / 1000.0) << " M fragments/s ("
+				<< referenceMs / simdMs << "x)\n";
+			std::cout << "  Different pixels: " << nrOfDifferentPixels << ", max error " << maxChannelError << " / 255 (" << maxColorError << " before quantization)\n";
+			std::cout << "  FastPow: max relative error " << maxPowError << " for y in [0, 1], " << maxPowErrorOverBound * 100.f << "% of the documented bound\n";
+
+			const bool isValid{ maxChannelError <= 1 && maxPowErrorOverBound <= 1.f };
+			std::cout << (isValid ? "  Shading: OK\n" : "  Shading: MISMATCH\n");
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef VEHICLESHADER_H
+#define VEHICLESHADER_H
+
+#include "VectorN.h"
+
+namespace dae
+{
+	// Inputs of the Vehicle.fx pixel shader: interpolated attributes + texture samples of one pixel
+	struct VehicleFragment
+	{
+		Vector3 worldPosition;
+		Vector3 normal;
+		Vector3 tangent;
+		ColorRGB diffuseSample;
+		ColorRGB normalSample;
+		ColorRGB specularSample;
+		float glossinessSample;
+	};
+
+	// 8 fragments in SoA layout, colors as (r, g, b) = (x, y, z)
+	struct VehicleFragments8
+	{
+		Vector3x8 worldPosition;
+		Vector3x8 normal;
+		Vector3x8 tangent;
+		Vector3x8 diffuseSample;
+		Vector3x8 normalSample;
+		Vector3x8 specularSample;
+		Float8 glossinessSample;
+	};
+
+	// Vehicle.fx shading model (PS_POINT / PS_LINEAR / PS_ANISOTROPIC after sampling): tangent space normal,
+	// Lambert and Phong, same constants. Returns unsaturated rgb, 8 pixels at once, the Phong term uses FastPow.
+	Vector3x8 ShadeVehicle(const VehicleFragments8& fragments, const Vector3& cameraPosition);
+	// Scalar version with powf, the reference ShadeVehicle is validated against
+	ColorRGB ShadeVehicleReference(const VehicleFragment& fragment, const Vector3& cameraPosition);
+
+	// x^y = exp2(y * log2(x)) for normal x > 0, both from a degree 4 polynomial on the mantissa / fraction.
+	// Relative error <= 1.1e-5 * |y| + 1e-7 * |y * log2(x)| + 3e-6: the two polynomial fits (1.43e-5 absolute on log2,
+	// 2.6e-6 relative on exp2) and the rounding of the exponent. Results below 2^-126 are flushed to 2^-126.
+	Float8 FastPow(const Float8& x, const Float8& y);
+	float FastPow(float x, float y);
+
+	namespace Utils
+	{
+		// Random fragments: ShadeVehicle vs ShadeVehicleReference pixel by pixel (8-bit output), the FastPow
+		// error against its bound and fragments / second of both. Returns false on a difference > 1 LSB.
+		bool ValidateVehicleShading(size_t nrOfFragments = 1 << 20);
+	}
+}
+
+#endif // !VEHICLESHADER_H
\ No newline at end of file
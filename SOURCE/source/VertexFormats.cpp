@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "VertexFormats.h"
+
+namespace dae
+{
+	namespace
+	{
+		constexpr float g_MaxUnorm16{ 65535.f };
+		constexpr float g_MaxSnorm16{ 32767.f };
+
+		inline uint16_t QuantizeUnorm16(float value, float offset, float scale)
+		{
+			if (scale <= 0.f) return 0;
+			return static_cast<uint16_t>(std::lround(Saturate((value - offset) / scale) * g_MaxUnorm16));
+		}
+
+		inline float DequantizeUnorm16(uint16_t value, float offset, float scale)
+		{
+			return offset + value / g_MaxUnorm16 * scale;
+		}
+
+		// D3D SNORM rule: -32768 and -32767 both map to -1
+		inline float DecodeSnorm16(int16_t value)
+		{
+			return std::max(value / g_MaxSnorm16, -1.f);
+		}
+
+		inline float SignNotZero(float value)
+		{
+			return value >= 0.f ? 1.f : -1.f;
+		}
+
+		// atan2 instead of acos, which has no precision left for tiny angles
+		float GetAngleDegrees(const Vector3& a, const Vector3& b)
+		{
+			return std::atan2(Vector3::Cross(a, b).Magnitude(), Vector3::Dot(a, b)) * TO_DEGREES;
+		}
+	}
+
+	VertexQuantization VertexQuantization::FromVertices(std::span<const Vertex> vertices)
+	{
+		VertexQuantization quantization{};
+		if (vertices.empty()) return quantization;
+
+		Vector3 positionMin{ vertices[0].position };
+		Vector3 positionMax{ vertices[0].position };
+		Vector2 uvMin{ vertices[0].uv };
+		Vector2 uvMax{ vertices[0].uv };
+		for (const Vertex& vertex : vertices)
+		{
+			positionMin = Vector3{ std::min(positionMin.x, vertex.position.x), std::min(positionMin.y, vertex.position.y), std::min(positionMin.z, vertex.position.z) };
+			positionMax = Vector3{ std::max(positionMax.x, vertex.position.x), std::max(positionMax.y, vertex.position.y), std::max(positionMax.z, vertex.position.z) };
+			uvMin = Vector2{ std::min(uvMin.x, vertex.uv.x), std::min(uvMin.y, vertex.uv.y) };
+			uvMax = Vector2{ std::max(uvMax.x, vertex.uv.x), std::max(uvMax.y, vertex.uv.y) };
+		}
+
+		quantization.positionOffset = positionMin;
+		quantization.positionScale = positionMax - positionMin;
+		quantization.uvOffset = uvMin;
+		quantization.uvScale = uvMax - uvMin;
+		return quantization;
+	}
+
+	void EncodeVertex(const Vertex& vertex, const VertexQuantization& quantization, VehicleVertex& encoded)
+	{
+		encoded.position[0] = QuantizeUnorm16(vertex.position.x, quantization.positionOffset.x, quantization.positionScale.x);
+		encoded.position[1] = QuantizeUnorm16(vertex.position.y, quantization.positionOffset.y, quantization.positionScale.y);
+		encoded.position[2] = QuantizeUnorm16(vertex.position.z, quantization.positionOffset.z, quantization.positionScale.z);
+		encoded.position[3] = 0;
+		encoded.uv[0] = QuantizeUnorm16(vertex.uv.x, quantization.uvOffset.x, quantization.uvScale.x);
+		encoded.uv[1] = QuantizeUnorm16(vertex.uv.y, quantization.uvOffset.y, quantization.uvScale.y);
+		EncodeOctahedral(vertex.normal, encoded.normal);
+		EncodeOctahedral(vertex.tangent, encoded.tangent);
+	}
+
+	void EncodeVertex(const Vertex& vertex, const VertexQuantization& quantization, FireVertex& encoded)
+	{
+		encoded.position[0] = QuantizeUnorm16(vertex.position.x, quantization.positionOffset.x, quantization.positionScale.x);
+		encoded.position[1] = QuantizeUnorm16(vertex.position.y, quantization.positionOffset.y, quantization.positionScale.y);
+		encoded.position[2] = QuantizeUnorm16(vertex.position.z, quantization.positionOffset.z, quantization.positionScale.z);
+		encoded.position[3] = 0;
+		encoded.uv[0] = QuantizeUnorm16(vertex.uv.x, quantization.uvOffset.x, quantization.uvScale.x);
+		encoded.uv[1] = QuantizeUnorm16(vertex.uv.y, quantization.uvOffset.y, quantization.uvScale.y);
+	}
+
+	Vertex DecodeVertex(const VehicleVertex& encoded, const VertexQuantization& quantization)
+	{
+		Vertex vertex{};
+		vertex.position.x = DequantizeUnorm16(encoded.position[0], quantization.positionOffset.x, quantization.positionScale.x);
+		vertex.position.y = DequantizeUnorm16(encoded.position[1], quantization.positionOffset.y, quantization.positionScale.y);
+		vertex.position.z = DequantizeUnorm16(encoded.position[2], quantization.positionOffset.z, quantization.positionScale.z);
+		vertex.uv.x = DequantizeUnorm16(encoded.uv[0], quantization.uvOffset.x, quantization.uvScale.x);
+		vertex.uv.y = DequantizeUnorm16(encoded.uv[1], quantization.uvOffset.y, quantization.uvScale.y);
+		vertex.normal = DecodeOctahedral(encoded.normal);
+		vertex.tangent = DecodeOctahedral(encoded.tangent);
+		return vertex;
+	}
+
+	Vertex DecodeVertex(const FireVertex& encoded, const VertexQuantization& quantization)
+	{
+		Vertex vertex{};
+		vertex.position.x = DequantizeUnorm16(encoded.position[0], quantization.positionOffset.x, quantization.positionScale.x);
+		vertex.position.y = DequantizeUnorm16(encoded.position[1], quantization.positionOffset.y, quantization.positionScale.y);
+		vertex.position.z = DequantizeUnorm16(encoded.position[2], quantization.positionOffset.z, quantization.positionScale.z);
+		vertex.uv.x = DequantizeUnorm16(encoded.uv[0], quantization.uvOffset.x, quantization.uvScale.x);
+		vertex.uv.y = DequantizeUnorm16(encoded.uv[1], quantization.uvOffset.y, quantization.uvScale.y);
+		return vertex;
+	}
+
+	void EncodeOctahedral(const Vector3& direction, int16_t encoded[2])
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+
+		// zero vector: (0, 0), decodes to +Z
+		const float length{ std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z) };
+		if (length <= 0.f) return;
+
+		// project on the octahedron, fold the lower half over the diagonals
+		float x{ direction.x / length };
+		float y{ direction.y / length };
+		if (direction.z < 0.f)
+		{
+			const float foldedX{ (1.f - std::abs(y)) * SignNotZero(x) };
+			y = (1.f - std::abs(x)) * SignNotZero(y);
+			x = foldedX;
+		}
+
+		// of the 4 surrounding grid points keep the one that decodes closest to the input
+		const Vector3 normalized{ direction.Normalized() };
+		float bestCosAngle{ -FLT_MAX };
+		for (int idx{}; idx < 4; ++idx)
+		{
+			const int16_t candidate[2]
+			{
+				static_cast<int16_t>(Clamp(static_cast<int>((idx & 1) ? std::ceil(x * g_MaxSnorm16) : std::floor(x * g_MaxSnorm16)), -32767, 32767)),
+				static_cast<int16_t>(Clamp(static_cast<int>((idx & 2) ? std::ceil(y * g_MaxSnorm16) : std::floor(y * g_MaxSnorm16)), -32767, 32767)),
+			};
+
+			const float cosAngle{ Vector3::Dot(DecodeOctahedral(candidate), normalized) };
+			if (cosAngle > bestCosAngle)
+			{
+				bestCosAngle = cosAngle;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+
+	Vector3 DecodeOctahedral(const int16_t encoded[2])
+	{
+		// same as OctahedralDecode in the .fx files
+		Vector3 direction{ DecodeSnorm16(encoded[0]), DecodeSnorm16(encoded[1]), 0.f };
+		direction.z = 1.f - std::abs(direction.x) - std::abs(direction.y);
+
+		const float fold{ Saturate(-direction.z) };
+		direction.x += direction.x >= 0.f ? -fold : fold;
+		direction.y += direction.y >= 0.f ? -fold : fold;
+		return direction.Normalized();
+	}
+
+	QuantizationError MeasureQuantizationError(std::span<const Vertex> vertices)
+	{
+		QuantizationError error{};
+		if (vertices.empty()) return error;
+
+		const VertexQuantization quantization{ VertexQuantization::FromVertices(vertices) };
+
+		double totalPositionError{};
+		double totalNormalError{};
+		double totalTangentError{};
+		size_t nrOfTangents{};
+		for (const Vertex& vertex : vertices)
+		{
+			VehicleVertex encoded{};
+			EncodeVertex(vertex, quantization, encoded);
+			const Vertex decoded{ DecodeVertex(encoded, quantization) };
+
+			const float positionError{ (decoded.position - vertex.position).Magnitude() };
+			const float uvError{ std::max(std::abs(decoded.uv.x - vertex.uv.x), std::abs(decoded.uv.y - vertex.uv.y)) };
+			const float normalError{ GetAngleDegrees(decoded.normal, vertex.normal) };
+			// a zero tangent (not from LoadOBJ) has no encoding, it comes back as +Z
+			const bool hasTangent{ vertex.tangent.SqrMagnitude() > 0.f };
+			const float tangentError{ hasTangent ? GetAngleDegrees(decoded.tangent, vertex.tangent) : 0.f };
+			if (hasTangent) ++nrOfTangents;
+
+			error.maxPositionError = std::max(error.maxPositionError, positionError);
+			error.maxUVError = std::max(error.maxUVError, uvError);
+			error.maxNormalError = std::max(error.maxNormalError, normalError);
+			error.maxTangentError = std::max(error.maxTangentError, tangentError);
+			totalPositionError += positionError;
+			totalNormalError += normalError;
+			totalTangentError += tangentError;
+		}
+
+		error.avgPositionError = static_cast<float>(totalPositionError / vertices.size());
+		error.avgNormalError = static_cast<float>(totalNormalError / vertices.size());
+		error.avgTangentError = nrOfTangents > 0 ? static_cast<float>(totalTangentError / nrOfTangents) : 0.f;
+		return error;
+	}
+
+	void PrintQuantizationError(const QuantizationError& error)
+	{
+		std::cout << "  Vertex size: " << sizeof(Vertex) << " bytes -> " << sizeof(VehicleVertex) << " (vehicle), " << sizeof(FireVertex) << " (fire)\n";
+		std::cout << "  Position error: max " << error.maxPositionError << ", avg " << error.avgPositionError << "\n";
+		std::cout << "  UV error: max " << error.maxUVError << "\n";
+		std::cout << "  Normal error: max " << error.maxNormalError << " deg, avg " << error.avgNormalError << " deg\n";
+		std::cout << "  Tangent error: max " << error.maxTangentError << " deg, avg " << error.avgTangentError << " deg\n";
+	}
+
+	namespace Utils
+	{
+		bool ValidateOctahedral()
+		{
+			bool isValid{ true };
+			const auto check = [&](const Vector3& direction, const Vector3& expected, const char* pName)
+				{
+					int16_t encoded[2]{};
+					EncodeOctahedral(direction, encoded);
+					const Vector3 decoded{ DecodeOctahedral(encoded) };
+					const float error{ GetAngleDegrees(decoded, expected) };
+					if (error <= 0.01f) return;
+
+					std::cout << "  " << pName << " (" << direction.x << ", " << direction.y << ", " << direction.z << "): decoded to ("
+						<< decoded.x << ", " << decoded.y << ", " << decoded.z << "), " << error << " deg off\n";
+					isValid = false;
+				};
+
+			for (int axis{}; axis < 3; ++axis)
+			{
+				for (const float sign : { 1.f, -1.f })
+				{
+					Vector3 direction{};
+					(axis == 0 ? direction.x : axis == 1 ? direction.y : direction.z) = sign;
+					check(direction, direction, "axis");
+				}
+			}
+			for (int octant{}; octant < 8; ++octant)
+			{
+				const Vector3 diagonal{ Vector3{ octant & 1 ? -1.f : 1.f, octant & 2 ? -1.f : 1.f, octant & 4 ? -1.f : 1.f }.Normalized() };
+				check(diagonal, diagonal, "diagonal");
+				// on the fold of the lower half
+				const Vector3 edge{ Vector3{ diagonal.x, diagonal.y, 0.f }.Normalized() };
+				check(edge, edge, "fold edge");
+			}
+			check(Vector3::Zero, Vector3::UnitZ, "zero");
+
+			std::cout << (isValid ? "Octahedral encoding: OK\n" : "Octahedral encoding: MISMATCH\n");
+			return isValid;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef VERTEXFORMATS_H
+#define VERTEXFORMATS_H
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Per mesh ranges the 16-bit UNORM positions / UVs are quantized to (value = offset + unorm * scale)
+	struct VertexQuantization
+	{
+		Vector3 positionOffset;
+		Vector3 positionScale;
+		Vector2 uvOffset;
+		Vector2 uvScale;
+
+		static VertexQuantization FromVertices(std::span<const Vertex> vertices);
+	};
+
+	// Compact GPU vertex streams, one per effect (see the input layouts in VehicleEffect / FireEffect)
+	// POSITION R16G16B16A16_UNORM, TEXCOORD R16G16_UNORM, NORMAL + TANGENT R16G16_SNORM (octahedral)
+	struct VehicleVertex
+	{
+		uint16_t position[4];
+		uint16_t uv[2];
+		int16_t normal[2];
+		int16_t tangent[2];
+	};
+	static_assert(sizeof(VehicleVertex) == 20);
+
+	// POSITION R16G16B16A16_UNORM, TEXCOORD R16G16_UNORM
+	struct FireVertex
+	{
+		uint16_t position[4];
+		uint16_t uv[2];
+	};
+	static_assert(sizeof(FireVertex) == 12);
+
+	void EncodeVertex(const Vertex& vertex, const VertexQuantization& quantization, VehicleVertex& encoded);
+	void EncodeVertex(const Vertex& vertex, const VertexQuantization& quantization, FireVertex& encoded);
+
+	// CPU decode, same math as the vertex shaders (fire vertices have no normal / tangent)
+	Vertex DecodeVertex(const VehicleVertex& encoded, const VertexQuantization& quantization);
+	Vertex DecodeVertex(const FireVertex& encoded, const VertexQuantization& quantization);
+
+	// Octahedral unit vector <-> 2 x 16-bit SNORM. A zero vector has no direction to encode: it becomes (0, 0),
+	// which decodes to +Z (LoadOBJ never produces zero tangents for this reason).
+	void EncodeOctahedral(const Vector3& direction, int16_t encoded[2]);
+	Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+	struct QuantizationError
+	{
+		float maxPositionError{}; // object space units
+		float avgPositionError{};
+		float maxUVError{};
+		float maxNormalError{}; // degrees
+		float avgNormalError{};
+		float maxTangentError{};
+		float avgTangentError{};
+	};
+
+	// Round trips every vertex through VehicleVertex
+	QuantizationError MeasureQuantizationError(std::span<const Vertex> vertices);
+	void PrintQuantizationError(const QuantizationError& error);
+
+	namespace Utils
+	{
+		// Octahedral round trips of the axes, the octant diagonals and the fold edges within 0.01 degrees,
+		// and the zero vector to +Z. Prints every failure, returns false on any.
+		bool ValidateOctahedral();
+	}
+}
+
+#endif // !VERTEXFORMATS_H
\ No newline at end of file
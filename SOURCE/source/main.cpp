@@ -6,17 +6,197 @@
 
 #undef main
 #include "Renderer.h"
+#include "ObjLoader.h"
+#include "MeshOptimizer.h"
+#include "VertexFormats.h"
+#include "MathBenchmark.h"
+#include "RasterKernel.h"
+#include "TextureSampler.h"
+#include "VehicleShader.h"
+#include "MipGenerator.h"
+#include "TextureCompressor.h"
+#include "MaterialPacker.h"
+#include "FileReader.h"
 
 using namespace dae;
 
-int main()
+int RunHeadless(uint32_t width, uint32_t height, int nrOfFrames, const std::string& outputPath, uint32_t nrOfThreads, bool visibilityBuffer, float guardBand, bool validate, bool packedMaterial, size_t textureBudget)
 {
-	//Create window + surfaces
-	SDL_Init(SDL_INIT_VIDEO);
+	//No window: software rasterizer only, renders into its in-memory framebuffer
+	SDL_Init(0);
+
+	const uint64_t initCounter{ SDL_GetPerformanceCounter() };
+	std::unique_ptr<Timer> pTimer{ std::make_unique<Timer>() };
+	std::unique_ptr<Renderer> pRenderer{ std::make_unique<Renderer>(nullptr, width, height) };
+	// no placeholders in the saved frames, the assets still load in parallel
+	pRenderer->WaitForAssets();
+	pRenderer->SetSoftwareThreadCount(nrOfThreads);
+	if (visibilityBuffer) pRenderer->ToggleSoftwareShading();
+	if (guardBand > 0.f) pRenderer->SetSoftwareGuardBand(guardBand);
+	if (packedMaterial) pRenderer->TogglePackedMaterial();
+	if (textureBudget > 0) pRenderer->SetTextureBudget(textureBudget);
+
+	pTimer->Start();
+
+	const uint64_t startCounter{ SDL_GetPerformanceCounter() };
+	for (int frame{}; frame < nrOfFrames; ++frame)
+	{
+		pRenderer->Update(pTimer.get());
+		pRenderer->Render();
+		pTimer->Update();
+
+		if (frame == 0) std::cout << "Time to first frame: " << (SDL_GetPerformanceCounter() - initCounter) * 1000.0 / SDL_GetPerformanceFrequency() << " ms\n";
+	}
+	const uint64_t endCounter{ SDL_GetPerformanceCounter() };
+
+	pTimer->Stop();
+
+	const double totalMs{ (endCounter - startCounter) * 1000.0 / SDL_GetPerformanceFrequency() };
+	std::cout << "Headless: " << nrOfFrames << " frames, " << totalMs / std::max(nrOfFrames, 1) << " ms/frame\n";
+	pRenderer->PrintSoftwareStats();
+	pRenderer->PrintResourceStats();
+
+	const bool isValid{ !validate || pRenderer->ValidateSoftware() };
+
+	const bool isSaved{ pRenderer->SaveBufferToImage(outputPath) };
+	if (isSaved) std::cout << "Saved last frame to " << outputPath << "\n";
+
+	pRenderer.reset();
+	SDL_Quit();
+
+	return isSaved && isValid ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(__AVX2__)
+	// the whole build uses AVX2 (/arch:AVX2), fail here instead of on the first AVX2 instruction
+	if (!SDL_HasAVX2())
+	{
+		std::cout << "This build requires a CPU with AVX2 support\n";
+		return 1;
+	}
+#endif
 
 	constexpr uint32_t width{ 640 };
 	constexpr uint32_t height{ 480 };
 
+	//Command line
+	// --headless [--frames N] [--output file.bmp] : render without window / GPU
+	//   [--threads N] [--validate]                 : software worker threads, compare with a single threaded forward render
+	//   [--visibility]                             : visibility buffer shading
+	//   [--guard-band X]                           : side plane clipping only beyond X times the viewport
+	//   [--packed-material]                        : vehicle shaded from the channel packed maps
+	// --software                                   : start with the software rasterizer
+	// --texture-budget MB                          : textures drop mip levels beyond this much CPU + GPU memory
+	// --bench-obj file.obj [runs]                  : ParseOBJ vs LoadOBJ throughput
+	// --analyze-mesh file.obj                      : ACMR / ATVR / overdraw, file order vs optimized, quantization error
+	// --bench-transform [vertices]                 : scalar vs batch (SSE / AVX2) vertex transforms
+	// --bench-raster [triangles]                   : 8x8 block coverage, AVX2 edge kernel vs scalar reference
+	// --validate-shading [fragments]               : 8 wide Vehicle.fx shading vs scalar reference, FastPow error
+	// --validate-octahedral                        : normal / tangent encoding edge cases (axes, folds, zero vector)
+	// --bench-sampler file.png [samples]           : SIMD point / linear / anisotropic sampling vs scalar reference
+	// --bench-mips file.png [runs]                : box / Kaiser mip chain, single vs all threads
+	// --bench-bc file.png [runs]                  : BC1 / BC3 / BC4 / BC5 encoder throughput and PSNR, fast vs quality
+	// --pack-material                             : (re)build the channel packed vehicle maps
+	// --compare-material [fragments]              : vehicle shading from the packed vs the separate maps
+	// --bench-io directory [runs]                  : std::ifstream vs FileReader (buffered / direct I/O), cold and warm
+	bool isHeadless{ false };
+	bool startSoftware{ false };
+	int nrOfHeadlessFrames{ 100 };
+	std::string outputPath{ "output.bmp" };
+	uint32_t nrOfThreads{ 0 };
+	bool validate{ false };
+	bool visibilityBuffer{ false };
+	float guardBand{ 0.f };
+	bool packedMaterial{ false };
+	size_t textureBudget{ 0 };
+	for (int idx{ 1 }; idx < argc; ++idx)
+	{
+		const std::string argument{ argv[idx] };
+		if (argument == "--headless") isHeadless = true;
+		else if (argument == "--software") startSoftware = true;
+		else if (argument == "--frames" && idx + 1 < argc) nrOfHeadlessFrames = std::stoi(argv[++idx]);
+		else if (argument == "--output" && idx + 1 < argc) outputPath = argv[++idx];
+		else if (argument == "--threads" && idx + 1 < argc) nrOfThreads = static_cast<uint32_t>(std::stoul(argv[++idx]));
+		else if (argument == "--validate") validate = true;
+		else if (argument == "--visibility") visibilityBuffer = true;
+		else if (argument == "--guard-band" && idx + 1 < argc) guardBand = std::stof(argv[++idx]);
+		else if (argument == "--packed-material") packedMaterial = true;
+		else if (argument == "--texture-budget" && idx + 1 < argc) textureBudget = static_cast<size_t>(std::stod(argv[++idx]) * 1024.0 * 1024.0);
+		else if (argument == "--bench-obj" && idx + 1 < argc)
+		{
+			const std::string objPath{ argv[++idx] };
+			const int nrOfRuns{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoi(argv[++idx]) : 5 };
+			Utils::BenchmarkOBJ(objPath, nrOfRuns);
+			return 0;
+		}
+		else if (argument == "--analyze-mesh" && idx + 1 < argc)
+		{
+			Utils::AnalyzeMesh(argv[++idx]);
+			return 0;
+		}
+		else if (argument == "--bench-transform")
+		{
+			const size_t nrOfVertices{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoull(argv[++idx]) : size_t{ 1 } << 20 };
+			Utils::BenchmarkTransform(nrOfVertices);
+			return 0;
+		}
+		else if (argument == "--bench-raster")
+		{
+			const size_t nrOfTriangles{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoull(argv[++idx]) : size_t{ 100000 } };
+			Utils::BenchmarkRasterKernel(nrOfTriangles);
+			return 0;
+		}
+		else if (argument == "--validate-shading")
+		{
+			const size_t nrOfFragments{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoull(argv[++idx]) : size_t{ 1 } << 20 };
+			return Utils::ValidateVehicleShading(nrOfFragments) ? 0 : 1;
+		}
+		else if (argument == "--validate-octahedral")
+		{
+			return Utils::ValidateOctahedral() ? 0 : 1;
+		}
+		else if (argument == "--bench-sampler" && idx + 1 < argc)
+		{
+			const std::string texturePath{ argv[++idx] };
+			const size_t nrOfSamples{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoull(argv[++idx]) : size_t{ 1 } << 20 };
+			return Utils::BenchmarkTextureSampler(texturePath, nrOfSamples) ? 0 : 1;
+		}
+		else if (argument == "--bench-mips" && idx + 1 < argc)
+		{
+			const std::string texturePath{ argv[++idx] };
+			const int nrOfRuns{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoi(argv[++idx]) : 5 };
+			return Utils::BenchmarkMipGeneration(texturePath, nrOfRuns) ? 0 : 1;
+		}
+		else if (argument == "--bench-bc" && idx + 1 < argc)
+		{
+			const std::string texturePath{ argv[++idx] };
+			const int nrOfRuns{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoi(argv[++idx]) : 3 };
+			return Utils::BenchmarkTextureCompression(texturePath, nrOfRuns) ? 0 : 1;
+		}
+		else if (argument == "--pack-material")
+		{
+			return BuildPackedMaterial(GetVehicleMaterialPaths(), true) ? 0 : 1;
+		}
+		else if (argument == "--compare-material")
+		{
+			const size_t nrOfFragments{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoull(argv[++idx]) : size_t{ 1 } << 18 };
+			return Utils::CompareMaterialPacking(GetVehicleMaterialPaths(), nrOfFragments) ? 0 : 1;
+		}
+		else if (argument == "--bench-io" && idx + 1 < argc)
+		{
+			const std::string directory{ argv[++idx] };
+			const int nrOfRuns{ (idx + 1 < argc && std::isdigit(argv[idx + 1][0])) ? std::stoi(argv[++idx]) : 3 };
+			return Utils::BenchmarkFileReader(directory, nrOfRuns) ? 0 : 1;
+		}
+	}
+
+	if (isHeadless) return RunHeadless(width, height, nrOfHeadlessFrames, outputPath, nrOfThreads, visibilityBuffer, guardBand, validate, packedMaterial, textureBudget);
+
+	//Create window + surfaces
+	SDL_Init(SDL_INIT_VIDEO);
+
 	SDL_Window* pWindow{ 
 		SDL_CreateWindow(
 			"DirectX - ***Maurice Vandenheede - 2DAE18***",
@@ -28,13 +208,18 @@ int main()
 	if (!pWindow) return 1;
 
 	//Initialize "framework"
+	const uint64_t initCounter{ SDL_GetPerformanceCounter() };
 	std::unique_ptr<Timer> pTimer{ std::make_unique<Timer>() };
 	std::unique_ptr<Renderer> pRenderer{ std::make_unique<Renderer>(pWindow, width, height) };
 
+	if (startSoftware) pRenderer->ToggleRasterizerMode();
+	if (textureBudget > 0) pRenderer->SetTextureBudget(textureBudget);
+
 	//Start loop
 	pTimer->Start();
 
 	float printTimer{};
+	bool isFirstFrame{ true };
 	bool showFPS{ true };
 	bool isLooping{ true };
 	bool clearConsole{ false };
@@ -53,6 +238,15 @@ int main()
 			case SDL_KEYUP:
 				switch (e.key.keysym.scancode)
 				{
+				case SDL_SCANCODE_F1:
+					pRenderer->ToggleRasterizerMode();
+					break;
+				case SDL_SCANCODE_F2:
+					pRenderer->ToggleSoftwareShading();
+					break;
+				case SDL_SCANCODE_F3:
+					pRenderer->TogglePackedMaterial();
+					break;
 				case SDL_SCANCODE_F4:
 					pRenderer->ToggleFilteringMode();
 					break;
@@ -65,6 +259,9 @@ int main()
 				case SDL_SCANCODE_F7:
 					pRenderer->ToggleFireFX();
 					break;
+				case SDL_SCANCODE_F8:
+					pRenderer->PrintResourceStats();
+					break;
 				case SDL_SCANCODE_C:
 					clearConsole = true;
 					break;
@@ -85,6 +282,14 @@ int main()
 		//--------- Render ---------
 		pRenderer->Render();
 
+		// assets keep loading in the background, this frame may still show placeholders
+		if (isFirstFrame)
+		{
+			isFirstFrame = false;
+			std::cout << "Time to first frame: " << (SDL_GetPerformanceCounter() - initCounter) * 1000.0 / SDL_GetPerformanceFrequency() << " ms, "
+				<< pRenderer->GetNrOfLoadingAssets() << " assets still loading\n";
+		}
+
 		//--------- Timer ---------
 		pTimer->Update();
 
@@ -6,19 +6,33 @@
 #include <algorithm>
 #include <sstream>
 #include <memory>
+#include <span>
+#include <cfloat>
 #define NOMINMAX  //for directx
 
+// DirectX backend: Windows only, the CMake build sets DAE_NO_DIRECTX (software rasterizer only)
+#if defined(_WIN32) && !defined(DAE_NO_DIRECTX)
+#define DAE_HAS_DIRECTX
+#endif
+
 // SDL Headers
 #include "SDL.h"
-#include "SDL_syswm.h"
 #include "SDL_surface.h"
 #include "SDL_image.h"
 
+#ifdef DAE_HAS_DIRECTX
 // DirectX Headers
+#include "SDL_syswm.h"
 #include <dxgi.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <d3dx11effect.h>
+#else
+// only passed around (always nullptr) without DirectX
+struct ID3D11Device;
+struct ID3D11Texture2D;
+struct ID3D11ShaderResourceView;
+#endif
 
 // Framework Headers
 #include "Timer.h"